@@ -0,0 +1,125 @@
+/**
+* @file allocationStats.cpp
+* @author Ondrej
+* @brief Implementation of allocation counting and search arena
+**/
+
+#include "allocationStats.hpp"
+
+#include <algorithm>
+
+/** Difference between two snapshots, peak is measured relative to the older snapshot */
+AllocationStats AllocationStats::operator-(const AllocationStats &before) const
+{
+    AllocationStats diff;
+    diff.allocations = allocations - before.allocations;
+    diff.deallocations = deallocations - before.deallocations;
+    diff.bytes = bytes - before.bytes;
+    diff.currentBytes = currentBytes > before.currentBytes ? currentBytes - before.currentBytes : 0;
+    diff.peakBytes = peakBytes > before.currentBytes ? peakBytes - before.currentBytes : 0;
+    return diff;
+}
+
+/** Prints the stats in a single line */
+std::ostream &operator<<(std::ostream &os, const AllocationStats &stats)
+{
+    return os << stats.allocations << " allocations, " << stats.bytes << " bytes, peak " << stats.peakBytes << " bytes";
+}
+
+/** Counts the allocation and passes it upstream */
+void *CountingResource::do_allocate(size_t bytes, size_t alignment)
+{
+    void *p = m_upstream->allocate(bytes, alignment);
+
+    m_stats.allocations++;
+    m_stats.bytes += bytes;
+    m_stats.currentBytes += bytes;
+    m_stats.peakBytes = std::max(m_stats.peakBytes, m_stats.currentBytes);
+
+    return p;
+}
+
+/** Counts the deallocation and passes it upstream */
+void CountingResource::do_deallocate(void *p, size_t bytes, size_t alignment)
+{
+    m_upstream->deallocate(p, bytes, alignment);
+
+    m_stats.deallocations++;
+    m_stats.currentBytes -= std::min(bytes, m_stats.currentBytes);
+}
+
+/** Memory can be freed only by the same resource */
+bool CountingResource::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+{
+    return this == &other;
+}
+
+/** Builds the resource chain: containers -> counter -> (arena) -> counter -> operator new */
+SearchMemory::SearchMemory(bool useArena, bool accounting)
+    : m_accounting(accounting),
+      m_requests(&m_upstream)
+{
+    /* Containers always see the same resource, so the arena can be replaced underneath them */
+    if (useArena)
+        this->createArena(0);
+}
+
+/** Creates arena, the initial buffer is reused after every release */
+void SearchMemory::createArena(size_t initialSize)
+{
+    m_arena.reset();
+
+    if (initialSize == 0)
+    {
+        m_arenaBuffer.reset();
+        m_arenaSize = 0;
+        m_arena = std::make_unique<std::pmr::monotonic_buffer_resource>(&m_upstream);
+        m_requests.setUpstream(m_arena.get());
+        return;
+    }
+
+    /* Not using vector, zeroing the buffer would cost as much as the search itself */
+    m_arenaBuffer.reset(new std::byte[initialSize]);
+    m_arenaSize = initialSize;
+    m_arena = std::make_unique<std::pmr::monotonic_buffer_resource>(m_arenaBuffer.get(), m_arenaSize, &m_upstream);
+    m_requests.setUpstream(m_arena.get());
+}
+
+/** Frees everything allocated in the arena at once */
+void SearchMemory::release(void)
+{
+    if (!m_arena)
+        return;
+
+    /* If the last run did not fit into the initial buffer, grow it so the next run fits */
+    size_t grown = m_upstream.stats().currentBytes;
+    if (grown == 0)
+    {
+        m_arena->release();
+        return;
+    }
+
+    this->createArena(m_arenaSize + grown);
+}
+
+/** Starts per-search measurement */
+void SearchMemory::beginSearch(void)
+{
+    if (!m_accounting)
+        return;
+
+    m_requests.resetPeak();
+    m_upstream.resetPeak();
+    m_requestsBefore = m_requests.stats();
+    m_upstreamBefore = m_upstream.stats();
+}
+
+/** Ends per-search measurement, returns what the search allocated */
+AllocationStats SearchMemory::endSearch(void)
+{
+    if (!m_accounting)
+        return AllocationStats();
+
+    m_lastUpstream = m_upstream.stats() - m_upstreamBefore;
+    return m_requests.stats() - m_requestsBefore;
+}
@@ -0,0 +1,114 @@
+/**
+* @file allocationStats.hpp
+* @author Ondrej
+* @brief Memory resources used by the searches - allocation counting and resettable arena
+**/
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <ostream>
+
+
+/** Allocation counters of one memory resource */
+struct AllocationStats
+{
+    size_t allocations = 0;
+    size_t deallocations = 0;
+    size_t bytes = 0;
+    size_t currentBytes = 0;
+    size_t peakBytes = 0;
+
+    /** Difference between two snapshots, peak is measured relative to the older snapshot (newer peak above the bytes
+        held at the older one) */
+    AllocationStats operator-(const AllocationStats &before) const;
+};
+
+/** Prints the stats in a single line */
+std::ostream &operator<<(std::ostream &os, const AllocationStats &stats);
+
+/** Memory resource that counts every allocation and passes it to the upstream resource */
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    explicit CountingResource(std::pmr::memory_resource *upstream = std::pmr::new_delete_resource())
+        : m_upstream(upstream)
+    {};
+
+    /** Current counters */
+    const AllocationStats &stats(void) const { return m_stats; }
+
+    /** Starts new peak measurement from the current amount of allocated bytes */
+    void resetPeak(void) { m_stats.peakBytes = m_stats.currentBytes; }
+
+    /** Changes where the allocations are passed, only when nothing is allocated from the old one */
+    void setUpstream(std::pmr::memory_resource *upstream) { m_upstream = upstream; }
+
+private:
+    void *do_allocate(size_t bytes, size_t alignment) override;
+
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+    std::pmr::memory_resource *m_upstream;
+
+    AllocationStats m_stats;
+};
+
+/**
+* @brief Memory used by the searches of one Graph
+* - Optionally places everything into monotonic arena that is released all at once between runs
+* - Optionally counts allocations of the searches (accounting mode)
+**/
+class SearchMemory
+{
+public:
+    SearchMemory(bool useArena, bool accounting);
+
+    /** Resource that should be used by all per-search containers */
+    std::pmr::memory_resource *resource(void) { return &m_requests; }
+
+    /** Frees everything allocated in the arena, containers using it must be empty/destroyed by now */
+    void release(void);
+
+    /** Call before search, starts per-search measurement */
+    void beginSearch(void);
+
+    /** Call after search, returns what the search allocated */
+    AllocationStats endSearch(void);
+
+    /** Allocations that reached the system allocator during the last search */
+    const AllocationStats &lastUpstream(void) const { return m_lastUpstream; }
+
+    bool accounting(void) const { return m_accounting; }
+
+    bool usesArena(void) const { return m_arena != nullptr; }
+
+private:
+    /** Creates arena, the initial buffer is reused after every release */
+    void createArena(size_t initialSize);
+
+    bool m_accounting;
+
+    /** Counts what actually reaches operator new */
+    CountingResource m_upstream;
+
+    /** Counts what the containers ask for, this is the resource they use */
+    CountingResource m_requests;
+
+    /** Initial arena buffer, grows to the size the largest run needed so later runs do not hit operator new */
+    std::unique_ptr<std::byte[]> m_arenaBuffer;
+
+    size_t m_arenaSize = 0;
+
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> m_arena;
+
+    AllocationStats m_requestsBefore;
+
+    AllocationStats m_upstreamBefore;
+
+    AllocationStats m_lastUpstream;
+};
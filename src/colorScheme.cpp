@@ -0,0 +1,37 @@
+/**
+* @file colorScheme.cpp
+* @author Ondrej
+* @brief Default colour schemes
+**/
+
+#include "colorScheme.hpp"
+
+const std::array<ColorScheme, 2> defaultColorSchemes = {
+    ColorScheme{RGB{0, 0, 0, 255}, RGB{126, 126, 126, 255}, RGB{219, 41, 22, 255}, RGB{27, 101, 19, 255}, RGB{255, 204, 0, 255},
+                RGB{32, 32, 32, 255}, RGB{0, 0, 255, 255}},
+    ColorScheme{RGB{18, 171, 226, 255}, RGB{225, 255, 255, 255}, RGB{0, 230, 255, 255}, RGB{0, 153, 76, 25}, RGB{255, 255, 0, 255},
+                RGB{255, 255, 255, 255}, RGB{255, 0, 0, 255}},
+};
+
+/** Colour of the state in the scheme, trees have the same colour in every scheme */
+RGB stateColor(const ColorScheme &scheme, CellState state)
+{
+    switch (state)
+    {
+        case CellState::Wall:
+            return scheme.wall;
+        case CellState::Empty:
+            return scheme.empty;
+        case CellState::Tree:
+            return RGB{102, 255, 102, 255};
+        case CellState::StartEnd:
+            return scheme.startEnd;
+        case CellState::Opened:
+            return scheme.opened;
+        case CellState::Step:
+            return scheme.step;
+        case CellState::Path:
+            return scheme.path;
+    }
+    return RGB{0, 0, 0, 255};
+}
@@ -0,0 +1,53 @@
+/**
+* @file colorScheme.hpp
+* @author Ondrej
+* @brief Colours of the visualisation, shared by the window and the headless export
+**/
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+
+struct RGB
+{
+    int r;
+    int g;
+    int b;
+    /* Alpha - opacity */
+    int a;
+};
+
+/** Color scheme for visualisation */
+struct ColorScheme
+{
+    RGB wall;
+    RGB empty;
+    RGB step;
+    RGB opened;
+    RGB path;
+    RGB background;
+    RGB startEnd;
+};
+
+/** What is displayed in the cell */
+enum class CellState : uint8_t
+{
+    Wall,
+    Empty,
+    Tree,
+    StartEnd,
+    Opened,
+    Step,
+    Path
+};
+
+/** Number of values of CellState */
+const int cellStateCount = 7;
+
+/** Schemes switched by the C key, the first one is used by default */
+extern const std::array<ColorScheme, 2> defaultColorSchemes;
+
+/** Colour of the state in the scheme */
+RGB stateColor(const ColorScheme &scheme, CellState state);
@@ -0,0 +1,379 @@
+/**
+* @file comparisonView.cpp
+* @author Ondrej
+* @brief Implementation of ComparisonView
+*
+*/
+
+#include "comparisonView.hpp"
+#include "conversion.hpp"
+#include "graphVisualisation.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+/** Zoom step of one mouse wheel notch */
+const float comparisonZoomStep = 1.2f;
+
+/** Pixels between panes */
+const float paneGap = 4.0f;
+
+/** Creates pane for every algorithm, graphs share the map of graph */
+ComparisonView::ComparisonView(const Graph &graph, sf::RenderWindow &window, size_t visualisationSpeed)
+    : m_window(window),
+      m_scheduler(visualisationSpeed * GraphVisualisation::stepsPerSpeedUnit)
+{
+    m_window.setFramerateLimit(PlaybackScheduler::refreshRate);
+
+    /* Geometry and textures of the map exist once, panes keep only their cell states */
+    m_map.build(graph, defaultColorSchemes[m_visualStyle]);
+    for (int i = 0; i < searchAlgorithmCount; i++)
+    {
+        m_panes.push_back(std::make_unique<Pane>(graph, static_cast<SearchAlgorithmType>(i)));
+        m_panes.back()->overlay.build(m_panes.back()->graph, defaultColorSchemes[m_visualStyle], true);
+    }
+
+    this->layout();
+    this->fitCamera();
+}
+
+/** Main window loop */
+void ComparisonView::windowLoop(void)
+{
+    if (m_panes.empty() || m_panes.front()->graph.grid().empty())
+        return;
+
+    this->restart();
+
+    while (m_window.isOpen())
+    {
+        PROFILE_ZONE("frame");
+
+        sf::Event event;
+        while (m_window.pollEvent(event))
+        {
+            this->processInput(event);
+        }
+
+        if (!m_paused && !m_finished)
+        {
+            m_target += m_scheduler.stepsForFrame();
+            sf::Clock stepClock;
+
+            /* Lockstep, pane whose search thread is behind catches up in the next frames */
+            PROFILE_ZONE("show batch");
+            size_t shown = 0;
+            bool finished = true;
+            for (auto &pane: m_panes)
+            {
+                shown = std::max(shown, this->advance(*pane, m_target));
+                finished = finished && pane->finished;
+            }
+            m_scheduler.stepsDone(shown, stepClock.getElapsedTime().asSeconds());
+
+            if (finished)
+            {
+                m_finished = true;
+                this->printSummary();
+            }
+        }
+        else
+            m_scheduler.idle();
+
+        m_scheduler.frameDrawn(this->drawFrame());
+    }
+}
+
+/** Processes all user input */
+void ComparisonView::processInput(sf::Event &event)
+{
+    if (event.type == sf::Event::Closed)
+        m_window.close();
+
+    /* Keep the scale, panes only show more or less of the graph */
+    else if (event.type == sf::Event::Resized)
+        this->layout();
+
+    /* Zoom around mouse cursor */
+    else if (event.type == sf::Event::MouseWheelScrolled && event.mouseWheelScroll.wheel == sf::Mouse::VerticalWheel)
+    {
+        float factor = event.mouseWheelScroll.delta > 0 ? 1.0f / comparisonZoomStep : comparisonZoomStep;
+        this->zoomAt(sf::Vector2i(event.mouseWheelScroll.x, event.mouseWheelScroll.y), factor);
+    }
+
+    /* Pan by dragging with left mouse button */
+    else if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left)
+    {
+        m_dragging = true;
+        m_dragLast = sf::Vector2i(event.mouseButton.x, event.mouseButton.y);
+    }
+    else if (event.type == sf::Event::MouseButtonReleased && event.mouseButton.button == sf::Mouse::Left)
+        m_dragging = false;
+    else if (event.type == sf::Event::MouseMoved && m_dragging)
+    {
+        sf::Vector2i mouse(event.mouseMove.x, event.mouseMove.y);
+        m_center += sf::Vector2f(m_dragLast - mouse) * m_worldPerPixel;
+        m_dragLast = mouse;
+    }
+
+    else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Home)
+        this->fitCamera();
+
+    else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape)
+        m_window.close();
+
+    else if (event.type == sf::Event::KeyReleased && event.key.code == sf::Keyboard::Space)
+    {
+        m_paused = !m_paused;
+        this->updateTitle();
+    }
+
+    /* Speed, same keys as in single view */
+    else if (event.type == sf::Event::KeyPressed && (event.key.code == sf::Keyboard::D || event.key.code == sf::Keyboard::A ||
+                                                     event.key.code == sf::Keyboard::E || event.key.code == sf::Keyboard::Q))
+    {
+        double factor = 2.0;
+        if (event.key.code == sf::Keyboard::A)
+            factor = 0.5;
+        else if (event.key.code == sf::Keyboard::E)
+            factor = 10.0;
+        else if (event.key.code == sf::Keyboard::Q)
+            factor = 0.1;
+
+        m_scheduler.setRate(m_scheduler.rate() * factor);
+        std::cout << "Speed: " << m_scheduler.rate() << " steps per second in every pane" << std::endl;
+    }
+
+    else if (event.type == sf::Event::KeyReleased && event.key.code == sf::Keyboard::C)
+    {
+        m_visualStyle = (m_visualStyle + 1) % 2;
+        m_map.setScheme(defaultColorSchemes[m_visualStyle]);
+        for (auto &pane: m_panes)
+            pane->overlay.setScheme(defaultColorSchemes[m_visualStyle]);
+    }
+
+    else if (event.type == sf::Event::KeyReleased && event.key.code == sf::Keyboard::R)
+        this->restart();
+}
+
+/** Starts all searches again */
+void ComparisonView::restart(void)
+{
+    for (auto &pane: m_panes)
+    {
+        pane->worker.start(static_cast<int>(pane->graph.algoType()));
+        pane->overlay.restore();
+        pane->shown = 0;
+        pane->expansions = 0;
+        pane->searchDone = false;
+        pane->pathProgress = 0;
+        pane->finished = false;
+    }
+
+    m_target = 0;
+    m_finished = false;
+    this->updateTitle();
+}
+
+/** Same rules as GraphVisualisation::showVisitedStep and showPathStep */
+size_t ComparisonView::advance(Pane &pane, size_t target)
+{
+    size_t shown = 0;
+    Position start = pane.graph.startPos();
+    Position end = pane.graph.endPos();
+
+    while (!pane.finished && pane.shown < target)
+    {
+        if (!pane.searchDone)
+        {
+            SearchEvent event;
+            if (!pane.worker.poll(event))
+                break;
+
+            Position x(event.x, event.y);
+            if (event.type == SearchEvent::Type::Done)
+            {
+                pane.worker.join();
+                pane.searchDone = true;
+                continue;
+            }
+            else if (event.type == SearchEvent::Type::Visit)
+            {
+                pane.expansions++;
+                if (x != start && x != end)
+                    pane.overlay.setCell(x, CellState::Step);
+            }
+            else if (x != start && x != end && pane.overlay.cell(x) != CellState::Step)
+                pane.overlay.setCell(x, CellState::Opened);
+        }
+        else
+        {
+            const auto &path = pane.graph.path();
+            if (path.size() == 0 || pane.pathProgress >= path.size() - 1)
+            {
+                pane.finished = true;
+                break;
+            }
+
+            Position x = path[pane.pathProgress++];
+            if (x != start)
+                pane.overlay.setCell(x, CellState::Path);
+        }
+
+        pane.shown++;
+        shown++;
+    }
+
+    return shown;
+}
+
+/** Grid of panes with as many columns as rows (or one more) */
+void ComparisonView::layout(void)
+{
+    sf::Vector2f window(m_window.getSize());
+    size_t count = m_panes.size();
+    size_t cols = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+    size_t rows = (count + cols - 1) / cols;
+
+    float gapX = paneGap / std::max(window.x, 1.0f);
+    float gapY = paneGap / std::max(window.y, 1.0f);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        float width = 1.0f / cols;
+        float height = 1.0f / rows;
+        m_panes[i]->viewport = sf::FloatRect((i % cols) * width + gapX / 2, (i / cols) * height + gapY / 2,
+                                             std::max(width - gapX, 0.0f), std::max(height - gapY, 0.0f));
+    }
+
+    /* Default view follows the window, so pixel coordinates map to the right pane */
+    m_window.setView(sf::View(sf::FloatRect(0, 0, window.x, window.y)));
+}
+
+/** Whole graph fits into every pane with small margin */
+void ComparisonView::fitCamera(void)
+{
+    const float margin = 10.0f;
+
+    sf::Vector2f pane = this->paneSize(*m_panes.front());
+    float rows = static_cast<float>(std::max<size_t>(m_map.rows(), 1));
+    float cols = static_cast<float>(std::max<size_t>(m_map.cols(), 1));
+
+    float pixelsPerCell = std::min((pane.x - 2 * margin) / cols, (pane.y - 2 * margin) / rows);
+    if (pixelsPerCell <= 0)
+        pixelsPerCell = std::max(std::min(pane.x / cols, pane.y / rows), 1e-3f);
+
+    m_worldPerPixel = 1.0f / pixelsPerCell;
+    m_center = sf::Vector2f(cols / 2, rows / 2);
+}
+
+/** Zooms so the point under the cursor stays at the same place */
+void ComparisonView::zoomAt(sf::Vector2i pixel, float factor)
+{
+    float maxWorldPerPixel = std::max<float>(std::max(m_map.rows(), m_map.cols()) / 100.0f, 1.0f);
+    float worldPerPixel = std::clamp(m_worldPerPixel * factor, 1.0f / 64, maxWorldPerPixel);
+
+    /* Pane under the cursor, others follow it */
+    const Pane *target = m_panes.front().get();
+    sf::Vector2f window(m_window.getSize());
+    for (auto &pane: m_panes)
+    {
+        if (pane->viewport.contains(pixel.x / window.x, pixel.y / window.y))
+            target = pane.get();
+    }
+
+    sf::Vector2f before = m_window.mapPixelToCoords(pixel, this->paneView(*target));
+    m_worldPerPixel = worldPerPixel;
+    sf::Vector2f after = m_window.mapPixelToCoords(pixel, this->paneView(*target));
+    m_center += before - after;
+}
+
+/** Camera of the pane */
+sf::View ComparisonView::paneView(const Pane &pane) const
+{
+    sf::View view(m_center, this->paneSize(pane) * m_worldPerPixel);
+    view.setViewport(pane.viewport);
+    return view;
+}
+
+/** Size of the pane in pixels */
+sf::Vector2f ComparisonView::paneSize(const Pane &pane) const
+{
+    sf::Vector2f window(m_window.getSize());
+    return sf::Vector2f(pane.viewport.width * window.x, pane.viewport.height * window.y);
+}
+
+double ComparisonView::drawFrame(void)
+{
+    const ColorScheme &scheme = defaultColorSchemes[m_visualStyle];
+
+    PROFILE_ZONE("draw");
+    sf::Clock workClock;
+
+    /* Gaps between panes have colour of the walls, so borders of panes are visible */
+    m_window.clear(sf::Color(scheme.wall.r, scheme.wall.g, scheme.wall.b, 255));
+    for (auto &pane: m_panes)
+    {
+        sf::View view = this->paneView(*pane);
+        sf::Vector2f size = view.getSize();
+
+        /* Background only inside the pane */
+        m_window.setView(view);
+        sf::RectangleShape background(size);
+        background.setPosition(view.getCenter() - size / 2.0f);
+        background.setFillColor(sf::Color(scheme.background.r, scheme.background.g, scheme.background.b, 255));
+        m_window.draw(background);
+
+        m_map.draw(m_window, view);
+        pane->overlay.draw(m_window, view);
+        pane->overlay.takeStats();
+    }
+    m_map.takeStats();
+    m_window.setView(sf::View(sf::FloatRect(0, 0, m_window.getSize().x, m_window.getSize().y)));
+    this->appendCounters();
+    m_window.draw(m_counters);
+    double workSeconds = workClock.getElapsedTime().asSeconds();
+    m_window.display();
+    return workSeconds;
+}
+
+/** Panes are in the order of SearchAlgorithmType, row by row */
+void ComparisonView::appendCounters(void)
+{
+    sf::Vector2f window(m_window.getSize());
+    m_counters.clear();
+    for (const auto &pane: m_panes)
+    {
+        std::ostringstream time;
+        time << std::fixed << std::setprecision(2) << 1000.0 * pane->worker.searchSeconds();
+        std::vector<std::string> text = {algoTypeToStr(pane->graph.algoType()), "EXPANDED " + std::to_string(pane->expansions),
+                                         "SEARCH " + time.str() + " MS"};
+        if (pane->finished)
+            text.push_back("PATH " + std::to_string(pane->graph.path().size()));
+
+        PerformanceHud::appendLabel(m_counters, pane->viewport.left * window.x + paneGap, pane->viewport.top * window.y + paneGap, text);
+    }
+}
+
+void ComparisonView::updateTitle(void)
+{
+    m_window.setTitle(std::string("Graph Visualisation - comparison") + (m_paused ? " (PAUSED)" : ""));
+}
+
+/** Prints results of all algorithms */
+void ComparisonView::printSummary(void)
+{
+    std::cout << std::left << std::setw(8) << "algo" << std::right << std::setw(12) << "expansions" << std::setw(10) << "path"
+              << std::setw(12) << "search ms" << std::endl;
+    for (auto &pane: m_panes)
+    {
+        std::cout << std::left << std::setw(8) << algoTypeToStr(pane->graph.algoType()) << std::right << std::setw(12)
+                  << pane->expansions << std::setw(10) << pane->graph.path().size() << std::setw(12) << std::fixed
+                  << std::setprecision(3) << 1000.0 * pane->worker.searchSeconds() << std::endl;
+    }
+    std::cout.unsetf(std::ios::fixed);
+}
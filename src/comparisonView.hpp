@@ -0,0 +1,131 @@
+/**
+* @file comparisonView.hpp
+* @author Ondrej
+* @brief Split screen that animates all search algorithms at the same time
+*
+*/
+
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "graph.hpp"
+#include "gridRenderer.hpp"
+#include "performanceHud.hpp"
+#include "playbackScheduler.hpp"
+#include "searchWorker.hpp"
+
+
+/**
+* @brief One pane for every SearchAlgorithmType, all panes share the map of one graph
+* - Every pane has own graph (search state), search thread and overlay of cells changed by its search, walls and free
+*   cells are drawn below the overlays by one renderer shared by all panes
+* - Panes are animated in lockstep, n-th step of every algorithm is displayed in the same frame
+* - All panes look at the same part of the map, zoom and pan move all of them
+**/
+class ComparisonView
+{
+public:
+    ComparisonView(const Graph &graph, sf::RenderWindow &window, size_t visualisationSpeed);
+
+    /** Main window loop */
+    void windowLoop(void);
+
+private:
+    struct Pane
+    {
+        Pane(const Graph &map, SearchAlgorithmType algoType) : graph(map, algoType), worker(graph) {};
+
+        Graph graph;
+
+        SearchWorker worker;
+
+        /** Overlay of m_map, only textures of the cell states */
+        GridRenderer overlay;
+
+        /** Part of the window, fractions as sf::View::setViewport expects */
+        sf::FloatRect viewport;
+
+        /** Steps displayed since the start (visited, opened and path) */
+        size_t shown = 0;
+
+        /** Visit events displayed */
+        size_t expansions = 0;
+
+        bool searchDone = false;
+
+        size_t pathProgress = 0;
+
+        bool finished = false;
+    };
+
+    /** Processes all user input */
+    void processInput(sf::Event &event);
+
+    /** Starts all searches again */
+    void restart(void);
+
+    /** Displays steps of the pane until it has shown target steps, returns number of displayed steps */
+    size_t advance(Pane &pane, size_t target);
+
+    /** Divides the window between panes */
+    void layout(void);
+
+    /** Sets camera so the whole graph fits into one pane */
+    void fitCamera(void);
+
+    /** Zooms so the point under the cursor stays at the same place in its pane */
+    void zoomAt(sf::Vector2i pixel, float factor);
+
+    /** Camera of the pane */
+    sf::View paneView(const Pane &pane) const;
+
+    /** Size of the pane in pixels */
+    sf::Vector2f paneSize(const Pane &pane) const;
+
+    /** Draws all panes, returns the seconds of uploading and drawing (without waiting in display) */
+    double drawFrame(void);
+
+    /** Appends expansions and search time of every pane in its top left corner, the window has to use its default view */
+    void appendCounters(void);
+
+    /** Title says only whether the comparison is paused, counters are drawn in the panes */
+    void updateTitle(void);
+
+    /** Prints results of all algorithms */
+    void printSummary(void);
+
+    sf::RenderWindow &m_window;
+
+    /** Map without any search state, drawn in every pane below its overlay */
+    GridRenderer m_map;
+
+    /** Pane owns graph that is referenced by its worker, so panes are not moved */
+    std::vector<std::unique_ptr<Pane>> m_panes;
+
+    PlaybackScheduler m_scheduler;
+
+    /** Every pane displays this many steps (if it has them) */
+    size_t m_target = 0;
+
+    bool m_paused = false;
+
+    bool m_finished = false;
+
+    int m_visualStyle = 0;
+
+    /** Centre of all pane cameras, world unit is one cell */
+    sf::Vector2f m_center;
+
+    float m_worldPerPixel = 1.0f;
+
+    bool m_dragging = false;
+
+    sf::Vector2i m_dragLast;
+
+    /** Counters of all panes, drawn in one call */
+    sf::VertexArray m_counters{sf::Quads};
+};
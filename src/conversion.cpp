@@ -19,6 +19,13 @@ bool strToNum(const std::string str, size_t &value)
     return false;
 }
 
+/* Converts string to floating point number, returns "false" if the string is not a number */
+bool strToNum(const std::string str, double &value)
+{
+    std::istringstream parse(str);
+    return parse >> value && (parse >> std::ws).eof();
+}
+
 /* Converts string to pathfinding algorithm type */
 bool strToAlgoType(std::string str, SearchAlgorithmType &algoType)
 {
@@ -40,8 +47,37 @@ bool strToAlgoType(std::string str, SearchAlgorithmType &algoType)
     else if (str == "astar")
         algoType = SearchAlgorithmType::AStar;
 
+    else if (str == "wastar")
+        algoType = SearchAlgorithmType::WeightedAStar;
+
+    else if (str == "focal")
+        algoType = SearchAlgorithmType::FocalSearch;
+
     else
         return false;
 
     return true;
-}
\ No newline at end of file
+}
+
+/* Converts pathfinding algorithm type to the string strToAlgoType accepts */
+std::string algoTypeToStr(SearchAlgorithmType algoType)
+{
+    switch (algoType)
+    {
+        case SearchAlgorithmType::BFS:
+            return "bfs";
+        case SearchAlgorithmType::DFS:
+            return "dfs";
+        case SearchAlgorithmType::RandomSearch:
+            return "random";
+        case SearchAlgorithmType::GreedySearch:
+            return "greedy";
+        case SearchAlgorithmType::AStar:
+            return "astar";
+        case SearchAlgorithmType::WeightedAStar:
+            return "wastar";
+        case SearchAlgorithmType::FocalSearch:
+            return "focal";
+    }
+    return "";
+}
@@ -14,5 +14,11 @@
 /* Converts string to number, returns "true" if string contains at least one digit and "false" if it doesn't contain any number */
 bool strToNum(const std::string str, size_t &value);
 
+/* Converts string to floating point number, returns "false" if the string is not a number */
+bool strToNum(const std::string str, double &value);
+
 /* Converts string to pathfinding algorithm type */
 bool strToAlgoType(std::string str, SearchAlgorithmType &algoType);
+
+/* Converts pathfinding algorithm type to the string strToAlgoType accepts */
+std::string algoTypeToStr(SearchAlgorithmType algoType);
@@ -0,0 +1,189 @@
+/**
+* @file corridorPruning.cpp
+* @author Ondrej
+* @brief Implementation of the dead-end and corridor decomposition
+**/
+
+#include "corridorPruning.hpp"
+
+#include <cstdlib>
+
+CorridorDecomposition::CorridorDecomposition(const SearchGrid &grid)
+    : m_enter(grid.size(), none), m_exit(grid.size(), none), m_attachment(grid.size(), none), m_corridorOf(grid.size(), none)
+{
+    std::vector<uint8_t> degree(grid.size(), 0);
+    std::vector<uint32_t> order;
+    for (uint32_t cell = 0; cell < grid.size(); cell++)
+    {
+        if (!grid.passable(cell))
+            continue;
+        Position pos = grid.position(cell);
+        FourConnected::forEach(grid, pos.first, pos.second, [&](int, int, double) { degree[cell]++; });
+        if (degree[cell] <= 1)
+            order.push_back(cell);
+    }
+
+    /* Peeling, a cell is removed when at most one neighbour remains, that neighbour is its parent */
+    std::vector<uint8_t> removed(grid.size(), 0);
+    std::vector<uint32_t> parent(grid.size(), none);
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        uint32_t cell = order[i];
+        removed[cell] = 1;
+        Position pos = grid.position(cell);
+        FourConnected::forEach(grid, pos.first, pos.second, [&](int x, int y, double) {
+            uint32_t next = grid.index(x, y);
+            if (removed[next])
+                return;
+            parent[cell] = next;
+            if (--degree[next] == 1)
+                order.push_back(next);
+        });
+    }
+    m_deadEndCells = order.size();
+
+    /* Children are peeled before parents, so sizes of subtrees go forward and preorder numbers backward */
+    std::vector<uint32_t> size(grid.size(), 1);
+    for (uint32_t cell: order)
+    {
+        if (parent[cell] != none && removed[parent[cell]])
+            size[parent[cell]] += size[cell];
+    }
+    std::vector<uint32_t> nextChild(grid.size(), 0);
+    uint32_t counter = 0;
+    for (auto it = order.rbegin(); it != order.rend(); it++)
+    {
+        uint32_t cell = *it;
+        uint32_t up = parent[cell];
+        if (up != none && removed[up])
+        {
+            m_enter[cell] = nextChild[up];
+            m_attachment[cell] = m_attachment[up];
+        }
+        else
+        {
+            m_enter[cell] = counter;
+            m_attachment[cell] = up;
+            counter += size[cell];
+        }
+        m_exit[cell] = m_enter[cell] + size[cell];
+        nextChild[cell] = m_enter[cell] + 1;
+        if (up != none && removed[up])
+            nextChild[up] += size[cell];
+    }
+
+    /* Core cells with two core neighbours are corridor cells, corridors are walked from the junctions */
+    auto corridorCell = [&](uint32_t cell) { return grid.passable(cell) && !removed[cell] && degree[cell] == 2; };
+    auto walk = [&](uint32_t from, uint32_t cell, uint32_t firstEnd) {
+        Corridor corridor{static_cast<uint32_t>(m_cells.size()), 0, firstEnd, none};
+        uint32_t id = static_cast<uint32_t>(m_corridors.size());
+        while (cell != none && corridorCell(cell) && m_corridorOf[cell] == none)
+        {
+            m_corridorOf[cell] = id;
+            m_cells.push_back(cell);
+            corridor.length++;
+
+            uint32_t next = none;
+            Position pos = grid.position(cell);
+            FourConnected::forEach(grid, pos.first, pos.second, [&](int x, int y, double) {
+                uint32_t neighbour = grid.index(x, y);
+                if (!removed[neighbour] && neighbour != from)
+                    next = neighbour;
+            });
+            from = cell;
+            cell = next;
+        }
+        if (cell != none && !corridorCell(cell))
+            corridor.lastEnd = cell;
+        m_corridors.push_back(corridor);
+    };
+
+    for (uint32_t cell = 0; cell < grid.size(); cell++)
+    {
+        if (!grid.passable(cell) || removed[cell] || corridorCell(cell))
+            continue;
+        Position pos = grid.position(cell);
+        FourConnected::forEach(grid, pos.first, pos.second, [&](int x, int y, double) {
+            uint32_t next = grid.index(x, y);
+            if (corridorCell(next) && m_corridorOf[next] == none)
+                walk(cell, next, cell);
+        });
+    }
+    /* Rings of corridor cells without any junction */
+    for (uint32_t cell = 0; cell < grid.size(); cell++)
+    {
+        if (corridorCell(cell) && m_corridorOf[cell] == none)
+            walk(none, cell, none);
+    }
+}
+
+size_t CorridorDecomposition::bytes(void) const
+{
+    return (m_enter.capacity() + m_exit.capacity() + m_attachment.capacity() + m_corridorOf.capacity() + m_cells.capacity()) * sizeof(uint32_t) +
+           m_corridors.capacity() * sizeof(Corridor);
+}
+
+CorridorGrid::CorridorGrid(const SearchGrid &grid, const CorridorDecomposition &corridors, Position start, Position goal)
+    : m_grid(grid), m_corridors(corridors)
+{
+    if (grid.passable(start.first, start.second))
+        m_anchors.push_back(grid.index(start.first, start.second));
+    else if (grid.inside(start.first, start.second))
+    {
+        FourConnected::forEach(grid, start.first, start.second, [&](int x, int y, double) { m_anchors.push_back(grid.index(x, y)); });
+    }
+    if (grid.passable(goal.first, goal.second))
+        m_anchors.push_back(grid.index(goal.first, goal.second));
+
+    for (uint32_t anchor: m_anchors)
+    {
+        uint32_t junction = corridors.core(anchor) ? anchor : corridors.attachment(anchor);
+        if (junction != CorridorDecomposition::none && corridors.corridorOf(junction) != CorridorDecomposition::none)
+            m_markedCorridors.push_back(corridors.corridorOf(junction));
+    }
+}
+
+void expandCorridorPath(SearchPath &path, const SearchGrid &grid, const CorridorDecomposition &corridors)
+{
+    if (path.size() < 2)
+        return;
+
+    SearchPath expanded(path.get_allocator());
+    expanded.push_back(path.front());
+    for (size_t i = 1; i < path.size(); i++)
+    {
+        Position from = path[i - 1];
+        Position to = path[i];
+        if (std::abs(from.first - to.first) + std::abs(from.second - to.second) == 1)
+        {
+            expanded.push_back(to);
+            continue;
+        }
+
+        /* Jump between two junctions, the search kept the shortest corridor between them */
+        uint32_t fromCell = grid.index(from.first, from.second);
+        uint32_t toCell = grid.index(to.first, to.second);
+        const Corridor *shortest = nullptr;
+        FourConnected::forEach(grid, from.first, from.second, [&](int x, int y, double) {
+            uint32_t id = corridors.corridorOf(grid.index(x, y));
+            if (id == CorridorDecomposition::none)
+                return;
+            const Corridor &corridor = corridors.corridor(id);
+            bool connects = (corridor.firstEnd == fromCell && corridor.lastEnd == toCell) ||
+                            (corridor.firstEnd == toCell && corridor.lastEnd == fromCell);
+            if (connects && (!shortest || corridor.length < shortest->length))
+                shortest = &corridor;
+        });
+        if (!shortest)
+            continue;
+
+        const auto &cells = corridors.cells();
+        for (uint32_t j = 0; j < shortest->length; j++)
+        {
+            uint32_t k = shortest->firstEnd == fromCell ? j : shortest->length - 1 - j;
+            expanded.push_back(grid.position(cells[shortest->offset + k]));
+        }
+        expanded.push_back(to);
+    }
+    path = std::move(expanded);
+}
@@ -0,0 +1,206 @@
+/**
+* @file corridorPruning.hpp
+* @author Ondrej
+* @brief Dead-end and corridor pruning, searches skip branches without start and goal and jump over corridors
+*
+* Free cells with at most one free neighbour are peeled off repeatedly, what is peeled forms trees hanging from the
+* remaining core (on a perfect maze everything is peeled). A peeled subtree is connected to the rest only through its
+* root, so a shortest path enters it only if it contains the start or the goal. Core cells with exactly two core
+* neighbours form corridors, a search entering a corridor from a junction jumps to its other end at once.
+**/
+
+#pragma once
+
+#include "graph.hpp"
+#include "gridMap.hpp"
+#include "searchKernel.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+
+/** Corridor between two junctions, its cells are stored in order from the first end */
+struct Corridor
+{
+    /** Index of the first cell in CorridorDecomposition::cells */
+    uint32_t offset;
+    uint32_t length;
+    /** Junctions next to the first and to the last cell, none for a ring without junctions */
+    uint32_t firstEnd;
+    uint32_t lastEnd;
+};
+
+/** Dead-end trees and corridors of a map, built once per map (GridMap::corridors) */
+class CorridorDecomposition
+{
+public:
+    static constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+
+    explicit CorridorDecomposition(const SearchGrid &grid);
+
+    /** Free cell that is not in a dead-end tree */
+    bool core(uint32_t cell) const { return m_enter[cell] == none; }
+
+    /** Dead-end cell ancestor is on the way from the dead-end cell cell to the core (a cell is its own ancestor) */
+    bool ancestor(uint32_t ancestor, uint32_t cell) const
+    {
+        return m_enter[cell] != none && m_enter[ancestor] <= m_enter[cell] && m_enter[cell] < m_exit[ancestor];
+    }
+
+    /** Core cell the dead-end tree of the cell hangs from, none for trees that are whole components */
+    uint32_t attachment(uint32_t cell) const { return m_attachment[cell]; }
+
+    /** Corridor of the cell, none for junctions, dead ends and walls */
+    uint32_t corridorOf(uint32_t cell) const { return m_corridorOf[cell]; }
+
+    const Corridor &corridor(uint32_t id) const { return m_corridors[id]; }
+
+    /** Cells of all corridors, each corridor is a range */
+    const std::vector<uint32_t> &cells(void) const { return m_cells; }
+
+    size_t corridors(void) const { return m_corridors.size(); }
+
+    /** Cells in dead-end trees */
+    size_t deadEndCells(void) const { return m_deadEndCells; }
+
+    size_t bytes(void) const;
+
+private:
+    /** Dead-end cells are numbered in preorder of their trees, the subtree of a cell is [enter, exit) */
+    std::vector<uint32_t> m_enter;
+
+    std::vector<uint32_t> m_exit;
+
+    std::vector<uint32_t> m_attachment;
+
+    std::vector<uint32_t> m_corridorOf;
+
+    std::vector<Corridor> m_corridors;
+
+    std::vector<uint32_t> m_cells;
+
+    size_t m_deadEndCells = 0;
+};
+
+/** Grid of one pruned search, the decomposition with the cells the start and the goal depend on */
+class CorridorGrid
+{
+public:
+    /** Start on a wall is represented by its free neighbours */
+    CorridorGrid(const SearchGrid &grid, const CorridorDecomposition &corridors, Position start, Position goal);
+
+    uint32_t width(void) const { return m_grid.width(); }
+
+    uint32_t height(void) const { return m_grid.height(); }
+
+    size_t size(void) const { return m_grid.size(); }
+
+    uint32_t index(int x, int y) const { return m_grid.index(x, y); }
+
+    Position position(uint32_t cell) const { return m_grid.position(cell); }
+
+    bool inside(int x, int y) const { return m_grid.inside(x, y); }
+
+    bool passable(int x, int y) const { return m_grid.passable(x, y); }
+
+    bool passable(uint32_t cell) const { return m_grid.passable(cell); }
+
+    const CorridorDecomposition &corridors(void) const { return m_corridors; }
+
+    /** Free cell in a dead-end tree that contains neither the start nor the goal */
+    bool pruned(uint32_t cell) const
+    {
+        if (m_corridors.core(cell))
+            return false;
+        for (uint32_t anchor: m_anchors)
+        {
+            if (m_corridors.ancestor(cell, anchor))
+                return false;
+        }
+        return true;
+    }
+
+    /** Corridor contains the start, the goal or the junction of their dead-end trees, it has to be walked cell by cell */
+    bool marked(uint32_t corridor) const
+    {
+        return std::find(m_markedCorridors.begin(), m_markedCorridors.end(), corridor) != m_markedCorridors.end();
+    }
+
+private:
+    const SearchGrid &m_grid;
+
+    const CorridorDecomposition &m_corridors;
+
+    /** Free cells of the start and the goal */
+    std::vector<uint32_t> m_anchors;
+
+    std::vector<uint32_t> m_markedCorridors;
+};
+
+/**
+* @brief Neighbourhood of the pruned search, costs are the numbers of 4-connected steps
+* - Neighbours in pruned dead-end trees are skipped
+* - From a junction, the first cell of an unmarked corridor is replaced by the junction at its other end
+**/
+struct CorridorPruning
+{
+    template <typename Visit>
+    static void forEach(const CorridorGrid &grid, int x, int y, Visit &&visit)
+    {
+        const CorridorDecomposition &corridors = grid.corridors();
+        uint32_t cell = grid.index(x, y);
+        bool junction = grid.passable(cell) && corridors.core(cell) && corridors.corridorOf(cell) == CorridorDecomposition::none;
+
+        FourConnected::forEach(grid, x, y, [&](int nextX, int nextY, double cost) {
+            uint32_t next = grid.index(nextX, nextY);
+            if (grid.pruned(next))
+                return;
+
+            uint32_t id = corridors.corridorOf(next);
+            if (!junction || id == CorridorDecomposition::none || grid.marked(id))
+            {
+                visit(nextX, nextY, cost);
+                return;
+            }
+
+            /* Junction next to an unmarked corridor is one of its ends, a corridor back to the same junction never
+               shortens a path */
+            const Corridor &corridor = corridors.corridor(id);
+            uint32_t end = corridor.firstEnd == cell ? corridor.lastEnd : corridor.firstEnd;
+            if (corridor.firstEnd == corridor.lastEnd)
+                return;
+            Position pos = grid.position(end);
+            visit(pos.first, pos.second, corridor.length + 1.0);
+        });
+    }
+};
+
+/** Fills the corridor cells skipped by the jumps of path */
+void expandCorridorPath(SearchPath &path, const SearchGrid &grid, const CorridorDecomposition &corridors);
+
+/**
+* @brief BFS and A* with dead ends and corridors pruned (the decomposition is built on the first use), other algorithms
+*        run unpruned
+* - BFS is uniform cost search over the pruned grid, it finds a path as short as BFS, not necessarily the same one
+* - Trace receives only the expanded cells, path receives every cell
+**/
+template <typename Trace>
+KernelStats runCorridorAlgorithm(SearchAlgorithmType algoType, const GridMap &map, SearchWorkspace &work, Trace &trace, Position start,
+                                 Position goal, SearchPath *path, double suboptimality = defaultSuboptimality)
+{
+    if (algoType != SearchAlgorithmType::BFS && algoType != SearchAlgorithmType::AStar)
+        return runAlgorithm(algoType, map.searchGrid(), work, trace, start, goal, path, suboptimality);
+
+    CorridorGrid grid(map.searchGrid(), map.corridors(), start, goal);
+    ZeroHeuristic zero;
+    ManhattanHeuristic manhattan;
+    KernelStats stats = algoType == SearchAlgorithmType::BFS
+                            ? searchKernel<CorridorPruning, ZeroHeuristic, BestFirstOpen<AStarKey>>(grid, work, zero, trace, start, goal, path)
+                            : searchKernel<CorridorPruning, ManhattanHeuristic, BestFirstOpen<AStarKey>>(grid, work, manhattan, trace, start,
+                                                                                                         goal, path);
+    if (path)
+        expandCorridorPath(*path, map.searchGrid(), map.corridors());
+    return stats;
+}
@@ -0,0 +1,123 @@
+/**
+* @file exporter.cpp
+* @author Ondrej
+* @brief Command line tool that renders the visualisation without window into PNG sequence or animated GIF
+*/
+
+#include "conversion.hpp"
+#include "frameExport.hpp"
+#include "graph.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+/** Prints usage */
+static void usage(void)
+{
+    std::cerr << "Usage: ./exporter <bfs|dfs|random|greedy|astar|wastar|focal> <map> <output> [options]" << std::endl;
+    std::cerr << "  output ending with .gif is animated GIF, anything else is directory for PNG frames" << std::endl;
+    std::cerr << "  --stride <n>   steps between two frames (default 1)" << std::endl;
+    std::cerr << "  --cell <n>     pixels per cell (default fits the map into --size)" << std::endl;
+    std::cerr << "  --size <n>     largest image width/height, larger maps are downsampled (default 800)" << std::endl;
+    std::cerr << "  --threads <n>  encoder threads (default one per hardware thread)" << std::endl;
+    std::cerr << "  --delay <n>    GIF frame delay in hundredths of second (default 4)" << std::endl;
+    std::cerr << "  --epsilon <e>  suboptimality bound of wastar and focal (default " << defaultSuboptimality << ")" << std::endl;
+    std::cerr << "  --style <n>    colour scheme 0 or 1 (default 0)" << std::endl;
+}
+
+/**
+* @brief Exports visualisation of one search
+* - Argument 1: Algorithm type (bfs/dfs/astar/random/greedy/wastar/focal)
+* - Argument 2: Map file (text or binary)
+* - Argument 3: Output GIF file or PNG directory
+*/
+int main(int argc, char **argv)
+{
+    ExportOptions options;
+    double suboptimality = defaultSuboptimality;
+
+    std::vector<std::string> arguments;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+        size_t *value = nullptr;
+
+        if (argument == "--stride")
+            value = &options.stride;
+        else if (argument == "--cell")
+            value = &options.cellPixels;
+        else if (argument == "--size")
+            value = &options.maxSize;
+        else if (argument == "--threads")
+            value = &options.threads;
+        else if (argument == "--style")
+            value = &options.style;
+        else if (argument == "--delay" && hasValue)
+        {
+            size_t delay;
+            if (!strToNum(argv[++i], delay) || delay > 0xFFFF)
+            {
+                usage();
+                return EXIT_FAILURE;
+            }
+            options.delay = static_cast<unsigned>(delay);
+            continue;
+        }
+        else if (argument == "--epsilon" && hasValue)
+        {
+            if (!strToNum(argv[++i], suboptimality) || !(suboptimality >= 0.0))
+            {
+                usage();
+                return EXIT_FAILURE;
+            }
+            continue;
+        }
+        else if (argument.rfind("--", 0) == 0)
+        {
+            usage();
+            return EXIT_FAILURE;
+        }
+        else
+        {
+            arguments.push_back(argument);
+            continue;
+        }
+
+        if (!hasValue || !strToNum(argv[++i], *value))
+        {
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    SearchAlgorithmType algorithmType;
+    if (arguments.size() != 3 || !strToAlgoType(arguments[0], algorithmType) || options.maxSize == 0)
+    {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    const std::string &output = arguments[2];
+    bool gif = output.size() >= 4 && output.compare(output.size() - 4, 4, ".gif") == 0;
+    options.format = gif ? ExportFormat::Gif : ExportFormat::Png;
+
+    try
+    {
+        Graph graph(algorithmType, arguments[1]);
+        graph.setSuboptimality(suboptimality);
+        ExportStats stats = exportSearch(graph, options, output);
+
+        std::cout << "Frames: " << stats.frames << " (" << stats.width << " x " << stats.height << "), " << stats.bytes << " bytes" << std::endl;
+        std::cout << "Time: " << stats.seconds << " s, " << stats.frames / stats.seconds << " frames per second" << std::endl;
+        graph.pathInfo();
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,290 @@
+/**
+* @file frameExport.cpp
+* @author Ondrej
+* @brief Implementation of headless export
+**/
+
+#include "frameExport.hpp"
+#include "imageEncoder.hpp"
+#include "searchWorker.hpp"
+#include "threadPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+/** Delay of the last frame in hundredths of second */
+const unsigned holdDelay = 200;
+
+/** Collects steps of the search in the order the window would receive them */
+class EventRecorder : public SearchListener
+{
+public:
+    void visited(Position pos) override { events.push_back(SearchEvent{SearchEvent::Type::Visit, pos.first, pos.second}); }
+
+    void opened(Position, Position to) override { events.push_back(SearchEvent{SearchEvent::Type::Open, to.first, to.second}); }
+
+    bool cancelled(void) override { return false; }
+
+    std::vector<SearchEvent> events;
+};
+
+/** When more cells share one pixel, the highlighted one wins (path stays visible on downsampled maps) */
+static int statePriority(CellState state)
+{
+    switch (state)
+    {
+        case CellState::Wall:
+            return 0;
+        case CellState::Empty:
+            return 1;
+        case CellState::Tree:
+            return 2;
+        case CellState::Opened:
+            return 3;
+        case CellState::Step:
+            return 4;
+        case CellState::Path:
+            return 5;
+        case CellState::StartEnd:
+            return 6;
+    }
+    return 0;
+}
+
+/** State of every cell and image where one pixel covers block x block cells, pixel value is CellState */
+class FrameRecorder
+{
+public:
+    FrameRecorder(const Graph &graph, size_t block);
+
+    /** Changes state of the cell, same rules as the window */
+    void apply(const SearchEvent &event);
+
+    /** Path step */
+    void paintPath(Position pos);
+
+    const IndexedImage &image(void) const { return m_image; }
+
+private:
+    void paint(Position pos, CellState state);
+
+    bool inside(Position pos) const { return pos.first >= 0 && pos.second >= 0 && pos.first < (int) m_cols && pos.second < (int) m_rows; }
+
+    size_t m_rows;
+
+    size_t m_cols;
+
+    size_t m_block;
+
+    Position m_start;
+
+    Position m_end;
+
+    std::vector<CellState> m_cells;
+
+    IndexedImage m_image;
+};
+
+FrameRecorder::FrameRecorder(const Graph &graph, size_t block)
+    : m_block(block),
+      m_start(graph.startPos()),
+      m_end(graph.endPos())
+{
+    const auto &grid = graph.grid();
+    m_rows = grid.size();
+    m_cols = grid.empty() ? 0 : grid[0].size();
+
+    m_cells.assign(m_rows * m_cols, CellState::Wall);
+    m_image.width = (m_cols + block - 1) / block;
+    m_image.height = (m_rows + block - 1) / block;
+    m_image.pixels.assign(m_image.width * m_image.height, static_cast<uint8_t>(CellState::Wall));
+
+    for (size_t y = 0; y < m_rows; y++)
+    {
+        for (size_t x = 0; x < m_cols && x < grid[y].size(); x++)
+        {
+            if (grid[y][x] == 1)
+                this->paint(Position(x, y), CellState::Empty);
+            else if (grid[y][x] != 0)
+                this->paint(Position(x, y), CellState::Tree);
+        }
+    }
+    this->paint(m_start, CellState::StartEnd);
+    this->paint(m_end, CellState::StartEnd);
+}
+
+void FrameRecorder::paint(Position pos, CellState state)
+{
+    if (!this->inside(pos))
+        return;
+
+    m_cells[pos.second * m_cols + pos.first] = state;
+
+    uint8_t &pixel = m_image.pixels[(pos.second / m_block) * m_image.width + pos.first / m_block];
+    if (statePriority(state) > statePriority(static_cast<CellState>(pixel)))
+        pixel = static_cast<uint8_t>(state);
+}
+
+/** Same as GraphVisualisation::showVisitedStep */
+void FrameRecorder::apply(const SearchEvent &event)
+{
+    Position x(event.x, event.y);
+    if (x == m_start || x == m_end || !this->inside(x))
+        return;
+
+    if (event.type == SearchEvent::Type::Visit)
+        this->paint(x, CellState::Step);
+    else if (event.type == SearchEvent::Type::Open && m_cells[x.second * m_cols + x.first] != CellState::Step)
+        this->paint(x, CellState::Opened);
+}
+
+void FrameRecorder::paintPath(Position pos)
+{
+    if (pos != m_start)
+        this->paint(pos, CellState::Path);
+}
+
+/** Runs search, replays it and encodes frames on thread pool, at most 2 frames per thread wait for writing */
+ExportStats exportSearch(Graph &graph, const ExportOptions &options, const std::string &output)
+{
+    auto begin = std::chrono::steady_clock::now();
+
+    if (options.stride == 0)
+        throw std::invalid_argument("Stride has to be at least 1");
+    if (options.style >= defaultColorSchemes.size())
+        throw std::invalid_argument("Unknown style");
+    if (graph.grid().empty() || graph.grid()[0].empty())
+        throw std::invalid_argument("Map is empty");
+
+    /* Small maps are scaled up, large maps are downsampled so the image fits into maxSize */
+    size_t rows = graph.grid().size();
+    size_t cols = graph.grid()[0].size();
+    size_t largest = std::max(rows, cols);
+    size_t block = 1;
+    size_t scale = options.cellPixels;
+    if (scale == 0)
+    {
+        if (largest <= options.maxSize)
+            scale = std::max<size_t>(options.maxSize / largest, 1);
+        else
+        {
+            scale = 1;
+            block = (largest + options.maxSize - 1) / options.maxSize;
+        }
+    }
+
+    EventRecorder events;
+    graph.reset();
+    graph.setListener(&events);
+    graph.setUp(-1);
+    graph.setListener(nullptr);
+
+    std::vector<RGB> palette;
+    for (int state = 0; state < cellStateCount; state++)
+        palette.push_back(stateColor(defaultColorSchemes[options.style], static_cast<CellState>(state)));
+
+    FrameRecorder recorder(graph, block);
+
+    ExportStats stats;
+    stats.width = recorder.image().width * scale;
+    stats.height = recorder.image().height * scale;
+
+    std::ofstream gifFile;
+    std::unique_ptr<GifWriter> gif;
+    if (options.format == ExportFormat::Gif)
+    {
+        gifFile.open(output, std::ios::binary);
+        if (!gifFile)
+            throw std::runtime_error("Cannot open " + output);
+        gif = std::make_unique<GifWriter>(gifFile, stats.width, stats.height, palette);
+    }
+    else
+    {
+        std::error_code error;
+        fs::create_directories(output, error);
+        if (error)
+            throw std::runtime_error("Cannot create directory " + output);
+    }
+
+    /* Declared after everything the tasks use, so the threads are joined first */
+    ThreadPool pool(options.threads);
+    std::deque<std::future<std::vector<uint8_t>>> pending;
+    size_t written = 0;
+
+    /* Frames are written in order, the oldest one is waited for */
+    auto writeOldest = [&]() {
+        std::vector<uint8_t> encoded = pending.front().get();
+        pending.pop_front();
+
+        if (gif)
+            gif->writeFrame(encoded);
+        else
+        {
+            char name[32];
+            std::snprintf(name, sizeof(name), "frame_%06zu.png", written);
+            std::ofstream file(fs::path(output) / name, std::ios::binary);
+            file.write(reinterpret_cast<const char *>(encoded.data()), encoded.size());
+            if (!file)
+                throw std::runtime_error("Cannot write " + (fs::path(output) / name).string());
+        }
+        written++;
+        stats.bytes += encoded.size();
+    };
+
+    auto emitFrame = [&](unsigned delay) {
+        if (pending.size() >= 2 * pool.size())
+            writeOldest();
+
+        IndexedImage snapshot = recorder.image();
+        if (gif)
+        {
+            size_t paletteSize = palette.size();
+            pending.push_back(pool.submit([snapshot = std::move(snapshot), scale, paletteSize, delay]() {
+                return GifWriter::encodeFrame(upscale(snapshot, scale), paletteSize, delay);
+            }));
+        }
+        else
+            pending.push_back(pool.submit([snapshot = std::move(snapshot), scale, &palette]() { return encodePng(upscale(snapshot, scale), palette); }));
+        stats.frames++;
+    };
+
+    size_t steps = 0;
+    auto step = [&]() {
+        if (++steps % options.stride == 0)
+            emitFrame(options.delay);
+    };
+
+    emitFrame(options.delay);
+
+    for (const SearchEvent &event: events.events)
+    {
+        recorder.apply(event);
+        step();
+    }
+
+    /* Path without the end, as in the window */
+    const auto &path = graph.path();
+    for (size_t i = 0; i + 1 < path.size(); i++)
+    {
+        recorder.paintPath(path[i]);
+        step();
+    }
+
+    emitFrame(holdDelay);
+
+    while (!pending.empty())
+        writeOldest();
+    if (gif && !gif->finish())
+        throw std::runtime_error("Cannot write " + output);
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return stats;
+}
@@ -0,0 +1,57 @@
+/**
+* @file frameExport.hpp
+* @author Ondrej
+* @brief Headless rendering of the visualisation into PNG sequence or animated GIF
+*
+* Frames are rendered on CPU (no window or OpenGL context is needed), so export runs on machines without display.
+* Frames are encoded in parallel on a thread pool.
+**/
+
+#pragma once
+
+#include "colorScheme.hpp"
+#include "graph.hpp"
+
+#include <string>
+
+
+enum class ExportFormat
+{
+    /** Directory with frame_000000.png, frame_000001.png, ... */
+    Png,
+    /** One animated GIF file */
+    Gif
+};
+
+struct ExportOptions
+{
+    ExportFormat format = ExportFormat::Gif;
+    /** Steps of the visualisation between two frames */
+    size_t stride = 1;
+    /** Pixels per cell, 0 - chosen so the map fits into maxSize */
+    size_t cellPixels = 0;
+    /** Largest width/height of the image when cellPixels is 0, larger maps are downsampled */
+    size_t maxSize = 800;
+    /** Encoder threads, 0 - one per hardware thread */
+    size_t threads = 0;
+    /** GIF frame delay in hundredths of second */
+    unsigned delay = 4;
+    /** Index into defaultColorSchemes */
+    size_t style = 0;
+};
+
+struct ExportStats
+{
+    size_t frames = 0;
+    size_t bytes = 0;
+    size_t width = 0;
+    size_t height = 0;
+    double seconds = 0.0;
+};
+
+/**
+* @brief Runs the search of the graph and writes its steps as frames, steps are displayed the same way as in the window
+* - One frame every stride steps, the first frame is the empty map, the last one (the whole path) is held longer
+* - Throws std::invalid_argument for wrong options and std::runtime_error if output cannot be written
+**/
+ExportStats exportSearch(Graph &graph, const ExportOptions &options, const std::string &output);
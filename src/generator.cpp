@@ -0,0 +1,135 @@
+/**
+* @file generator.cpp
+* @author Ondrej
+* @brief Command line tool that generates synthetic maps for stress and scaling tests
+*/
+
+#include "conversion.hpp"
+#include "mapGenerator.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/** Prints usage */
+static void usage(void)
+{
+    std::cerr << "Usage: ./generator <maze|random|rooms|terrain> <rows> <cols> [seed] [options]" << std::endl;
+    std::cerr << "  --width <n>     corridor width of maze (default 1)" << std::endl;
+    std::cerr << "  --density <n>   obstacle density of random map in percent (default 10)" << std::endl;
+    std::cerr << "  --room <n>      distance between room walls (default 8)" << std::endl;
+    std::cerr << "  --binary        write binary format instead of text" << std::endl;
+    std::cerr << "  --output <file> write to file instead of standard output" << std::endl;
+}
+
+/** Converts argument to 32bit number */
+static bool strToU32(const std::string &str, uint32_t &value)
+{
+    size_t parsed;
+    if (!strToNum(str, parsed) || parsed > UINT32_MAX)
+        return false;
+
+    value = static_cast<uint32_t>(parsed);
+    return true;
+}
+
+/**
+* @brief Generates map and streams it into file or standard output
+* - Argument 1: Map family (maze/random/rooms/terrain)
+* - Argument 2, 3: Number of rows and columns (up to 100000)
+* - Argument 4: (Optional) Seed, same seed always produces the same map
+*/
+int main(int argc, char **argv)
+{
+    GeneratorOptions options;
+    bool binary = false;
+    std::string outputPath;
+
+    std::vector<std::string> arguments;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (argument == "--binary")
+            binary = true;
+        else if (argument == "--width" && hasValue)
+        {
+            if (!strToU32(argv[++i], options.corridorWidth))
+                return EXIT_FAILURE;
+        }
+        else if (argument == "--density" && hasValue)
+        {
+            if (!strToU32(argv[++i], options.density))
+                return EXIT_FAILURE;
+        }
+        else if (argument == "--room" && hasValue)
+        {
+            if (!strToU32(argv[++i], options.roomSize))
+                return EXIT_FAILURE;
+        }
+        else if (argument == "--output" && hasValue)
+            outputPath = argv[++i];
+        else if (argument.rfind("--", 0) == 0)
+        {
+            usage();
+            return EXIT_FAILURE;
+        }
+        else
+            arguments.push_back(argument);
+    }
+
+    if (arguments.size() < 3 || arguments.size() > 4)
+    {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    size_t seed = 0;
+    if (!strToMapFamily(arguments[0], options.family) || !strToU32(arguments[1], options.rows) ||
+        !strToU32(arguments[2], options.cols) || (arguments.size() == 4 && !strToNum(arguments[3], seed)))
+    {
+        usage();
+        return EXIT_FAILURE;
+    }
+    options.seed = seed;
+
+    /* Large buffer, output of huge maps is gigabytes */
+    std::vector<char> buffer(1 << 20);
+    std::unique_ptr<std::ofstream> file;
+    std::ostream *output = &std::cout;
+    if (!outputPath.empty())
+    {
+        file = std::make_unique<std::ofstream>();
+        file->rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+        file->open(outputPath, std::ios::binary);
+        if (!*file)
+        {
+            std::cerr << "Cannot open " << outputPath << std::endl;
+            return EXIT_FAILURE;
+        }
+        output = file.get();
+    }
+    else
+        std::ios::sync_with_stdio(false);
+
+    std::unique_ptr<MapWriter> writer;
+    if (binary)
+        writer = std::make_unique<BinaryMapWriter>(*output);
+    else
+        writer = std::make_unique<TextMapWriter>(*output);
+
+    try
+    {
+        generateMap(options, *writer);
+    }
+    catch (const std::invalid_argument &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return *output ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -5,65 +5,92 @@
 **/
 
 #include "graph.hpp"
+#include "gridMap.hpp"
+#include "profiler.hpp"
+#include "searchKernel.hpp"
+#include "subgoalGraph.hpp"
 
 #include <algorithm>
 #include <chrono>
+#include <deque>
 #include <iostream>
 #include <queue>
 #include <random>
 #include <sstream>
 #include <stack>
 
-/** Parses input file and creates graph, throws exception if maze file not found */
-Graph::Graph(SearchAlgorithmType algoType, const std::string filePath)
+/** BFS and A* (with consistent heuristic) always find the shortest path */
+bool isOptimalAlgorithm(SearchAlgorithmType algoType)
 {
-    m_algoType = algoType;
-    std::ifstream inputFile(filePath);
+    switch (algoType)
+    {
+        case SearchAlgorithmType::BFS:
+        case SearchAlgorithmType::AStar:
+            return true;
+        default:
+            return false;
+    }
+}
 
-    /* Checks for file validiy */
-    if (!inputFile)
-        throw std::invalid_argument("Maze file not found");
+bool isBoundedAlgorithm(SearchAlgorithmType algoType)
+{
+    return algoType == SearchAlgorithmType::WeightedAStar || algoType == SearchAlgorithmType::FocalSearch;
+}
 
+/** Loads the map, throws exception if maze file not found */
+Graph::Graph(SearchAlgorithmType algoType, const std::string filePath, bool useArena, bool allocationStats)
+    : Graph(GridMap::load(filePath), algoType, useArena, allocationStats)
+{
+}
 
-    /* Parses the txt file to create the graph   */
-    /* 0 - Wall, 1 - Empty, 2 - Tree */
-    std::string line;
-    std::istringstream parseLine(line);
-    while (std::getline(inputFile, line))
-    {
-        /* Break when end of maze */
-        if (line[0] == 's')
-            break;
+Graph::Graph(std::shared_ptr<const GridMap> map, SearchAlgorithmType algoType, bool useArena, bool allocationStats)
+    : m_startPos(map->start()),
+      m_endPos(map->end()),
+      m_algoType(algoType),
+      m_map(std::move(map)),
+      m_memory(useArena, allocationStats),
+      m_workspace(std::make_unique<SearchWorkspace>(m_memory.resource())),
+      m_visitedInOrder(m_memory.resource()),
+      m_opened(m_memory.resource()),
+      m_path(m_memory.resource())
+{
+}
 
-        std::vector<int> graph_row;
-        for (char x: line)
-        {
-            if (std::tolower(x) == 'x')
-                graph_row.push_back(0);
-            else if (std::tolower(x) == ' ')
-                graph_row.push_back(1);
-            else
-                graph_row.push_back(2);
-        }
-        m_graph.push_back(graph_row);
-    }
+/** Shares the map of mapOwner, search containers are new */
+Graph::Graph(const Graph &mapOwner, SearchAlgorithmType algoType, bool useArena, bool allocationStats)
+    : Graph(mapOwner.m_map, algoType, useArena, allocationStats)
+{
+    m_startPos = mapOwner.m_startPos;
+    m_endPos = mapOwner.m_endPos;
+    m_suboptimality = mapOwner.m_suboptimality;
+    m_subgoals = mapOwner.m_subgoals;
+}
 
-    /* Save start end end positions */
+/** Defined here, SearchWorkspace is incomplete in the header */
+Graph::~Graph() = default;
 
-    std::string dummy;
-    parseLine = std::istringstream(line);
+const MapGrid &Graph::grid(void) const
+{
+    return m_map->grid();
+}
+
+const SearchGrid &Graph::searchGrid(void) const
+{
+    return m_map->searchGrid();
+}
 
-    parseLine >> dummy >> m_startPos.first >> dummy >> m_startPos.second;
-    std::getline(inputFile, line);
-    parseLine = std::istringstream(line);
-    parseLine >> dummy >> m_endPos.first >> dummy >> m_endPos.second;
+uint64_t Graph::mapHash(void) const
+{
+    return m_map->hash();
 }
 
 /** Finds all adjacent vertices/positions */
-std::vector<Position> Graph::Adjacent(Position v)
+std::pmr::vector<Position> Graph::Adjacent(Position v)
 {
-    std::vector<Position> positions;
+    std::pmr::vector<Position> positions(m_memory.resource());
+    positions.reserve(4);
 
+    const MapGrid &grid = m_map->grid();
     int x, y;
 
     /* Left */
@@ -72,16 +99,16 @@ std::vector<Position> Graph::Adjacent(Position v)
     if (x >= 0)
     {
         //std::cout << x << " " << y << std::endl;
-        if (m_graph[y][x] == true)
+        if (grid[y][x] == true)
             positions.push_back(Position(x, y));
     }
 
     /* Right */
     x = v.first + 1;
     y = v.second;
-    if (x < (int) m_graph[v.second].size())
+    if (x < (int) grid[v.second].size())
     {
-        if (m_graph[y][x] == true)
+        if (grid[y][x] == true)
             positions.push_back(Position(x, y));
     }
 
@@ -90,47 +117,42 @@ std::vector<Position> Graph::Adjacent(Position v)
     y = v.second - 1;
     if (y >= 0)
     {
-        if (m_graph[y][x] == true)
+        if (grid[y][x] == true)
             positions.push_back(Position(x, y));
     }
 
     /* Down */
     x = v.first;
     y = v.second + 1;
-    if (y < (int) m_graph.size())
+    if (y < (int) grid.size())
     {
-        if (m_graph[y][x] == true)
+        if (grid[y][x] == true)
             positions.push_back(Position(x, y));
     }
 
-    for (auto x: positions)
-    {
-        if (x.first < 0 || x.second < 0 || x.first > 511 || x.second > 511)
-            std::cout << x.first << " " << x.second << std::endl;
-    }
     return positions;
 }
 
 /** Implementation of DFS algorithm, saves the visited and opened vertices as well as path */
 void Graph::BFS(void)
 {
-    std::map<Position, bool> visited;
-    std::map<Position, Position> predecessor;
-    std::queue<Position> queue;
+    std::pmr::map<Position, bool> visited(m_memory.resource());
+    std::pmr::map<Position, Position> predecessor(m_memory.resource());
+    std::queue<Position, std::pmr::deque<Position>> queue(m_memory.resource());
 
     queue.push(m_startPos);
 
     Position v;
 
     /* Optional */
-    m_visitedInOrder.push_back(m_startPos);
+    this->recordVisit(m_startPos);
     visited[m_startPos] = true;
     predecessor[m_startPos] = Position(-1, -1);
 
     /* Stops the loop when end position is found */
     bool breakFlag = false;
 
-    while (!queue.empty() && !breakFlag)
+    while (!queue.empty() && !breakFlag && !this->searchCancelled())
     {
         v = queue.front();
         queue.pop();
@@ -141,14 +163,14 @@ void Graph::BFS(void)
             {
                 visited[w] = true;
                 queue.push(w);
-                m_visitedInOrder.push_back(w);
+                this->recordVisit(w);
                 predecessor[w] = v;
                 if (w == m_endPos)
                 {
                     breakFlag = true;
                     break;
                 }
-                m_opened[v].push_back(w);
+                this->recordOpen(v, w);
             }
         }
     }
@@ -161,7 +183,6 @@ void Graph::BFS(void)
     /* Reconstruct path */
     Position pos = m_endPos;
 
-    std::vector<Position> reversePath;
     m_path.push_back(pos);
     while (predecessor[pos] != Position(-1, -1))
     {
@@ -176,29 +197,30 @@ void Graph::BFS(void)
 /** Implementation of DFS algorithm, saves the visited and opened vertices as well as path */
 void Graph::DFS(void)
 {
-    std::map<Position, bool> visited;
-    std::map<Position, Position> predecessor;
-    std::stack<Position> stack;
+    std::pmr::map<Position, bool> visited(m_memory.resource());
+    std::pmr::map<Position, Position> predecessor(m_memory.resource());
+    std::stack<Position, std::pmr::deque<Position>> stack(m_memory.resource());
 
     stack.push(m_startPos);
 
     Position v;
 
-    /* Optional */
-    m_visitedInOrder.push_back(m_startPos);
-    visited[m_startPos] = true;
     predecessor[m_startPos] = Position(-1, -1);
 
     /* Stops the loop when end position is found */
     bool breakFlag = false;
 
-    while (!stack.empty() && !breakFlag)
+    while (!stack.empty() && !breakFlag && !this->searchCancelled())
     {
         v = stack.top();
         stack.pop();
 
+        /* Position can be on the stack more times (start included), it is visited only once */
+        if (visited.find(v) != visited.end())
+            continue;
+
         visited[v] = true;
-        m_visitedInOrder.push_back(v);
+        this->recordVisit(v);
 
         for (Position w: Adjacent(v))
         {
@@ -208,11 +230,12 @@ void Graph::DFS(void)
                 predecessor[w] = v;
                 if (w == m_endPos)
                 {
+                    this->recordVisit(w);
                     breakFlag = true;
                     break;
                 }
 
-                m_opened[v].push_back(w);
+                this->recordOpen(v, w);
             }
         }
     }
@@ -225,7 +248,6 @@ void Graph::DFS(void)
     /* Reconstruct path */
     Position pos = m_endPos;
 
-    std::vector<Position> reversePath;
     m_path.push_back(pos);
     while (predecessor[pos] != Position(-1, -1))
     {
@@ -248,8 +270,8 @@ struct PriorityQueueComparatorInt
 /** Generates random number in range 1, 10000*/
 int randomNum(void)
 {
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    /* Seeded once, creating random_device and seeding the generator on every call dominated the search */
+    static std::mt19937 gen(std::random_device{}());
 
     int min = 1;
     int max = 10000;
@@ -262,24 +284,23 @@ int randomNum(void)
 /** Implementation of random search algorithm, saves the visited and opened vertices as well as path */
 void Graph::RandomSearch(void)
 {
-    std::map<Position, bool> visited;
-    std::map<Position, Position> predecessor;
-    std::priority_queue<std::pair<Position, int>, std::vector<std::pair<Position, int>>, PriorityQueueComparatorInt> queue;
+    std::pmr::map<Position, bool> visited(m_memory.resource());
+    std::pmr::map<Position, Position> predecessor(m_memory.resource());
+    std::priority_queue<std::pair<Position, int>, std::pmr::vector<std::pair<Position, int>>, PriorityQueueComparatorInt> queue(m_memory.resource());
 
     queue.push({m_startPos, randomNum()});
 
     Position v;
-    std::cout << "test" << std::endl;
 
     /* Optional */
-    m_visitedInOrder.push_back(m_startPos);
+    this->recordVisit(m_startPos);
     visited[m_startPos] = true;
     predecessor[m_startPos] = Position(-1, -1);
 
     /* Stops the loop when end position is found */
     bool breakFlag = false;
 
-    while (!queue.empty() && !breakFlag)
+    while (!queue.empty() && !breakFlag && !this->searchCancelled())
     {
         v = queue.top().first;
         queue.pop();
@@ -289,7 +310,7 @@ void Graph::RandomSearch(void)
             {
                 visited[w] = true;
                 queue.push({w, randomNum()});
-                m_visitedInOrder.push_back(w);
+                this->recordVisit(w);
                 predecessor[w] = v;
                 if (w == m_endPos)
                 {
@@ -297,7 +318,7 @@ void Graph::RandomSearch(void)
                     break;
                 }
 
-                m_opened[v].push_back(w);
+                this->recordOpen(v, w);
             }
         }
     }
@@ -310,7 +331,6 @@ void Graph::RandomSearch(void)
     /* Reconstruct path */
     Position pos = m_endPos;
 
-    std::vector<Position> reversePath;
     m_path.push_back(pos);
     while (predecessor[pos] != Position(-1, -1))
     {
@@ -359,10 +379,10 @@ struct PriorityQueueComparatorTimestamped
 /** Implementation of Greedy algorithm using L2 Norm, saves the visited and opened vertices as well as path */
 void Graph::GreedySearch(void)
 {
-    std::map<Position, bool> visited;
-    std::map<Position, size_t> distance;
-    std::map<Position, Position> predecessor;
-    std::priority_queue<std::pair<Position, TimestampedValue>, std::vector<std::pair<Position, TimestampedValue>>, PriorityQueueComparatorTimestamped> queue;
+    std::pmr::map<Position, bool> visited(m_memory.resource());
+    std::pmr::map<Position, size_t> distance(m_memory.resource());
+    std::pmr::map<Position, Position> predecessor(m_memory.resource());
+    std::priority_queue<std::pair<Position, TimestampedValue>, std::pmr::vector<std::pair<Position, TimestampedValue>>, PriorityQueueComparatorTimestamped> queue(m_memory.resource());
 		size_t time = 0;
 
     queue.push({m_startPos, TimestampedValue(0.0, time++)});
@@ -370,7 +390,7 @@ void Graph::GreedySearch(void)
     Position v;
 
     /* Optional */
-    m_visitedInOrder.push_back(m_startPos);
+    this->recordVisit(m_startPos);
     visited[m_startPos] = true;
     predecessor[m_startPos] = Position(-1, -1);
     distance[m_startPos] = 0;
@@ -378,7 +398,7 @@ void Graph::GreedySearch(void)
     /* Stops the loop when end position is found */
     bool breakFlag = false;
 
-    while (!queue.empty() && !breakFlag)
+    while (!queue.empty() && !breakFlag && !this->searchCancelled())
     {
         v = queue.top().first;
         queue.pop();
@@ -387,7 +407,7 @@ void Graph::GreedySearch(void)
             if (visited.find(w) == visited.end())
             {
                 visited[w] = true;
-                m_visitedInOrder.push_back(w);
+                this->recordVisit(w);
                 predecessor[w] = v;
                 distance[w] = distance[v] + 1;
                 queue.push({w, TimestampedValue(heuristic(w, m_endPos), time++)});
@@ -397,7 +417,7 @@ void Graph::GreedySearch(void)
                     break;
                 }
 
-                m_opened[v].push_back(w);
+                this->recordOpen(v, w);
             }
         }
     }
@@ -410,7 +430,6 @@ void Graph::GreedySearch(void)
     /* Reconstruct path */
     Position pos = m_endPos;
 
-    std::vector<Position> reversePath;
     m_path.push_back(pos);
     while (predecessor[pos] != Position(-1, -1))
     {
@@ -425,31 +444,33 @@ void Graph::GreedySearch(void)
 /** Implementation of A* algorithm using L2 norm, saves the visited and opened vertices as well as path */
 void Graph::AStar(void)
 {
-    std::map<Position, bool> visited;
-    std::map<Position, size_t> gScore;
-    std::map<Position, Position> predecessor;
-    std::priority_queue<std::pair<Position, TimestampedValue>, std::vector<std::pair<Position, TimestampedValue>>, PriorityQueueComparatorTimestamped> queue;
+    std::pmr::map<Position, bool> visited(m_memory.resource());
+    std::pmr::map<Position, size_t> gScore(m_memory.resource());
+    std::pmr::map<Position, Position> predecessor(m_memory.resource());
+    std::priority_queue<std::pair<Position, TimestampedValue>, std::pmr::vector<std::pair<Position, TimestampedValue>>, PriorityQueueComparatorTimestamped> queue(m_memory.resource());
 		size_t time = 0;
 		
 		gScore[m_startPos] = 0;
 
 		queue.push({m_startPos, TimestampedValue(heuristic(m_startPos, m_endPos), time++)});
 		predecessor[m_startPos] = Position(-1, -1);
-		m_visitedInOrder.push_back(m_startPos);
 
-    while (!queue.empty())
+    while (!queue.empty() && !this->searchCancelled())
     {
 			Position v = queue.top().first;
-			double test = queue.top().second.value;
 			queue.pop();
 
+			/* Goal is recorded as the last visited position, same as in the other algorithms */
 			if (v == m_endPos)
+			{
+				this->recordVisit(v);
 				break;
+			}
 			
 			if (visited[v])
 				continue;
 			
-			m_visitedInOrder.push_back(v);
+			this->recordVisit(v);
 			m_opened[v].clear();
 			visited[v] = true;
 			
@@ -464,7 +485,7 @@ void Graph::AStar(void)
 					predecessor[w] = v;
 					gScore[w] = tentativeGScore;
 					queue.push({w, TimestampedValue(tentativeGScore + heuristic(w, m_endPos), time++)});
-					m_opened[v].push_back(w);
+					this->recordOpen(v, w);
 				}
 			}
 		}
@@ -478,7 +499,6 @@ void Graph::AStar(void)
     /* Reconstruct path */
     Position pos = m_endPos;
 
-    std::vector<Position> reversePath;
     m_path.push_back(pos);
     while (predecessor[pos] != Position(-1, -1))
     {
@@ -489,6 +509,20 @@ void Graph::AStar(void)
     std::reverse(m_path.begin(), m_path.end());
 }
 
+/** Tracing policy of the kernels, the visualisation and the listener see every step */
+struct Graph::Trace
+{
+    static constexpr bool enabled = true;
+
+    void visited(Position pos) { graph.recordVisit(pos); }
+
+    void opened(Position from, Position to) { graph.recordOpen(from, to); }
+
+    bool cancelled(void) { return graph.searchCancelled(); }
+
+    Graph &graph;
+};
+
 /** Set up things */
 void Graph::setUp(int state)
 {
@@ -500,30 +534,27 @@ void Graph::setUp(int state)
         m_algoType = static_cast<SearchAlgorithmType>(state);
     }
 
-    switch (m_algoType)
-    {
-        case SearchAlgorithmType::BFS:
-            this->BFS();
-            break;
-        case SearchAlgorithmType::DFS:
-            this->DFS();
-            break;
-        case SearchAlgorithmType::RandomSearch:
-            this->RandomSearch();
-            break;
-        case SearchAlgorithmType::GreedySearch:
-            this->GreedySearch();
-            break;
-        case SearchAlgorithmType::AStar:
-            this->AStar();
-            break;
-    }
+    /* Zone names have to be literals */
+    [[maybe_unused]] static const char *const zones[searchAlgorithmCount] = {"search bfs", "search dfs", "search random", "search greedy", "search astar",
+                                                                                 "search weighted astar", "search focal"};
+    PROFILE_ZONE(zones[static_cast<int>(m_algoType)]);
+
+    m_memory.beginSearch();
+
+    /* Workspace and path are in the search memory too, so the accounting and the arena cover the whole search */
+    Trace trace{*this};
+    if (m_subgoals)
+        runSubgoalAlgorithm(m_algoType, *m_map, *m_workspace, trace, m_startPos, m_endPos, &m_path, m_suboptimality);
+    else
+        runAlgorithm(m_algoType, m_map->searchGrid(), *m_workspace, trace, m_startPos, m_endPos, &m_path, m_suboptimality);
+
+    m_searchAllocations = m_memory.endSearch();
 }
 
 /** Displays graph in STDOUT */
 void Graph::showGraphASCII()
 {
-    for (auto row: m_graph)
+    for (const auto &row: m_map->grid())
     {
         for (auto x: row)
         {
@@ -541,9 +572,14 @@ void Graph::showGraphASCII()
 /** Clears containers used to store graph paths etc. */
 void Graph::reset(void)
 {
-    m_visitedInOrder.clear();
-    m_opened.clear();
-    m_path.clear();
+    /* Not just clear(), vectors would keep their capacity in the arena that is about to be released */
+    m_visitedInOrder = std::pmr::vector<Position>(m_memory.resource());
+    m_opened = std::pmr::map<Position, std::pmr::vector<Position>>(m_memory.resource());
+    m_path = std::pmr::vector<Position>(m_memory.resource());
+    if (m_memory.usesArena())
+        m_workspace->release();
+
+    m_memory.release();
 }
 
 /** Displays path length and how many vertices were opened/visited */
@@ -551,4 +587,10 @@ void Graph::pathInfo(void)
 {
     std::cout << "Opened vertices: " << m_visitedInOrder.size() << std::endl;
     std::cout << "Path length: " << m_path.size() << std::endl;
+
+    if (m_memory.accounting())
+    {
+        std::cout << "Search allocations: " << m_searchAllocations << std::endl;
+        std::cout << "System allocations: " << m_memory.lastUpstream() << (m_memory.usesArena() ? " (arena)" : "") << std::endl;
+    }
 }
@@ -6,8 +6,13 @@
 
 #pragma once
 
+#include "allocationStats.hpp"
+
+#include <cstdint>
 #include <fstream>
 #include <map>
+#include <memory>
+#include <memory_resource>
 #include <string>
 #include <utility>
 #include <vector>
@@ -19,19 +24,76 @@ enum class SearchAlgorithmType
     DFS,
     RandomSearch,
     GreedySearch,
-    AStar
+    AStar,
+    /** A* with the heuristic multiplied by 1 + suboptimality */
+    WeightedAStar,
+    /** A*_epsilon, expands the cell nearest to the goal among cells with f within 1 + suboptimality of the lowest f */
+    FocalSearch
 };
 
+/** Number of algorithms in SearchAlgorithmType */
+const int searchAlgorithmCount = 7;
+
+/** Optimal algorithms always find the shortest path, so they have to agree on its length */
+bool isOptimalAlgorithm(SearchAlgorithmType algoType);
+
+/** Bounded suboptimal algorithms find paths at most (1 + suboptimality) times as long as the shortest one */
+bool isBoundedAlgorithm(SearchAlgorithmType algoType);
+
+/** Suboptimality of weighted A* and focal search unless it is set (--epsilon) */
+const double defaultSuboptimality = 0.5;
+
 /** Represents position in graph */
 using Position = std::pair<int, int>;
 
+/** Cells of the map by rows, 0 - Wall, 1 - Empty, 2 - Tree */
+using MapGrid = std::vector<std::vector<uint8_t>>;
+
 class GraphVisualisation;
+class GridMap;
+class RowMajorLayout;
+template <typename Layout>
+class BasicSearchGrid;
+using SearchGrid = BasicSearchGrid<RowMajorLayout>;
+class SearchWorkspace;
+
+/** Receives steps of a running search, used to stream the search into another thread */
+class SearchListener
+{
+public:
+    virtual ~SearchListener() = default;
+
+    /** Position was appended to visited positions */
+    virtual void visited(Position pos) = 0;
+
+    /** Position "from" opened position "to" */
+    virtual void opened(Position from, Position to) = 0;
 
+    /** Search stops as soon as this returns true */
+    virtual bool cancelled(void) = 0;
+};
+
+/**
+* @brief Traced search session over a shared GridMap, records every step for the visualisation and listeners
+* - Untraced searches (server, benchmarks) use the lighter SearchSession
+**/
 class Graph
 {
 public:
-    /** Constructor */
-    Graph(SearchAlgorithmType algoType, const std::string filePath);
+    /** Constructor, loads the map, optionally places search containers into arena and counts their allocations */
+    Graph(SearchAlgorithmType algoType, const std::string filePath, bool useArena = false, bool allocationStats = false);
+
+    /** Constructor for search over already loaded map, start and end are taken from the map */
+    Graph(std::shared_ptr<const GridMap> map, SearchAlgorithmType algoType, bool useArena = false, bool allocationStats = false);
+
+    /** Constructor for another search over the map, start and end of mapOwner, the map is shared, not copied */
+    Graph(const Graph &mapOwner, SearchAlgorithmType algoType, bool useArena = false, bool allocationStats = false);
+
+    ~Graph();
+
+    /** Search containers are bound to this graph's memory resource, so graph cannot be copied */
+    Graph(const Graph &) = delete;
+    Graph &operator=(const Graph &) = delete;
 
     /** Shows graph in ascii */
     void showGraphASCII(void);
@@ -43,7 +105,10 @@ public:
     void reset(void);
 
     /** Finds all adjacent position where can you move in the graph */
-    std::vector<Position> Adjacent(Position v);
+    std::pmr::vector<Position> Adjacent(Position v);
+
+    /* The members below are the original implementations, setUp runs the same algorithms as searchKernel
+       instantiations, they are kept as the reference the kernels are tested and benchmarked against */
 
     /** Implementation of BFS algorithm */
     void BFS(void);
@@ -60,31 +125,113 @@ public:
     /** Implementation of AStar algorithm */
     void AStar(void);
 
-    /** Sets up things */
+    /** Runs the search (state is SearchAlgorithmType, -1 keeps the current one) as the tracing kernel instantiation */
     void setUp(int state);
 
+    /** Map the graph searches, shared by all graphs and sessions created from it */
+    const std::shared_ptr<const GridMap> &map(void) const { return m_map; }
+
+    /** Grid of the graph, 0 - Wall, 1 - Empty, 2 - Tree */
+    const MapGrid &grid(void) const;
+
+    /** Flat passability of the map for the search kernels */
+    const SearchGrid &searchGrid(void) const;
+
+    /** Hash of the size and cells of the map, same maps have same hash whatever file they were loaded from */
+    uint64_t mapHash(void) const;
+
+    Position startPos(void) const { return m_startPos; }
+
+    Position endPos(void) const { return m_endPos; }
+
+    SearchAlgorithmType algoType(void) const { return m_algoType; }
+
+    /** Start and end used by the following searches, positions are not checked */
+    void setEndpoints(Position start, Position end)
+    {
+        m_startPos = start;
+        m_endPos = end;
+    }
+
+    /** Algorithm used by setUp(-1) */
+    void setAlgoType(SearchAlgorithmType algoType) { m_algoType = algoType; }
+
+    /** Bound of weighted A* and focal search used by the following searches, must not be negative */
+    void setSuboptimality(double suboptimality) { m_suboptimality = suboptimality; }
+
+    double suboptimality(void) const { return m_suboptimality; }
+
+    /** BFS and A* of the following searches run over the subgoal graph of the map (subgoalGraph.hpp), only subgoals are
+        visited and the path is filled in */
+    void setSubgoals(bool subgoals) { m_subgoals = subgoals; }
+
+    bool subgoals(void) const { return m_subgoals; }
+
+    /** Listener is notified about every step of the following searches, nullptr removes it */
+    void setListener(SearchListener *listener) { m_listener = listener; }
+
+    /** Positions in the order the last search visited them, ends with end position if path was found */
+    const std::pmr::vector<Position> &visitedInOrder(void) const { return m_visitedInOrder; }
+
+    /** Path found by the last search, from start to end, empty if there is no path */
+    const std::pmr::vector<Position> &path(void) const { return m_path; }
+
+    /** What the last search allocated, counted only with allocation stats */
+    const AllocationStats &searchAllocations(void) const { return m_searchAllocations; }
+
     /** Class used for visualisation */
     friend class GraphVisualisation;
 
 private:
+    /** Tracing policy of the kernels, forwards to the methods below */
+    struct Trace;
+
+    /** Records visited position and notifies listener */
+    void recordVisit(Position pos)
+    {
+        m_visitedInOrder.push_back(pos);
+        if (m_listener)
+            m_listener->visited(pos);
+    }
+
+    /** Records opened position and notifies listener */
+    void recordOpen(Position from, Position to)
+    {
+        m_opened[from].push_back(to);
+        if (m_listener)
+            m_listener->opened(from, to);
+    }
+
+    /** True if listener wants the search to stop */
+    bool searchCancelled(void) { return m_listener && m_listener->cancelled(); }
+
     Position m_startPos;
     Position m_endPos;
     SearchAlgorithmType m_algoType;
+    double m_suboptimality = defaultSuboptimality;
+    bool m_subgoals = false;
+
+    /** Never changed after loading, graphs created from another graph share it */
+    std::shared_ptr<const GridMap> m_map;
 
-    /** Using this to distinguish between wall, clear path and tree*/
-    /** 0 - Wall, 1 - Empty, 2 - Tree */
-    std::vector<std::vector<int>> m_graph;
+    /** Memory used by everything below and by containers inside the algorithms */
+    SearchMemory m_memory;
 
-    /** Representing the graph twice using Adjacency Matrix */
-    std::map<Position, std::vector<Position>> m_adjList;
+    /** Arrays of the kernel, reused by the searches of this graph (until reset while the arena is used) */
+    std::unique_ptr<SearchWorkspace> m_workspace;
+
+    /** What the last search allocated (only in allocation accounting mode) */
+    AllocationStats m_searchAllocations;
 
     /** For each step stores Position */
-    std::vector<Position> m_visitedInOrder;
+    std::pmr::vector<Position> m_visitedInOrder;
 
     /** For each Position stores positions which the current position opened */
-    std::map<Position, std::vector<Position>> m_opened;
+    std::pmr::map<Position, std::pmr::vector<Position>> m_opened;
 
     /** Stores path that the algorithm found */
-    std::vector<Position> m_path;
+    std::pmr::vector<Position> m_path;
+
+    SearchListener *m_listener = nullptr;
 		
 };
@@ -5,34 +5,54 @@
 *
 */
 
+#include "conversion.hpp"
 #include "graph.hpp"
 #include "graphVisualisation.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
 #include <iostream>
+#include <sstream>
+
+/** Zoom step of one mouse wheel notch */
+const float zoomStep = 1.2f;
+
+/** Part of the view moved by one arrow key press */
+const float panStep = 0.1f;
 
-/* Decided not to use this for now */
-#define OUTLINE_MULTIPLIER 7
-#define speedMultiplier 100
+/** Suboptimality bound in the window title, without trailing zeros */
+static std::string epsilonText(double suboptimality)
+{
+    std::ostringstream text;
+    text << suboptimality;
+    return text.str();
+}
 
 /** Sets the fps and color schemes */
 void GraphVisualisation::init(void)
 {
-    /* Setting the frame */
-    m_window.setFramerateLimit(static_cast<int>(0.15 * m_visualisationSpeed * speedMultiplier));
+    /* Fixed refresh rate, speed of the animation is set by the scheduler */
+    m_window.setFramerateLimit(PlaybackScheduler::refreshRate);
 
+    /* Events of finished searches are stored in the cache */
+    m_worker.setRecording(true);
 
-    /* No way in hell this is optional, but considering I am only storing */
-    /* 2 Color schemes for now, I will do this 														*/
-    m_gameData.colorSchemes[1] = (ColorScheme{RGB{18, 171, 226, 255}, RGB{225, 255, 255, 255}, RGB{0, 230, 255, 255}, RGB{0, 153, 76, 25},
-                                              RGB{255, 255, 0, 255}, RGB{255, 255, 255, 255}, RGB{255, 0, 0, 255}});
-    m_gameData.colorSchemes[0] = (ColorScheme{RGB{0, 0, 0, 255}, RGB{126, 126, 126, 255}, RGB{219, 41, 22, 255}, RGB{27, 101, 19, 255},
-                                              RGB{255, 204, 0, 255}, RGB{32, 32, 32, 255}, RGB{0, 0, 255, 255}});
+    /* Schemes are shared with the headless export */
+    m_gameData.colorSchemes = defaultColorSchemes;
+}
+
+/** Pool threads finish as soon as they see the flag, the pool joins them */
+GraphVisualisation::~GraphVisualisation()
+{
+    m_precomputeCancel.store(true);
+    m_precomputePool.reset();
 }
 
 /** Resets the screen*/
 void GraphVisualisation::resetAll(void)
 {
-    m_graph.reset();
-    m_graph.setUp(m_gameData.state);
+    /* Running search is cancelled, the new one streams its steps from the beginning */
+    this->startSearch();
     m_gameData.finished = false;
     this->reset();
 }
@@ -44,13 +64,42 @@ void GraphVisualisation::processInput(sf::Event &event)
     if (event.type == sf::Event::Closed)
         m_window.close();
 
-    /* Display whole window again if screen resized */
+    /* Keep the scale, window only shows more or less of the graph */
     else if (event.type == sf::Event::Resized)
+        m_camera.setSize(event.size.width * m_worldPerPixel, event.size.height * m_worldPerPixel);
+
+    /* Zoom around mouse cursor */
+    else if (event.type == sf::Event::MouseWheelScrolled && event.mouseWheelScroll.wheel == sf::Mouse::VerticalWheel)
     {
-        this->reset();
-        m_gameData.finished = false;
+        float factor = event.mouseWheelScroll.delta > 0 ? 1.0f / zoomStep : zoomStep;
+        this->zoomAt(sf::Vector2i(event.mouseWheelScroll.x, event.mouseWheelScroll.y), factor);
     }
 
+    /* Pan by dragging with left mouse button */
+    else if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left)
+    {
+        m_dragging = true;
+        m_dragLast = sf::Vector2i(event.mouseButton.x, event.mouseButton.y);
+    }
+    else if (event.type == sf::Event::MouseButtonReleased && event.mouseButton.button == sf::Mouse::Left)
+        m_dragging = false;
+    else if (event.type == sf::Event::MouseMoved && m_dragging)
+    {
+        sf::Vector2i mouse(event.mouseMove.x, event.mouseMove.y);
+        this->pan(sf::Vector2f(m_dragLast - mouse) * m_worldPerPixel);
+        m_dragLast = mouse;
+    }
+
+    /* Pan with arrows */
+    else if (event.type == sf::Event::KeyPressed && (event.key.code == sf::Keyboard::Left || event.key.code == sf::Keyboard::Right))
+        this->pan(sf::Vector2f((event.key.code == sf::Keyboard::Left ? -panStep : panStep) * m_camera.getSize().x, 0));
+    else if (event.type == sf::Event::KeyPressed && (event.key.code == sf::Keyboard::Up || event.key.code == sf::Keyboard::Down))
+        this->pan(sf::Vector2f(0, (event.key.code == sf::Keyboard::Up ? -panStep : panStep) * m_camera.getSize().y));
+
+    /* Show whole graph again */
+    else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Home)
+        this->fitCamera();
+
     /* Close window if ESC is pressed */
     else if (sf::Keyboard::isKeyPressed(sf::Keyboard::Escape))
         m_window.close();
@@ -67,39 +116,26 @@ void GraphVisualisation::processInput(sf::Event &event)
 
     /* Change speed (Faster) */
     else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::D)
-    {
-        m_visualisationSpeed = std::min(m_visualisationSpeed * 2, static_cast<size_t>(10000));
-        this->changeSpeed(m_visualisationSpeed);
-    }
+        this->changeSpeed(2.0);
 
     /* Change speed (Slower) */
     else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::A)
-    {
-        m_visualisationSpeed = std::max(m_visualisationSpeed / 2, static_cast<size_t>(1));
-        this->changeSpeed(m_visualisationSpeed);
-    }
+        this->changeSpeed(0.5);
 
-    /* Change batchSize (Higher) */
+    /* Change speed in bigger steps (Faster) */
     else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::E)
-    {
-        m_gameData.batchSize = std::min(m_gameData.batchSize * 2, static_cast<size_t>(10000));
-    }
+        this->changeSpeed(10.0);
 
-    /* Change batchSize (Lower) */
+    /* Change speed in bigger steps (Slower) */
     else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Q)
-    {
-
-        if (m_gameData.batchSize > 1)
-            m_gameData.batchSize = std::max(m_gameData.batchSize / 2, static_cast<size_t>(1));
-        else
-            m_gameData.batchSize = 1;
-    }
+        this->changeSpeed(0.1);
 
-    /* Change ColorScheme */
+    /* Change ColorScheme, only colours change, animation continues */
     else if (event.type == sf::Event::KeyReleased && event.key.code == sf::Keyboard::C)
     {
         m_gameData.visualStyle = (m_gameData.visualStyle + 1) % 2;
-        this->resetAll();
+        m_renderer.setScheme(m_gameData.colorSchemes[m_gameData.visualStyle]);
+        m_builtStyle = m_gameData.visualStyle;
     }
 
     /* Loop */
@@ -113,17 +149,21 @@ void GraphVisualisation::processInput(sf::Event &event)
             m_window.setTitle(m_screenTitle);
     }
 
+    /* Show/hide performance overlay */
+    else if (event.type == sf::Event::KeyReleased && event.key.code == sf::Keyboard::H)
+        m_showHud = !m_showHud;
+
     /* Show just the shortes path*/
     else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F)
     {
         this->resetAll();
-        m_visitedProgress = m_graph.m_visitedInOrder.size() + 1;
+        m_skipVisited = true;
     }
 
     /* Change Algorithm */
     else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::S)
     {
-        m_gameData.state = (m_gameData.state + 1) % 5;
+        m_gameData.state = (m_gameData.state + 1) % searchAlgorithmCount;
         this->resetAll();
         m_gameData.paused = false;
     }
@@ -139,18 +179,22 @@ void GraphVisualisation::processInput(sf::Event &event)
 void GraphVisualisation::windowLoop(void)
 {
     /** If graph cannot be displayed*/
-    m_graph.setUp(-1);
     if (!this->showGraph())
     {
+        m_graph.setUp(-1);
         m_graph.pathInfo();
         return;
     }
 
+    /* Search runs in background, window keeps responding while it is running */
     m_gameData.state = static_cast<int>(m_graph.m_algoType);
+    this->startSearch();
 
     /* Run until window is closed */
     while (m_window.isOpen())
     {
+        PROFILE_ZONE("frame");
+
         /* Check for keyboard events and window closed events */
         sf::Event event;
         while (m_window.pollEvent(event))
@@ -158,15 +202,39 @@ void GraphVisualisation::windowLoop(void)
             this->processInput(event);
         }
 
-        /* Display the visualisation*/
-        if (!m_gameData.paused && !m_gameData.finished && !this->showBatch(m_gameData.batchSize, 0))
+        /* Steps that are due in this frame, displayed as the search produces them, path after the search finished */
+        m_frameBatch = 0;
+        m_frameShown = 0;
+        if (!m_gameData.paused && !m_gameData.finished)
         {
-            if (!this->showBatch(m_gameData.batchSize, 1))
+            size_t steps = m_scheduler.stepsForFrame();
+            sf::Clock stepClock;
+            m_frameBatch = steps;
+
+            if (!m_searchDone)
             {
-                m_graph.pathInfo();
-                m_gameData.finished = true;
+                m_frameShown = this->showBatch(m_skipVisited ? SIZE_MAX : steps, 0);
+                if (!m_skipVisited)
+                    m_scheduler.stepsDone(m_frameShown, stepClock.getElapsedTime().asSeconds());
+            }
+            else
+            {
+                size_t shown = this->showBatch(steps, 1);
+                m_frameShown = shown;
+                m_scheduler.stepsDone(shown, stepClock.getElapsedTime().asSeconds());
+                if (shown < steps)
+                {
+                    this->resultInfo();
+                    this->frameInfo();
+                    m_gameData.finished = true;
+                }
             }
         }
+        else
+            m_scheduler.idle();
+
+        /* Every frame is drawn, framerate limit keeps the refresh rate */
+        m_scheduler.frameDrawn(this->drawFrame());
 
         /* Restart if loop*/
         if (m_gameData.finished && m_gameData.loop)
@@ -174,6 +242,72 @@ void GraphVisualisation::windowLoop(void)
     }
 }
 
+/** Replays cached result of the current algorithm, or starts the search that adds it to the cache */
+void GraphVisualisation::startSearch(void)
+{
+    SearchAlgorithmType algoType = static_cast<SearchAlgorithmType>(m_gameData.state);
+    m_result = nullptr;
+    m_replay = false;
+    m_replayProgress = 0;
+
+    if (isCacheableAlgorithm(algoType))
+        m_result = m_cache.find(searchKey(m_graph, algoType));
+
+    if (m_result)
+    {
+        /* Graph is not searched, it only needs the algorithm for the title */
+        m_worker.cancel();
+        m_graph.setAlgoType(algoType);
+        m_replay = true;
+    }
+    else
+        m_worker.start(m_gameData.state);
+}
+
+/** Every algorithm gets its own graph sharing the read only map, graph is created here so the pool never touches m_graph */
+void GraphVisualisation::precomputeOthers(void)
+{
+    if (m_precomputeStarted)
+        return;
+    m_precomputeStarted = true;
+
+    /* Results of a cache without limits (--no-cache) would be computed only to be thrown away */
+    if (!m_cache.keepsResults())
+        return;
+
+    /* One thread is left for the window and the visualised search */
+    unsigned hardware = std::thread::hardware_concurrency();
+    m_precomputePool = std::make_unique<ThreadPool>(hardware > 2 ? hardware - 1 : 1);
+
+    for (int state = 0; state < searchAlgorithmCount; state++)
+    {
+        SearchAlgorithmType algoType = static_cast<SearchAlgorithmType>(state);
+        SearchKey key = searchKey(m_graph, algoType);
+        if (!isCacheableAlgorithm(algoType) || m_cache.contains(key))
+            continue;
+
+        auto graph = std::make_shared<Graph>(m_graph, algoType);
+        m_precomputePool->submit([this, graph, key]() {
+            std::shared_ptr<const SearchResult> result = computeResult(*graph, m_precomputeCancel);
+            if (result)
+                m_cache.insert(key, std::move(result));
+        });
+    }
+}
+
+/** Search of the graph prints its own statistics, cached result has only steps and path */
+void GraphVisualisation::resultInfo(void)
+{
+    if (!m_replay)
+    {
+        m_graph.pathInfo();
+        return;
+    }
+
+    std::cout << "Opened vertices: " << m_result->visitedCount() << std::endl;
+    std::cout << "Path length: " << m_result->path().size() << " (cached result)" << std::endl;
+}
+
 /** Updates title based on algorithm type */
 void GraphVisualisation::updateTitle(void)
 {
@@ -194,6 +328,12 @@ void GraphVisualisation::updateTitle(void)
         case SearchAlgorithmType::AStar:
             m_screenTitle = "Graph Visualisation - A*";
             break;
+        case SearchAlgorithmType::WeightedAStar:
+            m_screenTitle = "Graph Visualisation - Weighted A* (epsilon " + epsilonText(m_graph.suboptimality()) + ")";
+            break;
+        case SearchAlgorithmType::FocalSearch:
+            m_screenTitle = "Graph Visualisation - Focal search (epsilon " + epsilonText(m_graph.suboptimality()) + ")";
+            break;
     }
 
     if (m_gameData.loop)
@@ -205,298 +345,260 @@ void GraphVisualisation::updateTitle(void)
 /** Resets visualisation - shows the steps of the path finding algorithm from the beginning */
 void GraphVisualisation::reset(void)
 {
-    m_visitedProgress = 0;
+    m_searchDone = false;
+    m_skipVisited = false;
     m_pathProgress = 0;
+    m_expanded = 0;
+    m_frontier = 0;
+    m_frameStats = FrameStats();
     this->updateTitle();
     this->showGraph();
 }
 
 /** Changes visualisation speed */
-void GraphVisualisation::changeSpeed(int speed)
+void GraphVisualisation::changeSpeed(double factor)
 {
-    m_window.setFramerateLimit(speed);
+    m_scheduler.setRate(m_scheduler.rate() * factor);
+    std::cout << "Speed: " << m_scheduler.rate() << " steps per second (at most " << m_scheduler.maxStepsPerFrame() * PlaybackScheduler::refreshRate
+              << " with measured step time)" << std::endl;
 }
 
-/** Draws visualisation in batch, returns true if there is anything left to display, returns false otherwise
-   (All steps of paht displayed 																																					*/
-bool GraphVisualisation::showBatch(size_t batchSize, bool renderType)
+/** Displays steps in batch, returns number of displayed steps, less than batchSize if there is nothing more to display at the moment
+   (All steps of path displayed, search has not produced more steps yet) */
+size_t GraphVisualisation::showBatch(size_t batchSize, bool renderType)
 {
-    bool returnValue = false;
-
+    PROFILE_ZONE("show batch");
+    size_t steps = 0;
 
-    sf::VertexArray tiles(sf::Quads, batchSize * 4 * 4);
-    size_t vertexIndex = 0;
-
-    for (int i = 0; i < batchSize; i++)
+    for (; steps < batchSize; steps++)
     {
         /* Displays visited steps */
-        if (renderType == false)
-            returnValue = this->showVisitedStep(tiles, vertexIndex);
+        if (renderType == false && !this->showVisitedStep())
+            break;
         /* Displays path */
-        else
-            returnValue = this->showPathStep(tiles, vertexIndex);
+        if (renderType == true && !this->showPathStep())
+            break;
     }
 
-    /* If there is anything to display */
-    if (vertexIndex != 0)
-    {
-        m_window.draw(tiles);
-        m_window.display();
-    }
-    return returnValue;
+    return steps;
 }
 
 /** Displays individual step of algorithm */
-bool GraphVisualisation::showVisitedStep(sf::VertexArray &tiles, size_t &vertexIndex)
+bool GraphVisualisation::showVisitedStep(void)
 {
-    /* If every steps has been already visited */
-    if (m_visitedProgress >= m_graph.m_visitedInOrder.size() - 1 || m_graph.m_visitedInOrder.size() == 0)
+    SearchEvent event;
+    if (m_searchDone)
         return false;
 
-    double tileSize = this->tileSize();
-    double outlineSize = this->outlineSize();
-
-    Position x = m_graph.m_visitedInOrder[m_visitedProgress++];
-
-    float X;
-    float Y;
-    float size;
-    sf::Color color(255, 255, 255, 255);
-
-    /* If not start position */
-    if (x != m_graph.m_startPos)
+    /* Cached result is read directly, Done follows its last event */
+    if (m_replay)
     {
-
-        int r = m_gameData.colorSchemes[m_gameData.visualStyle].step.r;
-        int g = m_gameData.colorSchemes[m_gameData.visualStyle].step.g;
-        int b = m_gameData.colorSchemes[m_gameData.visualStyle].step.b;
-
-        X = 15 + x.first * (outlineSize + tileSize);
-        Y = 15 + x.second * (outlineSize + tileSize);
-        size = tileSize + outlineSize;
-        color = sf::Color(r, g, b, 255);
-
-        tiles[vertexIndex++] = (sf::Vertex(sf::Vector2f(X, Y), color));
-        tiles[vertexIndex++] = (sf::Vertex(sf::Vector2f(X + size, Y), color));
-        tiles[vertexIndex++] = (sf::Vertex(sf::Vector2f(X + size, Y + size), color));
-        tiles[vertexIndex++] = (sf::Vertex(sf::Vector2f(X, Y + size), color));
+        if (m_replayProgress < m_result->eventCount())
+            event = m_result->events()[m_replayProgress++];
+        else
+            event = SearchEvent{SearchEvent::Type::Done, 0, 0};
     }
+    else if (!m_worker.poll(event))
+        return false;
+
+    Position x(event.x, event.y);
 
-    /* If position opened any vertices */
-    if (m_graph.m_opened.find(x) != m_graph.m_opened.end())
+    switch (event.type)
     {
-        /* For every vertex that x opened */
-        for (const auto &y: m_graph.m_opened[x])
-        {
-            /* Dont overwrite end pos */
-						if (y == m_graph.m_endPos)
-							continue;
-
-						int r = m_gameData.colorSchemes[m_gameData.visualStyle].opened.r;
-            int g = m_gameData.colorSchemes[m_gameData.visualStyle].opened.g;
-            int b = m_gameData.colorSchemes[m_gameData.visualStyle].opened.b;
-
-            X = 15 + y.first * (outlineSize + tileSize);
-            Y = 15 + y.second * (outlineSize + tileSize);
-            size = tileSize + outlineSize;
-            color = sf::Color(r, g, b, 255);
-
-            tiles[vertexIndex++] = (sf::Vertex(sf::Vector2f(X, Y), color));
-            tiles[vertexIndex++] = (sf::Vertex(sf::Vector2f(X + size, Y), color));
-            tiles[vertexIndex++] = (sf::Vertex(sf::Vector2f(X + size, Y + size), color));
-            tiles[vertexIndex++] = (sf::Vertex(sf::Vector2f(X, Y + size), color));
-        }
+        case SearchEvent::Type::Done:
+            /* Search thread has finished, graph can be read and its result stored */
+            if (!m_replay)
+            {
+                m_worker.join();
+                std::vector<Position> path(m_graph.m_path.begin(), m_graph.m_path.end());
+                m_result = std::make_shared<const SearchResult>(m_worker.takeRecording(), std::move(path));
+                if (isCacheableAlgorithm(m_graph.m_algoType))
+                    m_cache.insert(searchKey(m_graph, m_graph.m_algoType), m_result);
+            }
+            m_searchDone = true;
+            this->precomputeOthers();
+            return false;
+
+        case SearchEvent::Type::Visit:
+            m_expanded++;
+            /* If not start or end position */
+            if (!m_skipVisited && x != m_graph.m_startPos && x != m_graph.m_endPos)
+            {
+                if (m_renderer.cell(x) == CellState::Opened)
+                    m_frontier--;
+                m_renderer.setCell(x, CellState::Step);
+            }
+            break;
+
+        case SearchEvent::Type::Open:
+            /* Dont overwrite start/end pos, positions visited when discovered (BFS) stay visited */
+            if (!m_skipVisited && x != m_graph.m_startPos && x != m_graph.m_endPos && m_renderer.cell(x) != CellState::Step)
+            {
+                if (m_renderer.cell(x) != CellState::Opened)
+                    m_frontier++;
+                m_renderer.setCell(x, CellState::Opened);
+            }
+            break;
     }
 
     return true;
 }
 
 /* Shows individual step of path */
-bool GraphVisualisation::showPathStep(sf::VertexArray &tiles, size_t &vertexIndex)
+bool GraphVisualisation::showPathStep(void)
 {
-    double tileSize = this->tileSize();
-    double outlineSize = this->outlineSize();
-
-    if (m_pathProgress >= m_graph.m_path.size() - 1 || m_graph.m_path.size() == 0)
+    const std::vector<Position> &path = m_result->path();
+    if (path.size() == 0 || m_pathProgress >= path.size() - 1)
         return false;
 
-    float X;
-    float Y;
-    float size;
-    sf::Color color(255, 255, 255, 255);
-
-    Position x = m_graph.m_path[m_pathProgress++];
+    Position x = path[m_pathProgress++];
 
     /* If not start position */
     if (x != m_graph.m_startPos)
-    {
-        int r = m_gameData.colorSchemes[m_gameData.visualStyle].path.r;
-        int g = m_gameData.colorSchemes[m_gameData.visualStyle].path.g;
-        int b = m_gameData.colorSchemes[m_gameData.visualStyle].path.b;
-
-        X = 15 + x.first * (outlineSize + tileSize);
-        Y = 15 + x.second * (outlineSize + tileSize);
-        size = tileSize + outlineSize;
-        color = sf::Color(r, g, b, 255);
-
-        tiles[vertexIndex++] = (sf::Vertex(sf::Vector2f(X, Y), color));
-        tiles[vertexIndex++] = (sf::Vertex(sf::Vector2f(X + size, Y), color));
-        tiles[vertexIndex++] = (sf::Vertex(sf::Vector2f(X + size, Y + size), color));
-        tiles[vertexIndex++] = (sf::Vertex(sf::Vector2f(X, Y + size), color));
-    }
+        m_renderer.setCell(x, CellState::Path);
 
     return true;
 }
 
-/** Calculates tile size based on screensize and number of tiles*/
-double GraphVisualisation::tileSize(void)
+/* Displays the whole graph */
+bool GraphVisualisation::showGraph(void)
 {
-    if (m_graph.m_graph.empty())
-        return 0.0;
-
-    size_t rows = m_graph.m_graph.size();
-    size_t cols = m_graph.m_graph[0].size();
+    PROFILE_ZONE("show graph");
+    if (m_graph.grid().empty())
+        return false;
 
-    unsigned screenWidth = sf::VideoMode::getDesktopMode().width;
-    unsigned screenHeight = sf::VideoMode::getDesktopMode().height;
+    const ColorScheme &scheme = m_gameData.colorSchemes[m_gameData.visualStyle];
 
-    //size_t rectCount = cols;i
-    double tileSize;
-    if (screenWidth / cols > screenHeight / rows)
-        tileSize = (1.0 * screenHeight - cols * this->outlineSize() - 150) / rows;
+    /* Cells are prepared only once, afterwards only cells changed by the animation are restored */
+    if (!m_renderer.built())
+    {
+        m_renderer.build(m_graph, scheme);
+        m_builtStyle = m_gameData.visualStyle;
+        this->fitCamera();
+    }
     else
-        tileSize = (1.0 * screenWidth - cols * this->outlineSize() - 150) / cols;
-
-    if (tileSize > 1000)
-        tileSize = 20;
+    {
+        m_renderer.restore();
+        if (m_builtStyle != m_gameData.visualStyle)
+        {
+            m_renderer.setScheme(scheme);
+            m_builtStyle = m_gameData.visualStyle;
+        }
+    }
 
-    return tileSize;
+    return true;
 }
 
-
-/** Calculates the size of outline based on screenSize and tile Size */
-double GraphVisualisation::outlineSize(void)
+/** Sets camera so the whole graph fits into the window with small margin */
+void GraphVisualisation::fitCamera(void)
 {
-    return 0.0;
-
-    if (m_graph.m_graph.empty())
-        return 0.0;
+    const float margin = 15.0f;
 
-    unsigned screenWidth = sf::VideoMode::getDesktopMode().width;
-    unsigned screenHeight = sf::VideoMode::getDesktopMode().height;
+    sf::Vector2f window(m_window.getSize());
+    float rows = static_cast<float>(std::max<size_t>(m_renderer.rows(), 1));
+    float cols = static_cast<float>(std::max<size_t>(m_renderer.cols(), 1));
 
-    size_t rows = m_graph.m_graph.size();
-    size_t cols = m_graph.m_graph[0].size();
+    float pixelsPerCell = std::min((window.x - 2 * margin) / cols, (window.y - 2 * margin) / rows);
+    if (pixelsPerCell <= 0)
+        pixelsPerCell = std::min(window.x / cols, window.y / rows);
 
-    return std::min((std::min(screenWidth, screenHeight) * 1.0 / std::max(rows, cols)) * 1.0 / OUTLINE_MULTIPLIER, 10.0);
+    m_worldPerPixel = 1.0f / pixelsPerCell;
+    m_camera.setSize(window * m_worldPerPixel);
+    m_camera.setCenter(cols / 2, rows / 2);
 }
 
-/* Displays the whole graph */
-bool GraphVisualisation::showGraph(void)
+/** Zooms so the point under the cursor stays at the same place */
+void GraphVisualisation::zoomAt(sf::Vector2i pixel, float factor)
 {
+    /* Between 64 pixels per cell and whole graph in 100 pixels */
+    float maxWorldPerPixel = std::max<float>(std::max(m_renderer.rows(), m_renderer.cols()) / 100.0f, 1.0f);
+    float worldPerPixel = std::clamp(m_worldPerPixel * factor, 1.0f / 64, maxWorldPerPixel);
+    factor = worldPerPixel / m_worldPerPixel;
+
+    sf::Vector2f before = m_window.mapPixelToCoords(pixel, m_camera);
+    m_camera.zoom(factor);
+    m_worldPerPixel = worldPerPixel;
+    sf::Vector2f after = m_window.mapPixelToCoords(pixel, m_camera);
+    m_camera.move(before - after);
+}
 
-    if (m_graph.m_graph.empty())
-        return false;
-
-    size_t rows = m_graph.m_graph.size();
-    size_t cols = m_graph.m_graph[0].size();
-
-    /* If graph doesn't fit the screen, the problem is, that calculation the exact value of graph that would not fit */
-    /* is not that simple, so I put these constants here. Program should not crash if graph cannot be displayed			 */
-    if (rows > 1000 || cols > 1000)
-        return false;
-
-    double tileSize = this->tileSize();
-    double outlineSize = this->outlineSize();
-
-    sf::RectangleShape tile;
-    tile.setSize((sf::Vector2f(tileSize, tileSize)));
-    tile.setOutlineColor(sf::Color(72, 72, 72, 255));
-    tile.setOutlineThickness(outlineSize);
-
-    int r = m_gameData.colorSchemes[m_gameData.visualStyle].background.r;
-    int g = m_gameData.colorSchemes[m_gameData.visualStyle].background.g;
-    int b = m_gameData.colorSchemes[m_gameData.visualStyle].background.b;
-
-    m_window.clear(sf::Color(r, g, b, 255));
-
-    sf::Vector2f tilePosition(15, 15);
+/** Moves camera by offset in world coordinates */
+void GraphVisualisation::pan(sf::Vector2f offset)
+{
+    m_camera.move(offset);
+}
 
-    /* Creates array of vertices */
-    sf::VertexArray tiles(sf::Quads, rows * cols * 4);
-    float X = 15.0f;
-    float Y = 15.0f;
-    size_t vertexIndex = 0;
+/** Draws the graph through the camera */
+double GraphVisualisation::drawFrame(void)
+{
+    const RGB &background = m_gameData.colorSchemes[m_gameData.visualStyle].background;
 
-    /* Iterates through every vertex/position of graph and displays it accordingly */
-    for (auto x: m_graph.m_graph)
+    sf::Clock workClock;
     {
-        for (auto y: x)
-        {
-            sf::Color color;
-            if (y == true)
-            {
-                r = m_gameData.colorSchemes[m_gameData.visualStyle].empty.r;
-                g = m_gameData.colorSchemes[m_gameData.visualStyle].empty.g;
-                b = m_gameData.colorSchemes[m_gameData.visualStyle].empty.b;
-                color = (sf::Color(r, g, b, 255));
-            } 
-            else if (y == false)
-            {
-                r = m_gameData.colorSchemes[m_gameData.visualStyle].wall.r;
-                g = m_gameData.colorSchemes[m_gameData.visualStyle].wall.g;
-                b = m_gameData.colorSchemes[m_gameData.visualStyle].wall.b;
-                color = (sf::Color(r, g, b, 255));
-            } 
-            else
-            {
-                color = (sf::Color(102, 255, 102, 255));
-            }
-
-            /* Creates square */
-
-            tiles[vertexIndex].color = color;
-            tiles[vertexIndex].position = sf::Vector2f(X, Y);
-            vertexIndex++;
-
-            tiles[vertexIndex].color = color;
-            tiles[vertexIndex].position = sf::Vector2f(X + tileSize, Y);
-            vertexIndex++;
-
-            tiles[vertexIndex].position = sf::Vector2f(X + tileSize, Y + tileSize);
-            tiles[vertexIndex].color = color;
-            vertexIndex++;
-
-            tiles[vertexIndex].color = color;
-            tiles[vertexIndex].position = sf::Vector2f(X, Y + tileSize);
-            vertexIndex++;
-
-            X += tileSize + outlineSize;
-        }
-        Y += tileSize + outlineSize;
-        X = 15;
+        PROFILE_ZONE("draw");
+        m_window.clear(sf::Color(background.r, background.g, background.b, 255));
+        m_renderer.draw(m_window, m_camera);
+        m_window.setView(m_window.getDefaultView());
+        if (m_showHud)
+            m_hud.draw(m_window, this->hudSearch(), 1.0 / PlaybackScheduler::refreshRate);
     }
 
-    m_window.draw(tiles);
+    double workSeconds = workClock.getElapsedTime().asSeconds();
+    {
+        PROFILE_ZONE("display");
+        m_window.display();
+    }
 
-    /* Visualising starting position and ending position */
-    r = m_gameData.colorSchemes[m_gameData.visualStyle].startEnd.r;
-    g = m_gameData.colorSchemes[m_gameData.visualStyle].startEnd.g;
-    b = m_gameData.colorSchemes[m_gameData.visualStyle].startEnd.b;
+    /* Frame time is measured between two displays, so it includes waiting for the framerate limit */
+    double frameSeconds = m_frameClock.restart().asSeconds();
+    if (m_frameStats.frames++ > 0)
+    {
+        m_frameStats.totalSeconds += frameSeconds;
+        m_frameStats.maxSeconds = std::max(m_frameStats.maxSeconds, frameSeconds);
+    }
+    m_frameStats.workSeconds += workSeconds;
 
-    tile.setFillColor(sf::Color(r, g, b, 255));
+    RenderStats renderStats = m_renderer.takeStats();
+    m_frameStats.cellsUpdated += renderStats.cellsUpdated;
+    m_frameStats.uploads += renderStats.uploads;
+    m_frameStats.drawCalls += renderStats.drawCalls;
+    m_frameStats.vertices += renderStats.vertices;
 
-    /* Start Pos*/
-    tilePosition = sf::Vector2f(15 + m_graph.m_startPos.first * (outlineSize + tileSize), 15 + m_graph.m_startPos.second * (outlineSize + tileSize));
-    tile.setPosition(tilePosition);
-    m_window.draw(tile);
+    /* Frames are measured also while the overlay is hidden, so it shows whole graph as soon as it is turned on */
+    m_hud.addFrame(HudFrame{frameSeconds, workSeconds, renderStats});
+    return workSeconds;
+}
 
-    /* End Pos*/
-    tilePosition = sf::Vector2f(15 + m_graph.m_endPos.first * (outlineSize + tileSize), 15 + m_graph.m_endPos.second * (outlineSize + tileSize));
-    tile.setPosition(tilePosition);
-    m_window.draw(tile);
+/** Playback and search state shown by the overlay */
+HudSearch GraphVisualisation::hudSearch(void) const
+{
+    HudSearch search;
+    search.algorithm = algoTypeToStr(m_graph.m_algoType);
+    search.shown = m_frameShown;
+    search.batchSize = m_frameBatch;
+    search.maxBatchSize = m_scheduler.maxStepsPerFrame();
+    search.speed = m_scheduler.rate();
+    search.expanded = m_expanded;
+    search.frontier = m_frontier;
+    search.cached = m_replay;
+    search.running = m_worker.running();
+    if (!m_replay)
+        search.searchSeconds = m_worker.searchSeconds();
+    search.paused = m_gameData.paused;
+    return search;
+}
 
-    m_window.display();
+/** Prints frame times of the last animation */
+void GraphVisualisation::frameInfo(void)
+{
+    if (m_frameStats.frames < 2)
+        return;
 
-    return true;
+    size_t measured = m_frameStats.frames - 1;
+    std::cout << "Frames: " << m_frameStats.frames << ", average frame time " << 1000.0 * m_frameStats.totalSeconds / measured
+              << " ms, max " << 1000.0 * m_frameStats.maxSeconds << " ms" << std::endl;
+    std::cout << "Upload and draw: " << 1000.0 * m_frameStats.workSeconds / m_frameStats.frames << " ms per frame, "
+              << m_frameStats.cellsUpdated << " cells in " << m_frameStats.uploads << " buffer updates, "
+              << m_frameStats.drawCalls / m_frameStats.frames << " draw calls and " << m_frameStats.vertices / m_frameStats.frames
+              << " vertices per frame" << std::endl;
 }
@@ -9,33 +9,19 @@
 
 #include <SFML/Graphics.hpp>
 #include <array>
+#include <atomic>
 #include <map>
 #include <vector>
 
 #include "graph.hpp"
+#include "gridRenderer.hpp"
+#include "performanceHud.hpp"
+#include "playbackScheduler.hpp"
+#include "resultCache.hpp"
+#include "searchWorker.hpp"
+#include "threadPool.hpp"
 
 
-struct RGB 
-{
-    int r;
-    int g;
-    int b;
-    /* Alpha - opacity */
-    int a;
-};
-
-/** Color scheme for visualisation */
-struct ColorScheme 
-{
-    RGB wall;
-    RGB empty;
-    RGB step;
-    RGB opened;
-    RGB path;
-    RGB background;
-    RGB startEnd;
-};
-
 /** Handeling input */
 struct InputData 
 {
@@ -43,25 +29,45 @@ struct InputData
     bool paused = false;
     int state;
     bool loop = false;
-    size_t batchSize = 1;
     int visualStyle = 0;
     std::array<ColorScheme, 2> colorSchemes;
 };
 
+/** Frame times of one animation */
+struct FrameStats
+{
+    size_t frames = 0;
+    double totalSeconds = 0.0;
+    double maxSeconds = 0.0;
+    /** Time spent uploading changed cells and drawing, without waiting in display */
+    double workSeconds = 0.0;
+    size_t cellsUpdated = 0;
+    size_t uploads = 0;
+    size_t drawCalls = 0;
+    size_t vertices = 0;
+};
+
 
 class GraphVisualisation
 {
 public:
-    GraphVisualisation(Graph &graph, sf::RenderWindow &window, size_t visualisationSpeed)
+    /** Steps per second for one unit of the visualisation speed argument (50 -> 750 steps per second) */
+    static constexpr double stepsPerSpeedUnit = 15.0;
+
+    GraphVisualisation(Graph &graph, sf::RenderWindow &window, size_t visualisationSpeed, ResultCache &cache)
         : m_graph(graph),
           m_window(window),
-          m_visualisationSpeed(visualisationSpeed),
-          m_visitedProgress(0),
+          m_worker(graph),
+          m_cache(cache),
+          m_scheduler(visualisationSpeed * stepsPerSpeedUnit),
           m_pathProgress(0)
     {
         this->init();
     };
 
+    /** Stops precomputation that has not finished yet */
+    ~GraphVisualisation();
+
     /** Sets the fps and color schemes */
     void init();
 
@@ -77,14 +83,14 @@ public:
     /** Shows visualisation of the graph */
     bool showGraph(void);
 
-    /** Displays individual step of algorithm */
-    bool showVisitedStep(sf::VertexArray &tiles, size_t &vertexIndex);
+    /** Displays next step streamed from the search thread, returns false if there is none at the moment */
+    bool showVisitedStep(void);
 
-    /** How many cells win render, render type is either visited cells (0) or path (1) */
-    bool showBatch(size_t batchSize, bool renderType);
+    /** Displays at most batchSize steps, render type is either visited cells (0) or path (1) */
+    size_t showBatch(size_t batchSize, bool renderType);
 
     /* Show individual step of path */
-    bool showPathStep(sf::VertexArray &tiles, size_t &vertexIndex);
+    bool showPathStep(void);
 
     /** Updates title based on algorithm type */
     void updateTitle(void);
@@ -92,28 +98,111 @@ public:
     /** Resets visualisation - shows the steps of the path finding algorithm from the beginning */
     void reset(void);
 
-    /** Changes visualisation speed */
-    void changeSpeed(int speed);
-
-    /** Calculates the size of individual tile based on screen width and height and number of tiles */
-    double tileSize(void);
+    /** Multiplies visualisation speed (steps per second) */
+    void changeSpeed(double factor);
 
-    /** Calculates the size of outline based on screenSize and tile Size */
-    double outlineSize(void);
+    /** Prints frame times of the last animation */
+    void frameInfo(void);
 
 private:
-    Graph m_graph;
+    /** Replays cached result of the current algorithm, or starts the search that adds it to the cache */
+    void startSearch(void);
 
-    std::string m_screenTitle;
+    /** Searches all other algorithms in background (once), their results go into the cache, so switching is instant */
+    void precomputeOthers(void);
+
+    /** Prints number of visited positions and path length of the shown result */
+    void resultInfo(void);
+
+    /** Sets camera so the whole graph fits into the window */
+    void fitCamera(void);
+
+    /** Zooms so the point under the cursor stays at the same place */
+    void zoomAt(sf::Vector2i pixel, float factor);
+
+    /** Moves camera by offset in world coordinates (1 unit = 1 cell) */
+    void pan(sf::Vector2f offset);
+
+    /** Draws the graph through the camera, returns the seconds of uploading and drawing (without waiting in display) */
+    double drawFrame(void);
 
-    /* Ended up not using this in the Graph class for now */
-    size_t m_visualisationSpeed;
+    /** Playback and search state shown by the overlay */
+    HudSearch hudSearch(void) const;
+
+    /** Owned by the caller, search containers live in its memory resource */
+    Graph &m_graph;
+
+    std::string m_screenTitle;
 
     sf::RenderWindow &m_window;
 
-    size_t m_visitedProgress = 0;
+    /** Search thread and the steps it produces */
+    SearchWorker m_worker;
+
+    /** Finished searches, owned by the caller */
+    ResultCache &m_cache;
+
+    /** Result being shown, set when the search finishes or when it was found in the cache */
+    std::shared_ptr<const SearchResult> m_result;
+
+    /** Steps are read from m_result instead of the search thread */
+    bool m_replay = false;
+
+    size_t m_replayProgress = 0;
+
+    /** Done event was received, path can be read from m_result */
+    bool m_searchDone = false;
+
+    /** Steps of the search are not displayed, only the path (F) */
+    bool m_skipVisited = false;
+
+    /** How many steps are displayed in every frame */
+    PlaybackScheduler m_scheduler;
 
     size_t m_pathProgress = 0;
 
     InputData m_gameData;
+
+    /** Keeps state of all cells and draws them */
+    GridRenderer m_renderer;
+
+    /** Colour scheme the renderer uses */
+    int m_builtStyle = 0;
+
+    /** What part of the graph is visible, world unit is one cell */
+    sf::View m_camera;
+
+    float m_worldPerPixel = 1.0f;
+
+    bool m_dragging = false;
+
+    sf::Vector2i m_dragLast;
+
+    sf::Clock m_frameClock;
+
+    FrameStats m_frameStats;
+
+    /** Frame, rendering and search statistics drawn over the graph (H) */
+    PerformanceHud m_hud;
+
+    bool m_showHud = false;
+
+    /** Steps the scheduler asked for in the last frame and steps that were displayed */
+    size_t m_frameBatch = 0;
+
+    size_t m_frameShown = 0;
+
+    /** Visit events displayed since the reset */
+    size_t m_expanded = 0;
+
+    /** Cells displayed as opened and not visited yet */
+    size_t m_frontier = 0;
+
+    /** Set when the window is closed, running precomputations stop at their next step */
+    std::atomic<bool> m_precomputeCancel{false};
+
+    bool m_precomputeStarted = false;
+
+    /** Created with the first precomputation, destroyed before the cancel flag */
+    std::unique_ptr<ThreadPool> m_precomputePool;
 };
@@ -0,0 +1,147 @@
+/**
+* @file gridMap.cpp
+* @author Ondrej
+* @brief Implementation of GridMap
+**/
+
+#include "gridMap.hpp"
+#include "corridorPruning.hpp"
+#include "mapFormat.hpp"
+#include "profiler.hpp"
+#include "rectangleSymmetry.hpp"
+#include "subgoalGraph.hpp"
+
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+/** FNV-1a over dimensions and cells, rows are separated by their length */
+static uint64_t hashGrid(const MapGrid &grid)
+{
+    uint64_t hash = 14695981039346656037ull;
+    auto add = [&hash](uint64_t value) {
+        hash ^= value;
+        hash *= 1099511628211ull;
+    };
+
+    add(grid.size());
+    for (const auto &row: grid)
+    {
+        add(row.size());
+        for (uint8_t cell: row)
+            add(static_cast<uint64_t>(cell));
+    }
+    return hash;
+}
+
+/** Parses input file, throws exception if maze file not found */
+std::shared_ptr<const GridMap> GridMap::load(const std::string &filePath)
+{
+    PROFILE_ZONE("load map");
+    std::ifstream inputFile(filePath);
+    MapGrid grid;
+    Position start;
+    std::vector<Position> goals;
+
+    /* Checks for file validiy */
+    if (!inputFile)
+        throw std::invalid_argument("Maze file not found");
+
+    /* Binary maps (written by the generator) contain start and goals in the header */
+    if (isBinaryMap(inputFile))
+    {
+        readBinaryMap(inputFile, grid, start, goals);
+        return std::make_shared<const GridMap>(std::move(grid), start, std::move(goals));
+    }
+
+    /* Parses the txt file to create the graph   */
+    /* 0 - Wall, 1 - Empty, 2 - Tree */
+    std::string line;
+    while (std::getline(inputFile, line))
+    {
+        /* Break when end of maze */
+        if (line[0] == 's')
+            break;
+
+        std::vector<uint8_t> row;
+        row.reserve(line.size());
+        for (char x: line)
+        {
+            if (std::tolower(x) == 'x')
+                row.push_back(0);
+            else if (std::tolower(x) == ' ')
+                row.push_back(1);
+            else
+                row.push_back(2);
+        }
+        grid.push_back(std::move(row));
+    }
+
+    /* Save start end end positions, every end line is one goal */
+    std::string dummy;
+    std::istringstream parseLine(line);
+    parseLine >> dummy >> start.first >> dummy >> start.second;
+    while (std::getline(inputFile, line))
+    {
+        if (line.empty() || line[0] != 'e')
+            continue;
+        Position goal;
+        parseLine = std::istringstream(line);
+        parseLine >> dummy >> goal.first >> dummy >> goal.second;
+        goals.push_back(goal);
+    }
+
+    /* Map without end line keeps the default end as before */
+    if (goals.empty())
+        goals.emplace_back();
+
+    return std::make_shared<const GridMap>(std::move(grid), start, std::move(goals));
+}
+
+GridMap::GridMap(MapGrid grid, Position start, std::vector<Position> goals)
+    : m_grid(std::move(grid)),
+      m_searchGrid(m_grid),
+      m_hash(hashGrid(m_grid)),
+      m_start(start),
+      m_goals(std::move(goals))
+{
+}
+
+/** Defined here, decompositions are incomplete in the header */
+GridMap::~GridMap() = default;
+
+const RectangleDecomposition &GridMap::rectangles(void) const
+{
+    std::call_once(m_rectanglesBuilt, [this]() {
+        PROFILE_ZONE("build rectangles");
+        m_rectangles = std::make_unique<const RectangleDecomposition>(m_searchGrid);
+    });
+    return *m_rectangles;
+}
+
+const CorridorDecomposition &GridMap::corridors(void) const
+{
+    std::call_once(m_corridorsBuilt, [this]() {
+        PROFILE_ZONE("build corridors");
+        m_corridors = std::make_unique<const CorridorDecomposition>(m_searchGrid);
+    });
+    return *m_corridors;
+}
+
+const SubgoalGraph &GridMap::subgoals(void) const
+{
+    std::call_once(m_subgoalsBuilt, [this]() {
+        PROFILE_ZONE("build subgoals");
+        m_subgoals = std::make_unique<const SubgoalGraph>(m_searchGrid);
+    });
+    return *m_subgoals;
+}
+
+size_t GridMap::bytes(void) const
+{
+    size_t bytes = m_grid.capacity() * sizeof(MapGrid::value_type) + m_searchGrid.size();
+    for (const auto &row: m_grid)
+        bytes += row.capacity();
+    return bytes;
+}
@@ -0,0 +1,94 @@
+/**
+* @file gridMap.hpp
+* @author Ondrej
+* @brief Parsed map that never changes after loading, shared by pointer between all searches over it
+**/
+
+#pragma once
+
+#include "graph.hpp"
+#include "searchKernel.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class CorridorDecomposition;
+class RectangleDecomposition;
+class SubgoalGraph;
+
+/**
+* @brief Immutable map: cells, their flat copy for the search kernels, content hash and the start and goals of the file
+* - Created once per file, Graph (traced search for visualisation) and SearchSession (untraced search) only keep the pointer
+* - Safe to read from any number of threads
+**/
+class GridMap
+{
+public:
+    /** Loads text or binary map, throws std::invalid_argument if the file cannot be read */
+    static std::shared_ptr<const GridMap> load(const std::string &filePath);
+
+    GridMap(MapGrid grid, Position start, Position end) : GridMap(std::move(grid), start, std::vector<Position>{end}) {};
+
+    /** Goals must not be empty, the first one is the end */
+    GridMap(MapGrid grid, Position start, std::vector<Position> goals);
+
+    ~GridMap();
+
+    GridMap(const GridMap &) = delete;
+    GridMap &operator=(const GridMap &) = delete;
+
+    /** 0 - Wall, 1 - Empty, 2 - Tree */
+    const MapGrid &grid(void) const { return m_grid; }
+
+    const SearchGrid &searchGrid(void) const { return m_searchGrid; }
+
+    /** Hash of the size and cells, same maps have same hash whatever file they were loaded from */
+    uint64_t hash(void) const { return m_hash; }
+
+    /** Start stored in the file */
+    Position start(void) const { return m_start; }
+
+    /** First goal stored in the file, the target of single goal searches */
+    Position end(void) const { return m_goals.front(); }
+
+    /** All goals stored in the file (end lines of the text format), in the order of the file */
+    const std::vector<Position> &goals(void) const { return m_goals; }
+
+    /** Empty rectangles of the free cells, built by the first caller (any thread) and kept with the map */
+    const RectangleDecomposition &rectangles(void) const;
+
+    /** Dead-end trees and corridors of the free cells, built by the first caller (any thread) and kept with the map */
+    const CorridorDecomposition &corridors(void) const;
+
+    /** Subgoals and the edges between them, built by the first caller (any thread) and kept with the map */
+    const SubgoalGraph &subgoals(void) const;
+
+    /** Memory taken by the cells and their flat copy (rectangles, corridors and subgoals report their own) */
+    size_t bytes(void) const;
+
+private:
+    MapGrid m_grid;
+
+    SearchGrid m_searchGrid;
+
+    uint64_t m_hash;
+
+    Position m_start;
+
+    std::vector<Position> m_goals;
+
+    mutable std::once_flag m_rectanglesBuilt;
+
+    mutable std::unique_ptr<const RectangleDecomposition> m_rectangles;
+
+    mutable std::once_flag m_corridorsBuilt;
+
+    mutable std::unique_ptr<const CorridorDecomposition> m_corridors;
+
+    mutable std::once_flag m_subgoalsBuilt;
+
+    mutable std::unique_ptr<const SubgoalGraph> m_subgoals;
+};
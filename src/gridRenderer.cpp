@@ -0,0 +1,589 @@
+/**
+* @file gridRenderer.cpp
+* @author Ondrej
+* @brief Implementation of GridRenderer
+**/
+
+#include "gridRenderer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+/** Converts colour from the colour scheme */
+static sf::Color toColor(const RGB &rgb)
+{
+    return sf::Color(rgb.r, rgb.g, rgb.b, 255);
+}
+
+/** Colour of the state in current scheme */
+sf::Color GridRenderer::stateColor(CellState state) const
+{
+    return toColor(::stateColor(m_scheme, state));
+}
+
+/** State of the cell in the graph before any step of the algorithm */
+CellState GridRenderer::baseState(Position pos) const
+{
+    return m_baseState[pos.second * m_cols + pos.first];
+}
+
+/** Prepares cells of the grid */
+void GridRenderer::build(const Graph &graph, const ColorScheme &scheme, bool overlay)
+{
+    const auto &grid = graph.grid();
+
+    m_scheme = scheme;
+    m_overlay = overlay;
+    m_rows = grid.size();
+    m_cols = grid.empty() ? 0 : grid[0].size();
+    m_start = graph.startPos();
+    m_end = graph.endPos();
+
+    m_baseState.assign(m_rows * m_cols, CellState::Wall);
+    for (size_t y = 0; y < m_rows; y++)
+    {
+        for (size_t x = 0; x < m_cols && x < grid[y].size(); x++)
+        {
+            if (grid[y][x] == 1)
+                m_baseState[y * m_cols + x] = CellState::Empty;
+            else if (grid[y][x] != 0)
+                m_baseState[y * m_cols + x] = CellState::Tree;
+        }
+    }
+    for (Position pos: {m_start, m_end})
+    {
+        if (pos.first >= 0 && pos.second >= 0 && pos.first < (int) m_cols && pos.second < (int) m_rows)
+            m_baseState[pos.second * m_cols + pos.first] = CellState::StartEnd;
+    }
+
+    m_state = m_baseState;
+    m_dirtyCells.clear();
+    m_touchedCells.clear();
+    m_vertices.clear();
+    m_useVertexBuffer = false;
+    m_lod.clear();
+
+    m_useTextures = this->buildTextures();
+
+    /* Overlay without textures draws only visible changed cells */
+    if (m_overlay)
+        return;
+
+    /* Large maps are drawn only from textures or from the pyramid when textures are not available */
+    if (m_rows * m_cols > persistentCellLimit)
+    {
+        if (!m_useTextures)
+            this->buildLod();
+        return;
+    }
+
+    m_vertices.resize(m_rows * m_cols * 4);
+    for (size_t y = 0; y < m_rows; y++)
+    {
+        for (size_t x = 0; x < m_cols; x++)
+        {
+            sf::Color color = this->stateColor(m_state[y * m_cols + x]);
+            sf::Vertex *quad = &m_vertices[(y * m_cols + x) * 4];
+            float X = static_cast<float>(x);
+            float Y = static_cast<float>(y);
+
+            quad[0] = sf::Vertex(sf::Vector2f(X, Y), color);
+            quad[1] = sf::Vertex(sf::Vector2f(X + 1, Y), color);
+            quad[2] = sf::Vertex(sf::Vector2f(X + 1, Y + 1), color);
+            quad[3] = sf::Vertex(sf::Vector2f(X, Y + 1), color);
+        }
+    }
+
+    /* Without vertex buffer support the vertices are drawn straight from memory */
+    m_useVertexBuffer = sf::VertexBuffer::isAvailable() && m_vertexBuffer.create(m_vertices.size());
+    if (m_useVertexBuffer)
+        m_vertexBuffer.update(m_vertices.data());
+}
+
+/** Changes colours of all cells */
+void GridRenderer::setScheme(const ColorScheme &scheme)
+{
+    m_scheme = scheme;
+    m_dirtyCells.clear();
+    this->markAllPixelsStale();
+
+    if (!m_lod.empty())
+    {
+        this->buildLod();
+        return;
+    }
+    if (m_vertices.empty())
+        return;
+
+    for (size_t cell = 0; cell < m_state.size(); cell++)
+    {
+        sf::Color color = this->stateColor(m_state[cell]);
+        for (int i = 0; i < 4; i++)
+            m_vertices[cell * 4 + i].color = color;
+    }
+    if (m_useVertexBuffer)
+        m_vertexBuffer.update(m_vertices.data());
+}
+
+/** Changes state of the cell */
+void GridRenderer::setCell(Position pos, CellState state)
+{
+    if (pos.first < 0 || pos.second < 0 || pos.first >= (int) m_cols || pos.second >= (int) m_rows)
+        return;
+
+    size_t cell = pos.second * m_cols + pos.first;
+    m_state[cell] = state;
+    m_dirtyCells.push_back(cell);
+    m_touchedCells.push_back(cell);
+}
+
+/** Restores all cells changed since build/last restore */
+void GridRenderer::restore(void)
+{
+    for (size_t cell: m_touchedCells)
+    {
+        if (m_state[cell] != m_baseState[cell])
+        {
+            m_state[cell] = m_baseState[cell];
+            m_dirtyCells.push_back(cell);
+        }
+    }
+    m_touchedCells.clear();
+}
+
+/** Lod cell of given level, level 0 is computed from cell states */
+GridRenderer::LodCell GridRenderer::lodChild(size_t level, size_t x, size_t y) const
+{
+    if (level > 0)
+        return m_lod[level - 1].cells[y * m_lod[level - 1].cols + x];
+
+    CellState state = m_state[y * m_cols + x];
+    sf::Color color = this->stateColor(state);
+
+    LodCell cell;
+    cell.r = color.r;
+    cell.g = color.g;
+    cell.b = color.b;
+    if (state == CellState::Path || state == CellState::StartEnd)
+        cell.highlight = static_cast<uint8_t>(state);
+    return cell;
+}
+
+/** Recomputes one cell of level from its children, cells outside of the grid are ignored */
+void GridRenderer::recomputeLod(size_t level, size_t x, size_t y)
+{
+    size_t childRows = level == 1 ? m_rows : m_lod[level - 2].rows;
+    size_t childCols = level == 1 ? m_cols : m_lod[level - 2].cols;
+
+    unsigned r = 0, g = 0, b = 0, count = 0;
+    uint8_t highlight = 0;
+    for (size_t cy = 2 * y; cy < std::min(2 * y + 2, childRows); cy++)
+    {
+        for (size_t cx = 2 * x; cx < std::min(2 * x + 2, childCols); cx++)
+        {
+            LodCell child = this->lodChild(level - 1, cx, cy);
+            r += child.r;
+            g += child.g;
+            b += child.b;
+            highlight = std::max(highlight, child.highlight);
+            count++;
+        }
+    }
+
+    LodCell &cell = m_lod[level - 1].cells[y * m_lod[level - 1].cols + x];
+    cell.r = static_cast<uint8_t>(r / count);
+    cell.g = static_cast<uint8_t>(g / count);
+    cell.b = static_cast<uint8_t>(b / count);
+    cell.highlight = highlight;
+}
+
+/** Creates all levels of the pyramid, the coarsest level fits into 64 x 64 cells */
+void GridRenderer::buildLod(void)
+{
+    m_lod.clear();
+
+    size_t rows = m_rows;
+    size_t cols = m_cols;
+    while (rows > 64 || cols > 64)
+    {
+        rows = (rows + 1) / 2;
+        cols = (cols + 1) / 2;
+        m_lod.push_back(LodLevel{rows, cols, std::vector<LodCell>(rows * cols)});
+
+        size_t level = m_lod.size();
+        for (size_t y = 0; y < rows; y++)
+        {
+            for (size_t x = 0; x < cols; x++)
+                this->recomputeLod(level, x, y);
+        }
+    }
+}
+
+/** Creates textures covering the grid, one texel per cell, pixels are uploaded when they are first drawn */
+bool GridRenderer::buildTextures(void)
+{
+    m_chunks.clear();
+    m_tileDirty.clear();
+    m_dirtyTiles.clear();
+    m_allPixelsStale = false;
+
+    if (m_rows == 0 || m_cols == 0)
+        return false;
+
+    /* Maximum size is a power of two, chunks are then made of whole tiles */
+    m_chunkSize = std::min<size_t>(sf::Texture::getMaximumSize(), 8192);
+    if (m_chunkSize < textureTile)
+        return false;
+
+    m_chunkCols = (m_cols + m_chunkSize - 1) / m_chunkSize;
+    size_t chunkRows = (m_rows + m_chunkSize - 1) / m_chunkSize;
+
+    /* Textures are not copied after they are created */
+    m_chunks.resize(m_chunkCols * chunkRows);
+    for (size_t i = 0; i < m_chunks.size(); i++)
+    {
+        TextureChunk &chunk = m_chunks[i];
+        chunk.x = (i % m_chunkCols) * m_chunkSize;
+        chunk.y = (i / m_chunkCols) * m_chunkSize;
+        chunk.width = std::min(m_chunkSize, m_cols - chunk.x);
+        chunk.height = std::min(m_chunkSize, m_rows - chunk.y);
+        if (!chunk.texture.create(chunk.width, chunk.height))
+        {
+            m_chunks.clear();
+            return false;
+        }
+    }
+
+    m_tileCols = (m_cols + textureTile - 1) / textureTile;
+    m_tileDirty.assign(m_tileCols * ((m_rows + textureTile - 1) / textureTile), 0);
+
+    /* Cells are uploaded with the first draw from textures */
+    m_allPixelsStale = true;
+    return true;
+}
+
+/** Colour of the cell in textures, cells of overlay in their base state are transparent */
+sf::Color GridRenderer::pixelColor(size_t cell) const
+{
+    if (m_overlay && m_state[cell] == m_baseState[cell])
+        return sf::Color::Transparent;
+    return this->stateColor(m_state[cell]);
+}
+
+/** Uploads colours of rectangle of cells into the chunk containing it */
+void GridRenderer::uploadRect(size_t x, size_t y, size_t width, size_t height)
+{
+    TextureChunk &chunk = m_chunks[(y / m_chunkSize) * m_chunkCols + x / m_chunkSize];
+
+    /* Colours are computed from cell states, so no copy of the textures is kept in memory */
+    m_uploadBuffer.resize(width * height * 4);
+    for (size_t row = 0; row < height; row++)
+    {
+        sf::Uint8 *pixel = &m_uploadBuffer[row * width * 4];
+        for (size_t cell = (y + row) * m_cols + x; cell < (y + row) * m_cols + x + width; cell++)
+        {
+            sf::Color color = this->pixelColor(cell);
+            *pixel++ = color.r;
+            *pixel++ = color.g;
+            *pixel++ = color.b;
+            *pixel++ = color.a;
+        }
+    }
+
+    chunk.texture.update(m_uploadBuffer.data(), width, height, x - chunk.x, y - chunk.y);
+    m_stats.uploads++;
+}
+
+/** Uploads every cell, one band of tile rows at a time so the upload buffer stays small */
+void GridRenderer::uploadAllPixels(void)
+{
+    for (const TextureChunk &chunk: m_chunks)
+    {
+        for (size_t y = chunk.y; y < chunk.y + chunk.height; y += textureTile)
+            this->uploadRect(chunk.x, y, chunk.width, std::min(textureTile, chunk.y + chunk.height - y));
+    }
+}
+
+/** Uploads changed tiles, run of neighbouring tiles in one row and chunk is one rectangle */
+void GridRenderer::uploadDirtyTiles(void)
+{
+    if (m_dirtyTiles.empty())
+        return;
+
+    std::sort(m_dirtyTiles.begin(), m_dirtyTiles.end());
+
+    size_t tilesPerChunk = m_chunkSize / textureTile;
+    size_t first = m_dirtyTiles[0];
+    size_t last = first;
+    for (size_t i = 1; i <= m_dirtyTiles.size(); i++)
+    {
+        if (i < m_dirtyTiles.size())
+        {
+            size_t tile = m_dirtyTiles[i];
+            bool sameRow = tile / m_tileCols == last / m_tileCols;
+            bool sameChunk = (tile % m_tileCols) / tilesPerChunk == (first % m_tileCols) / tilesPerChunk;
+            if (tile == last + 1 && sameRow && sameChunk)
+            {
+                last = tile;
+                continue;
+            }
+        }
+
+        size_t x = (first % m_tileCols) * textureTile;
+        size_t y = (first / m_tileCols) * textureTile;
+        size_t width = std::min((last % m_tileCols + 1) * textureTile, m_cols) - x;
+        size_t height = std::min(textureTile, m_rows - y);
+        this->uploadRect(x, y, width, height);
+
+        if (i < m_dirtyTiles.size())
+            first = last = m_dirtyTiles[i];
+    }
+
+    for (size_t tile: m_dirtyTiles)
+        m_tileDirty[tile] = 0;
+    m_dirtyTiles.clear();
+}
+
+/** Next draw from textures uploads every cell */
+void GridRenderer::markAllPixelsStale(void)
+{
+    for (size_t tile: m_dirtyTiles)
+        m_tileDirty[tile] = 0;
+    m_dirtyTiles.clear();
+    m_allPixelsStale = m_useTextures;
+}
+
+/** Uploads all cells or only tiles containing cells changed since textures were last drawn */
+void GridRenderer::flushPixels(void)
+{
+    if (!m_allPixelsStale)
+    {
+        this->uploadDirtyTiles();
+        return;
+    }
+
+    this->uploadAllPixels();
+    m_allPixelsStale = false;
+}
+
+/** Propagates changed cells up the pyramid and into vertex buffer, textures are only marked stale */
+void GridRenderer::flushDirty(void)
+{
+    /* Uploading few unchanged cells is cheaper than another update call */
+    const size_t mergeGap = 32;
+
+    if (m_dirtyCells.empty())
+        return;
+
+    m_stats.cellsUpdated += m_dirtyCells.size();
+    std::sort(m_dirtyCells.begin(), m_dirtyCells.end());
+    m_dirtyCells.erase(std::unique(m_dirtyCells.begin(), m_dirtyCells.end()), m_dirtyCells.end());
+
+    /* Textures - tiles of changed cells are only marked, they are uploaded when the textures are drawn */
+    if (m_useTextures && !m_allPixelsStale)
+    {
+        for (size_t cell: m_dirtyCells)
+        {
+            size_t tile = (cell / m_cols / textureTile) * m_tileCols + (cell % m_cols) / textureTile;
+            if (!m_tileDirty[tile])
+            {
+                m_tileDirty[tile] = 1;
+                m_dirtyTiles.push_back(tile);
+            }
+        }
+    }
+
+    /* Pyramid - parents of changed cells are recomputed level by level */
+    if (!m_lod.empty())
+    {
+        std::vector<size_t> parents;
+        size_t cols = m_cols;
+        for (size_t level = 1; level <= m_lod.size(); level++)
+        {
+            parents.clear();
+            for (size_t cell: m_dirtyCells)
+                parents.push_back((cell / cols / 2) * m_lod[level - 1].cols + (cell % cols) / 2);
+
+            std::sort(parents.begin(), parents.end());
+            parents.erase(std::unique(parents.begin(), parents.end()), parents.end());
+
+            for (size_t parent: parents)
+                this->recomputeLod(level, parent % m_lod[level - 1].cols, parent / m_lod[level - 1].cols);
+
+            cols = m_lod[level - 1].cols;
+            m_dirtyCells.swap(parents);
+        }
+        m_dirtyCells.clear();
+        return;
+    }
+
+    /* Overlay or large map drawn from textures, level 0 is drawn straight from cell states */
+    if (m_vertices.empty())
+    {
+        m_dirtyCells.clear();
+        return;
+    }
+
+    for (size_t cell: m_dirtyCells)
+    {
+        sf::Color color = this->stateColor(m_state[cell]);
+        for (int i = 0; i < 4; i++)
+            m_vertices[cell * 4 + i].color = color;
+    }
+
+    if (m_useVertexBuffer)
+    {
+        size_t first = m_dirtyCells[0];
+        size_t last = first;
+        for (size_t i = 1; i <= m_dirtyCells.size(); i++)
+        {
+            if (i < m_dirtyCells.size() && m_dirtyCells[i] - last <= mergeGap)
+            {
+                last = m_dirtyCells[i];
+                continue;
+            }
+
+            m_vertexBuffer.update(&m_vertices[first * 4], (last - first + 1) * 4, first * 4);
+            m_stats.uploads++;
+
+            if (i < m_dirtyCells.size())
+                first = last = m_dirtyCells[i];
+        }
+    }
+
+    m_dirtyCells.clear();
+}
+
+/** Appends one quad into the per frame vertex array */
+void GridRenderer::appendQuad(float x, float y, float width, float height, const sf::Color &color)
+{
+    m_frameVertices.push_back(sf::Vertex(sf::Vector2f(x, y), color));
+    m_frameVertices.push_back(sf::Vertex(sf::Vector2f(x + width, y), color));
+    m_frameVertices.push_back(sf::Vertex(sf::Vector2f(x + width, y + height), color));
+    m_frameVertices.push_back(sf::Vertex(sf::Vector2f(x, y + height), color));
+}
+
+/** Draws cells of the level that are visible through the view */
+void GridRenderer::drawCulled(sf::RenderTarget &target, const sf::View &view, size_t level)
+{
+    size_t scale = static_cast<size_t>(1) << level;
+    size_t rows = level == 0 ? m_rows : m_lod[level - 1].rows;
+    size_t cols = level == 0 ? m_cols : m_lod[level - 1].cols;
+
+    /* Visible part of the world in cells of the level */
+    sf::Vector2f topLeft = view.getCenter() - view.getSize() / 2.0f;
+    sf::Vector2f bottomRight = view.getCenter() + view.getSize() / 2.0f;
+    auto toCell = [scale](float world, size_t limit) {
+        double cell = std::floor(world / scale);
+        return static_cast<size_t>(std::clamp(cell, 0.0, static_cast<double>(limit)));
+    };
+    size_t x0 = toCell(topLeft.x, cols);
+    size_t y0 = toCell(topLeft.y, rows);
+    size_t x1 = std::min(toCell(bottomRight.x, cols) + 1, cols);
+    size_t y1 = std::min(toCell(bottomRight.y, rows) + 1, rows);
+
+    m_frameVertices.clear();
+    for (size_t y = y0; y < y1; y++)
+    {
+        for (size_t x = x0; x < x1; x++)
+        {
+            /* Overlay draws only changed cells */
+            if (level == 0 && m_overlay && m_state[y * m_cols + x] == m_baseState[y * m_cols + x])
+                continue;
+
+            sf::Color color;
+            if (level == 0)
+                color = this->stateColor(m_state[y * m_cols + x]);
+            else
+            {
+                const LodCell &cell = m_lod[level - 1].cells[y * cols + x];
+                color = cell.highlight ? this->stateColor(static_cast<CellState>(cell.highlight)) : sf::Color(cell.r, cell.g, cell.b);
+            }
+
+            /* Last row/column of the level can cover less cells of the grid */
+            float X = static_cast<float>(x * scale);
+            float Y = static_cast<float>(y * scale);
+            float width = static_cast<float>(std::min(scale, m_cols - x * scale));
+            float height = static_cast<float>(std::min(scale, m_rows - y * scale));
+            this->appendQuad(X, Y, width, height, color);
+        }
+    }
+
+    if (!m_frameVertices.empty())
+    {
+        target.draw(m_frameVertices.data(), m_frameVertices.size(), sf::Quads);
+        m_stats.drawCalls++;
+        m_stats.vertices += m_frameVertices.size();
+    }
+}
+
+/** Draws every texture as one sprite, world unit is one texel */
+void GridRenderer::drawTextures(sf::RenderTarget &target)
+{
+    this->flushPixels();
+
+    for (const TextureChunk &chunk: m_chunks)
+    {
+        sf::Sprite sprite(chunk.texture);
+        sprite.setPosition(static_cast<float>(chunk.x), static_cast<float>(chunk.y));
+        target.draw(sprite);
+
+        m_stats.drawCalls++;
+        m_stats.vertices += 4;
+    }
+}
+
+/** Draws cells visible through the view */
+void GridRenderer::draw(sf::RenderTarget &target, const sf::View &view)
+{
+    this->flushDirty();
+    target.setView(view);
+
+    /* Overlay - textures at every zoom, the map below shows through transparent cells */
+    if (m_overlay)
+    {
+        if (m_useTextures)
+            this->drawTextures(target);
+        else
+            this->drawCulled(target, view, 0);
+        return;
+    }
+
+    double pixelsPerCell = target.getViewport(view).width / view.getSize().x;
+    bool largeMap = m_vertices.empty();
+
+    /* Cells smaller than a pixel (or smaller than lodPixels on large maps) - one scaled sprite per texture */
+    if (m_useTextures && pixelsPerCell < (largeMap ? lodPixels : 1.0))
+    {
+        this->drawTextures(target);
+        return;
+    }
+
+    /* Small maps - whole persistent buffer, clipping is left to the GPU */
+    if (!largeMap)
+    {
+        if (m_useVertexBuffer)
+            target.draw(m_vertexBuffer);
+        else
+            target.draw(m_vertices.data(), m_vertices.size(), sf::Quads);
+
+        m_stats.drawCalls++;
+        m_stats.vertices += m_vertices.size();
+        return;
+    }
+
+    /* Large maps - finest level whose cells are at least lodPixels wide, only visible cells */
+    size_t level = 0;
+    while (level < m_lod.size() && pixelsPerCell * (static_cast<size_t>(1) << level) < lodPixels)
+        level++;
+
+    this->drawCulled(target, view, level);
+}
+
+/** Returns counters since the last call and clears them */
+RenderStats GridRenderer::takeStats(void)
+{
+    RenderStats stats = m_stats;
+    m_stats = RenderStats();
+    return stats;
+}
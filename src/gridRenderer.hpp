@@ -0,0 +1,209 @@
+/**
+* @file gridRenderer.hpp
+* @author Ondrej
+* @brief Draws grid cells and keeps their state, level of detail is used for large maps
+*
+* Cell (x, y) occupies square [x, x + 1) x [y, y + 1) in world coordinates, camera (sf::View) decides what is visible.
+* When cells are smaller than a pixel, the grid is drawn as scaled textures with one texel per cell.
+* Overlay renderer keeps only the textures, cells in their base state are transparent there, so several overlays can
+* share one renderer of the map drawn below them.
+**/
+
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "colorScheme.hpp"
+#include "graph.hpp"
+
+
+/** Counters of work done by the renderer */
+struct RenderStats
+{
+    size_t cellsUpdated = 0;
+    size_t uploads = 0;
+    size_t drawCalls = 0;
+    size_t vertices = 0;
+};
+
+class GridRenderer
+{
+public:
+    /** Maps with more cells are drawn from level of detail pyramid instead of persistent vertex buffer */
+    static const size_t persistentCellLimit = 1000 * 1000;
+
+    /** Level of detail is chosen so that drawn cell is at least this many pixels wide */
+    static constexpr double lodPixels = 2.0;
+
+    /** Changed cells are uploaded into textures in tiles of this size (in cells) */
+    static const size_t textureTile = 64;
+
+    GridRenderer() : m_vertexBuffer(sf::Quads, sf::VertexBuffer::Dynamic) {};
+
+    /** Prepares cells of the grid, geometry/pyramid is created only here (never for overlay) */
+    void build(const Graph &graph, const ColorScheme &scheme, bool overlay = false);
+
+    /** Changes colours of all cells */
+    void setScheme(const ColorScheme &scheme);
+
+    /** Changes state of the cell, it is uploaded with the next draw */
+    void setCell(Position pos, CellState state);
+
+    /** Restores all cells changed since build/last restore */
+    void restore(void);
+
+    /** Draws cells visible through the view */
+    void draw(sf::RenderTarget &target, const sf::View &view);
+
+    bool built(void) const { return !m_state.empty(); }
+
+    /** Current state of the cell, position has to be inside the grid */
+    CellState cell(Position pos) const { return m_state[pos.second * m_cols + pos.first]; }
+
+    size_t rows(void) const { return m_rows; }
+
+    size_t cols(void) const { return m_cols; }
+
+    /** Returns counters since the last call and clears them */
+    RenderStats takeStats(void);
+
+private:
+    /** Downsampled cell, average colour of the covered cells, highlight (path, start/end) wins over the average */
+    struct LodCell
+    {
+        uint8_t r = 0;
+        uint8_t g = 0;
+        uint8_t b = 0;
+        /** CellState of the highlighted cell or 0 */
+        uint8_t highlight = 0;
+    };
+
+    /** One level of the pyramid, cell covers 2^level x 2^level cells of the grid */
+    struct LodLevel
+    {
+        size_t rows;
+        size_t cols;
+        std::vector<LodCell> cells;
+    };
+
+    /** Part of the grid stored in one texture, textures are limited by sf::Texture::getMaximumSize */
+    struct TextureChunk
+    {
+        size_t x = 0;
+        size_t y = 0;
+        size_t width = 0;
+        size_t height = 0;
+        sf::Texture texture;
+    };
+
+    /** Colour of the state in current scheme */
+    sf::Color stateColor(CellState state) const;
+
+    /** State of the cell in the graph before any step of the algorithm */
+    CellState baseState(Position pos) const;
+
+    /** Lod cell of level k (k >= 1), level 0 is computed from cell states */
+    LodCell lodChild(size_t level, size_t x, size_t y) const;
+
+    /** Recomputes one cell of level from its 4 children */
+    void recomputeLod(size_t level, size_t x, size_t y);
+
+    /** Creates all levels of the pyramid */
+    void buildLod(void);
+
+    /** Creates textures covering the grid, returns false if textures are not available */
+    bool buildTextures(void);
+
+    /** Colour of the cell in textures, cells of overlay in their base state are transparent */
+    sf::Color pixelColor(size_t cell) const;
+
+    /** Uploads colours of rectangle of cells into texture, rectangle has to lie in one chunk */
+    void uploadRect(size_t x, size_t y, size_t width, size_t height);
+
+    /** Uploads every cell of all textures */
+    void uploadAllPixels(void);
+
+    /** Uploads changed tiles, neighbouring tiles in a row are uploaded as one rectangle */
+    void uploadDirtyTiles(void);
+
+    /** Next draw from textures uploads every cell */
+    void markAllPixelsStale(void);
+
+    /** Uploads stale tiles, called only right before textures are drawn */
+    void flushPixels(void);
+
+    /** Propagates changed cells up the pyramid and into vertex buffer, textures are only marked stale */
+    void flushDirty(void);
+
+    /** Appends one quad into the per frame vertex array */
+    void appendQuad(float x, float y, float width, float height, const sf::Color &color);
+
+    /** Draws visible cells of the level */
+    void drawCulled(sf::RenderTarget &target, const sf::View &view, size_t level);
+
+    /** Draws every texture as one sprite, the view scales it */
+    void drawTextures(sf::RenderTarget &target);
+
+    size_t m_rows = 0;
+
+    size_t m_cols = 0;
+
+    Position m_start;
+
+    Position m_end;
+
+    std::vector<CellState> m_baseState;
+
+    std::vector<CellState> m_state;
+
+    ColorScheme m_scheme;
+
+    /** Only textures of changed cells, see build */
+    bool m_overlay = false;
+
+    /** 4 vertices per cell, only for maps up to persistentCellLimit */
+    std::vector<sf::Vertex> m_vertices;
+
+    /** Copy of m_vertices on GPU, only changed ranges are uploaded */
+    sf::VertexBuffer m_vertexBuffer;
+
+    bool m_useVertexBuffer = false;
+
+    /** Levels 1, 2, ... of the pyramid (only for maps over persistentCellLimit without textures) */
+    std::vector<LodLevel> m_lod;
+
+    std::vector<TextureChunk> m_chunks;
+
+    bool m_useTextures = false;
+
+    /** Width and height of one chunk in cells */
+    size_t m_chunkSize = 0;
+
+    size_t m_chunkCols = 0;
+
+    size_t m_tileCols = 0;
+
+    /** Flag for every tile with cells changed since textures were last drawn, these tiles are listed in m_dirtyTiles */
+    std::vector<uint8_t> m_tileDirty;
+
+    std::vector<size_t> m_dirtyTiles;
+
+    /** Every tile is stale (after build or scheme change), no tile is then listed in m_dirtyTiles */
+    bool m_allPixelsStale = false;
+
+    /** Colours of the rectangle being uploaded, computed from cell states */
+    std::vector<sf::Uint8> m_uploadBuffer;
+
+    /** Vertices of visible cells, rebuilt every frame, capacity is kept */
+    std::vector<sf::Vertex> m_frameVertices;
+
+    /** Cells changed since the last draw */
+    std::vector<size_t> m_dirtyCells;
+
+    /** Cells changed since the last restore */
+    std::vector<size_t> m_touchedCells;
+
+    RenderStats m_stats;
+};
@@ -0,0 +1,296 @@
+/**
+* @file imageEncoder.cpp
+* @author Ondrej
+* @brief Implementation of PNG and GIF encoding
+**/
+
+#include "imageEncoder.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <zlib.h>
+
+/** Every pixel becomes scale x scale block */
+IndexedImage upscale(const IndexedImage &image, size_t scale)
+{
+    if (scale <= 1)
+        return image;
+
+    IndexedImage result;
+    result.width = image.width * scale;
+    result.height = image.height * scale;
+    result.pixels.resize(result.width * result.height);
+
+    for (size_t y = 0; y < image.height; y++)
+    {
+        uint8_t *row = &result.pixels[y * scale * result.width];
+        for (size_t x = 0; x < image.width; x++)
+            std::fill_n(row + x * scale, scale, image.pixels[y * image.width + x]);
+
+        /* Other rows of the block are copies of the first one */
+        for (size_t copy = 1; copy < scale; copy++)
+            std::copy_n(row, result.width, row + copy * result.width);
+    }
+    return result;
+}
+
+/** Appends number in big endian (PNG) */
+static void appendU32BE(std::vector<uint8_t> &data, uint32_t value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        data.push_back(static_cast<uint8_t>(value >> shift));
+}
+
+/** Appends number in little endian (GIF) */
+static void appendU16LE(std::vector<uint8_t> &data, size_t value)
+{
+    data.push_back(static_cast<uint8_t>(value & 0xFF));
+    data.push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
+}
+
+/** Appends PNG chunk - length, type, data and CRC of type and data */
+static void appendChunk(std::vector<uint8_t> &png, const char *type, const std::vector<uint8_t> &data)
+{
+    appendU32BE(png, static_cast<uint32_t>(data.size()));
+
+    size_t typeBegin = png.size();
+    png.insert(png.end(), type, type + 4);
+    png.insert(png.end(), data.begin(), data.end());
+
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, &png[typeBegin], static_cast<uInt>(png.size() - typeBegin));
+    appendU32BE(png, static_cast<uint32_t>(crc));
+}
+
+/** Whole PNG file, every row uses filter 0 (palette indices compress well without filtering) */
+std::vector<uint8_t> encodePng(const IndexedImage &image, const std::vector<RGB> &palette)
+{
+    static const uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    std::vector<uint8_t> png(signature, signature + sizeof(signature));
+
+    std::vector<uint8_t> header;
+    appendU32BE(header, static_cast<uint32_t>(image.width));
+    appendU32BE(header, static_cast<uint32_t>(image.height));
+    /* Bit depth 8, colour type 3 (palette), compression, filter, interlace */
+    header.insert(header.end(), {8, 3, 0, 0, 0});
+    appendChunk(png, "IHDR", header);
+
+    std::vector<uint8_t> colors;
+    for (const RGB &color: palette)
+        colors.insert(colors.end(), {static_cast<uint8_t>(color.r), static_cast<uint8_t>(color.g), static_cast<uint8_t>(color.b)});
+    appendChunk(png, "PLTE", colors);
+
+    std::vector<uint8_t> raw;
+    raw.reserve((image.width + 1) * image.height);
+    for (size_t y = 0; y < image.height; y++)
+    {
+        raw.push_back(0);
+        raw.insert(raw.end(), image.pixels.begin() + y * image.width, image.pixels.begin() + (y + 1) * image.width);
+    }
+
+    uLongf compressedSize = compressBound(static_cast<uLong>(raw.size()));
+    std::vector<uint8_t> compressed(compressedSize);
+    if (compress2(compressed.data(), &compressedSize, raw.data(), static_cast<uLong>(raw.size()), Z_DEFAULT_COMPRESSION) != Z_OK)
+        throw std::runtime_error("PNG compression failed");
+    compressed.resize(compressedSize);
+    appendChunk(png, "IDAT", compressed);
+
+    appendChunk(png, "IEND", {});
+    return png;
+}
+
+/** Smallest number of bits that can index the palette (at least 1) */
+static int paletteBits(size_t paletteSize)
+{
+    int bits = 1;
+    while ((static_cast<size_t>(1) << bits) < paletteSize)
+        bits++;
+    return bits;
+}
+
+/** Writes codes of variable width, least significant bit first */
+class BitWriter
+{
+public:
+    explicit BitWriter(std::vector<uint8_t> &output) : m_output(output) {};
+
+    void write(unsigned code, int width)
+    {
+        m_buffer |= static_cast<uint32_t>(code) << m_bits;
+        m_bits += width;
+        while (m_bits >= 8)
+        {
+            m_output.push_back(static_cast<uint8_t>(m_buffer & 0xFF));
+            m_buffer >>= 8;
+            m_bits -= 8;
+        }
+    }
+
+    void flush(void)
+    {
+        if (m_bits > 0)
+            m_output.push_back(static_cast<uint8_t>(m_buffer & 0xFF));
+        m_buffer = 0;
+        m_bits = 0;
+    }
+
+private:
+    std::vector<uint8_t> &m_output;
+
+    uint32_t m_buffer = 0;
+
+    int m_bits = 0;
+};
+
+/**
+* @brief GIF variant of LZW
+* - Code width grows when the decoder's table (one entry behind the encoder's) reaches the next power of two
+* - Table is cleared when it is full (4096 codes)
+**/
+static std::vector<uint8_t> lzwEncode(const std::vector<uint8_t> &pixels, int minCodeSize)
+{
+    const unsigned maxCodes = 4096;
+    const unsigned alphabet = 1u << minCodeSize;
+    const unsigned clearCode = alphabet;
+    const unsigned endCode = alphabet + 1;
+
+    std::vector<uint8_t> data;
+    BitWriter writer(data);
+
+    /* Child of code for every pixel value, 0 - none (codes below endCode are never children) */
+    std::vector<uint16_t> children(maxCodes * alphabet, 0);
+
+    int codeSize = minCodeSize + 1;
+    unsigned nextCode = endCode + 1;
+    size_t codesSinceClear = 0;
+
+    writer.write(clearCode, codeSize);
+    if (pixels.empty())
+    {
+        writer.write(endCode, codeSize);
+        writer.flush();
+        return data;
+    }
+
+    unsigned current = pixels[0];
+    for (size_t i = 1; i < pixels.size(); i++)
+    {
+        unsigned pixel = pixels[i];
+        uint16_t child = children[current * alphabet + pixel];
+        if (child != 0)
+        {
+            current = child;
+            continue;
+        }
+
+        writer.write(current, codeSize);
+        codesSinceClear++;
+        children[current * alphabet + pixel] = static_cast<uint16_t>(nextCode);
+
+        /* nextCode is the newest code now, decoder will know it after reading the next code */
+        if (nextCode >= (1u << codeSize) && codeSize < 12)
+            codeSize++;
+        nextCode++;
+
+        if (nextCode == maxCodes)
+        {
+            writer.write(clearCode, codeSize);
+            std::fill(children.begin(), children.end(), 0);
+            codeSize = minCodeSize + 1;
+            nextCode = endCode + 1;
+            codesSinceClear = 0;
+        }
+
+        current = pixel;
+    }
+
+    writer.write(current, codeSize);
+    codesSinceClear++;
+
+    /* Decoder adds an entry after the last code too (except the first code after clear) */
+    if (codesSinceClear > 1 && nextCode >= (1u << codeSize) && codeSize < 12)
+        codeSize++;
+
+    writer.write(endCode, codeSize);
+    writer.flush();
+    return data;
+}
+
+GifWriter::GifWriter(std::ostream &output, size_t width, size_t height, const std::vector<RGB> &palette)
+    : m_output(output)
+{
+    if (width > 0xFFFF || height > 0xFFFF)
+        throw std::invalid_argument("GIF cannot be larger than 65535 x 65535");
+    if (palette.empty() || palette.size() > 256)
+        throw std::invalid_argument("GIF palette has to have 1 - 256 colours");
+
+    int bits = paletteBits(palette.size());
+
+    std::vector<uint8_t> header = {'G', 'I', 'F', '8', '9', 'a'};
+    appendU16LE(header, width);
+    appendU16LE(header, height);
+    /* Global colour table, colour resolution, size of the table */
+    header.push_back(static_cast<uint8_t>(0x80 | ((bits - 1) << 4) | (bits - 1)));
+    header.push_back(0);
+    header.push_back(0);
+
+    for (size_t i = 0; i < (static_cast<size_t>(1) << bits); i++)
+    {
+        RGB color = i < palette.size() ? palette[i] : RGB{0, 0, 0, 255};
+        header.insert(header.end(), {static_cast<uint8_t>(color.r), static_cast<uint8_t>(color.g), static_cast<uint8_t>(color.b)});
+    }
+
+    /* Netscape extension - loop forever */
+    const char netscape[] = "NETSCAPE2.0";
+    header.insert(header.end(), {0x21, 0xFF, 0x0B});
+    header.insert(header.end(), netscape, netscape + 11);
+    header.insert(header.end(), {0x03, 0x01, 0x00, 0x00, 0x00});
+
+    m_output.write(reinterpret_cast<const char *>(header.data()), header.size());
+}
+
+/** One frame, independent of the other frames */
+std::vector<uint8_t> GifWriter::encodeFrame(const IndexedImage &image, size_t paletteSize, unsigned delay)
+{
+    std::vector<uint8_t> frame;
+
+    /* Graphic control extension - no disposal, no transparency */
+    frame.insert(frame.end(), {0x21, 0xF9, 0x04, 0x00});
+    appendU16LE(frame, delay);
+    frame.insert(frame.end(), {0x00, 0x00});
+
+    /* Image descriptor, whole screen, global palette */
+    frame.push_back(0x2C);
+    appendU16LE(frame, 0);
+    appendU16LE(frame, 0);
+    appendU16LE(frame, image.width);
+    appendU16LE(frame, image.height);
+    frame.push_back(0x00);
+
+    int minCodeSize = std::max(2, paletteBits(paletteSize));
+    frame.push_back(static_cast<uint8_t>(minCodeSize));
+
+    /* Data in sub-blocks of at most 255 bytes */
+    std::vector<uint8_t> data = lzwEncode(image.pixels, minCodeSize);
+    for (size_t offset = 0; offset < data.size(); offset += 255)
+    {
+        size_t length = std::min<size_t>(255, data.size() - offset);
+        frame.push_back(static_cast<uint8_t>(length));
+        frame.insert(frame.end(), data.begin() + offset, data.begin() + offset + length);
+    }
+    frame.push_back(0x00);
+
+    return frame;
+}
+
+void GifWriter::writeFrame(const std::vector<uint8_t> &frame)
+{
+    m_output.write(reinterpret_cast<const char *>(frame.data()), frame.size());
+}
+
+bool GifWriter::finish(void)
+{
+    m_output.put(0x3B);
+    m_output.flush();
+    return static_cast<bool>(m_output);
+}
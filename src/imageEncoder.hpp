@@ -0,0 +1,50 @@
+/**
+* @file imageEncoder.hpp
+* @author Ondrej
+* @brief Encoding of palette images into PNG files and animated GIF
+**/
+
+#pragma once
+
+#include "colorScheme.hpp"
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+
+/** Image where every pixel is an index into palette */
+struct IndexedImage
+{
+    size_t width = 0;
+    size_t height = 0;
+    std::vector<uint8_t> pixels;
+};
+
+/** Every pixel becomes scale x scale block */
+IndexedImage upscale(const IndexedImage &image, size_t scale);
+
+/** Whole PNG file (palette colour type, deflate by zlib), palette has at most 256 colours */
+std::vector<uint8_t> encodePng(const IndexedImage &image, const std::vector<RGB> &palette);
+
+/**
+* @brief Animated GIF written frame by frame, loops forever
+* - encodeFrame does not depend on the writer, so frames can be encoded in parallel and written in order
+**/
+class GifWriter
+{
+public:
+    /** Writes header and global palette (at most 256 colours), size is limited to 65535 x 65535 */
+    GifWriter(std::ostream &output, size_t width, size_t height, const std::vector<RGB> &palette);
+
+    /** Graphic control extension, image descriptor and LZW data of one frame, delay is in hundredths of second */
+    static std::vector<uint8_t> encodeFrame(const IndexedImage &image, size_t paletteSize, unsigned delay);
+
+    void writeFrame(const std::vector<uint8_t> &frame);
+
+    /** Writes trailer, returns false if anything could not be written */
+    bool finish(void);
+
+private:
+    std::ostream &m_output;
+};
@@ -4,18 +4,43 @@
 * @brief Main function that parses input arguments and calls other functions/metods
 */
 
+#include "comparisonView.hpp"
 #include "conversion.hpp"
 #include "graph.hpp"
 #include "graphVisualisation.hpp"
+#include "gridMap.hpp"
+#include "profiler.hpp"
 
 #include <iostream>
 #include <map>
+#include <string>
+#include <vector>
+
+/** Writes the trace if it was requested, false if it cannot be written */
+static bool finishTrace(const std::string &tracePath)
+{
+    if (tracePath.empty())
+        return true;
+    if (Profiler::finish(tracePath))
+        return true;
+    std::cerr << "Cannot write trace " << tracePath << std::endl;
+    return false;
+}
 
 /**
 * @brief Manages whole program
-* - Argument 1: Algorithm type (bfs/dfs/astar/random/greedy)
+* - Argument 1: Algorithm type (bfs/dfs/astar/random/greedy/wastar/focal)
 * - Argument 2: File path (relative)
 * - Argument 3: (Optional) Visualisation speed (1-100), default value is 50
+* - Options (anywhere after program name):
+*   - --arena: Search containers use monotonic arena that is released between runs
+*   - --alloc-stats: Prints allocations made by every search
+*   - --compare: All algorithms side by side, algorithm argument only has to be valid
+*   - --cache-dir <dir>: Directory of cached search results (default .search-cache)
+*   - --no-cache: Every search runs, nothing is stored
+*   - --trace <file>: Writes Chrome trace events of loading, searches, frames and drawing of all threads into file
+*   - --epsilon <e>: Weighted A* and focal search paths are at most 1 + e times longer than the shortest (default 0.5)
+*   - --subgoals: BFS and A* search the subgoal graph of the map, only subgoals are visited
 *
 */
 int main(int argc, char **argv)
@@ -26,40 +51,97 @@ int main(int argc, char **argv)
     /** Default visualisation speed set to 50 */
     size_t visualisationSpeed = 50;
 
-    /* If not enough arguments */
-    if (argc < 3 || argc > 4)
-        return EXIT_FAILURE;
+    bool useArena = false;
+    bool allocationStats = false;
+    bool compare = false;
+    std::string cacheDir = ".search-cache";
+    bool useCache = true;
+    std::string tracePath;
+    double suboptimality = defaultSuboptimality;
+    bool subgoals = false;
 
-    /* Correct amount of arguments, but no Visualisation Speed argument (optional) */
-    if (argc >= 3)
+    /* Separates options from positional arguments */
+    std::vector<std::string> arguments;
+    for (int i = 1; i < argc; i++)
     {
-        /* Converts arguments to correct format, exits if conversion fails, likely wrong input */
-        if (!strToAlgoType(argv[1], algorithmType))
+        std::string argument = argv[i];
+        if (argument == "--arena")
+            useArena = true;
+        else if (argument == "--alloc-stats")
+            allocationStats = true;
+        else if (argument == "--compare")
+            compare = true;
+        else if (argument == "--cache-dir" && i + 1 < argc)
+            cacheDir = argv[++i];
+        else if (argument == "--no-cache")
+            useCache = false;
+        else if (argument == "--trace" && i + 1 < argc)
+            tracePath = argv[++i];
+        else if (argument == "--epsilon" && i + 1 < argc)
+        {
+            if (!strToNum(argv[++i], suboptimality) || !(suboptimality >= 0.0))
+                return EXIT_FAILURE;
+        }
+        else if (argument == "--subgoals")
+            subgoals = true;
+        else if (argument.rfind("--", 0) == 0)
             return EXIT_FAILURE;
-        filePath = argv[2];
+        else
+            arguments.push_back(argument);
     }
 
+    /* If not enough arguments */
+    if (arguments.size() < 2 || arguments.size() > 3)
+        return EXIT_FAILURE;
+
+    /* Converts arguments to correct format, exits if conversion fails, likely wrong input */
+    if (!strToAlgoType(arguments[0], algorithmType))
+        return EXIT_FAILURE;
+    filePath = arguments[1];
+
     /* Correct amount of arguments, even the Visualisation Speed argument */
-    if (argc == 4)
+    if (arguments.size() == 3)
     {
         /* Converts the input, exits if conversion fails */
-        if (!strToNum(argv[3], visualisationSpeed))
+        if (!strToNum(arguments[2], visualisationSpeed))
             return EXIT_FAILURE;
     }
 
+    PROFILE_THREAD("main");
+    if (!tracePath.empty())
+        Profiler::start();
+
+    /* Map is loaded once, the visualisation, comparison panes and background searches only share it */
+    std::shared_ptr<const GridMap> map = GridMap::load(filePath);
+
     /* Creates an instance of Graph */
-    Graph maze(algorithmType, filePath);
+    Graph maze(map, algorithmType, useArena, allocationStats);
+    maze.setSuboptimality(suboptimality);
+    maze.setSubgoals(subgoals);
 
     unsigned screenWidth = sf::VideoMode::getDesktopMode().width;
     unsigned screenHeight = sf::VideoMode::getDesktopMode().height;
 
     sf::RenderWindow window(sf::VideoMode({screenWidth, screenHeight}), "Graph Visualisation");
 
+    if (compare)
+    {
+        /* Panes share the map of maze, its own search is not used */
+        ComparisonView comparison(maze, window, visualisationSpeed);
+        comparison.windowLoop();
+        window.close();
+
+        return finishTrace(tracePath) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    /* Results of finished searches, also kept on disk for the next runs */
+    ResultCache cache(useCache ? cacheDir : "", useCache ? ResultCache::defaultMemoryLimit : 0, useCache ? ResultCache::defaultDiskLimit : 0);
+
     /* Creates an instance of Graph Visualisation */
-    GraphVisualisation visualisation(maze, window, visualisationSpeed);
+    GraphVisualisation visualisation(maze, window, visualisationSpeed, cache);
 
     visualisation.windowLoop();
     window.close();
 
-    return EXIT_SUCCESS;
+    return finishTrace(tracePath) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
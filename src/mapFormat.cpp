@@ -0,0 +1,155 @@
+/**
+* @file mapFormat.cpp
+* @author Ondrej
+* @brief Implementation of map writers and binary map reader
+**/
+
+#include "mapFormat.hpp"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+static const char binaryMagic[4] = {'G', 'M', 'A', 'P'};
+static const uint32_t binaryVersion = 1;
+
+/** Version with more goals, maps with one goal are still written as version 1 */
+static const uint32_t binaryGoalsVersion = 2;
+
+/** Writes 32bit number in little endian */
+static void writeU32(std::ostream &output, uint32_t value)
+{
+    char bytes[4] = {static_cast<char>(value & 0xFF), static_cast<char>((value >> 8) & 0xFF),
+                     static_cast<char>((value >> 16) & 0xFF), static_cast<char>((value >> 24) & 0xFF)};
+    output.write(bytes, 4);
+}
+
+/** Reads 32bit number in little endian, throws if the stream ended */
+static uint32_t readU32(std::istream &input)
+{
+    unsigned char bytes[4];
+    if (!input.read(reinterpret_cast<char *>(bytes), 4))
+        throw std::invalid_argument("Binary map header is truncated");
+
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+void TextMapWriter::begin(uint32_t rows, uint32_t cols, Position start, const std::vector<Position> &goals)
+{
+    m_start = start;
+    m_goals = goals;
+    m_line.resize(cols + 1);
+    m_line[cols] = '\n';
+}
+
+void TextMapWriter::writeRow(const std::vector<CellType> &row)
+{
+    static const std::array<char, 3> symbols = {'X', ' ', 'T'};
+
+    for (size_t i = 0; i < row.size(); i++)
+        m_line[i] = symbols[static_cast<int>(row[i])];
+
+    m_output.write(m_line.data(), m_line.size());
+}
+
+/** Start and goals are at the end of the text format */
+void TextMapWriter::finish(void)
+{
+    m_output << "start " << m_start.first << ", " << m_start.second << "\n";
+    for (Position goal: m_goals)
+        m_output << "end " << goal.first << ", " << goal.second << "\n";
+    m_output.flush();
+}
+
+void BinaryMapWriter::begin(uint32_t rows, uint32_t cols, Position start, const std::vector<Position> &goals)
+{
+    m_output.write(binaryMagic, 4);
+    writeU32(m_output, goals.size() > 1 ? binaryGoalsVersion : binaryVersion);
+    writeU32(m_output, cols);
+    writeU32(m_output, rows);
+    writeU32(m_output, static_cast<uint32_t>(start.first));
+    writeU32(m_output, static_cast<uint32_t>(start.second));
+    writeU32(m_output, static_cast<uint32_t>(goals.front().first));
+    writeU32(m_output, static_cast<uint32_t>(goals.front().second));
+    if (goals.size() > 1)
+    {
+        writeU32(m_output, static_cast<uint32_t>(goals.size() - 1));
+        for (size_t i = 1; i < goals.size(); i++)
+        {
+            writeU32(m_output, static_cast<uint32_t>(goals[i].first));
+            writeU32(m_output, static_cast<uint32_t>(goals[i].second));
+        }
+    }
+
+    m_packed.resize((cols + 3) / 4);
+}
+
+void BinaryMapWriter::writeRow(const std::vector<CellType> &row)
+{
+    std::fill(m_packed.begin(), m_packed.end(), 0);
+    for (size_t i = 0; i < row.size(); i++)
+        m_packed[i / 4] |= static_cast<char>(static_cast<int>(row[i]) << (2 * (i % 4)));
+
+    m_output.write(m_packed.data(), m_packed.size());
+}
+
+void BinaryMapWriter::finish(void)
+{
+    m_output.flush();
+}
+
+/** Checks magic of the stream without consuming it */
+bool isBinaryMap(std::istream &input)
+{
+    char magic[4] = {};
+    std::streampos position = input.tellg();
+    input.read(magic, 4);
+    bool binary = input.gcount() == 4 && std::equal(magic, magic + 4, binaryMagic);
+
+    input.clear();
+    input.seekg(position);
+    return binary;
+}
+
+/** Reads binary map into the grid representation Graph uses */
+void readBinaryMap(std::istream &input, MapGrid &grid, Position &start, std::vector<Position> &goals)
+{
+    char magic[4];
+    if (!input.read(magic, 4) || !std::equal(magic, magic + 4, binaryMagic))
+        throw std::invalid_argument("Not a binary map");
+
+    uint32_t version = readU32(input);
+    if (version != binaryVersion && version != binaryGoalsVersion)
+        throw std::invalid_argument("Unsupported binary map version");
+
+    uint32_t cols = readU32(input);
+    uint32_t rows = readU32(input);
+    start.first = static_cast<int32_t>(readU32(input));
+    start.second = static_cast<int32_t>(readU32(input));
+
+    /* Goals are read one by one, so damaged count ends as truncated header instead of a huge allocation */
+    uint32_t others = 0;
+    goals.assign(1, Position());
+    goals[0].first = static_cast<int32_t>(readU32(input));
+    goals[0].second = static_cast<int32_t>(readU32(input));
+    if (version == binaryGoalsVersion)
+        others = readU32(input);
+    for (uint32_t i = 0; i < others; i++)
+    {
+        Position goal;
+        goal.first = static_cast<int32_t>(readU32(input));
+        goal.second = static_cast<int32_t>(readU32(input));
+        goals.push_back(goal);
+    }
+
+    std::vector<unsigned char> packed((cols + 3) / 4);
+    grid.assign(rows, std::vector<uint8_t>(cols));
+    for (auto &row: grid)
+    {
+        if (!input.read(reinterpret_cast<char *>(packed.data()), packed.size()))
+            throw std::invalid_argument("Binary map is truncated");
+
+        for (size_t i = 0; i < cols; i++)
+            row[i] = (packed[i / 4] >> (2 * (i % 4))) & 3;
+    }
+}
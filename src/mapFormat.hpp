@@ -0,0 +1,93 @@
+/**
+* @file mapFormat.hpp
+* @author Ondrej
+* @brief Writing maps row by row in text or binary format and reading the binary format
+*
+* Binary format (all numbers little endian):
+* - 4 bytes magic "GMAP", uint32 version (1 with one goal, 2 with more)
+* - uint32 columns, uint32 rows
+* - int32 start x, start y, end x, end y
+* - version 2 only: uint32 count of the other goals, int32 x, y of each of them
+* - rows of cells, 2 bits per cell (0 - Wall, 1 - Empty, 2 - Tree), 4 cells per byte starting in lowest bits,
+*   every row is padded to whole bytes
+**/
+
+#pragma once
+
+#include "graph.hpp"
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+
+/** Same values Graph uses in its grid */
+enum class CellType : uint8_t
+{
+    Wall = 0,
+    Empty = 1,
+    Tree = 2
+};
+
+/** Receives map row by row, so the whole map never has to be in memory */
+class MapWriter
+{
+public:
+    virtual ~MapWriter() = default;
+
+    /** Called once before the first row, goals are not empty, the first one is the end of the map */
+    virtual void begin(uint32_t rows, uint32_t cols, Position start, const std::vector<Position> &goals) = 0;
+
+    /** Writes next row, row must have exactly cols cells */
+    virtual void writeRow(const std::vector<CellType> &row) = 0;
+
+    /** Called once after the last row */
+    virtual void finish(void) = 0;
+};
+
+/** Writes the text format Graph reads ('X', ' ', 'T', start line and one end line per goal) */
+class TextMapWriter : public MapWriter
+{
+public:
+    explicit TextMapWriter(std::ostream &output) : m_output(output) {};
+
+    void begin(uint32_t rows, uint32_t cols, Position start, const std::vector<Position> &goals) override;
+
+    void writeRow(const std::vector<CellType> &row) override;
+
+    void finish(void) override;
+
+private:
+    std::ostream &m_output;
+
+    Position m_start;
+    std::vector<Position> m_goals;
+
+    std::string m_line;
+};
+
+/** Writes the binary format */
+class BinaryMapWriter : public MapWriter
+{
+public:
+    explicit BinaryMapWriter(std::ostream &output) : m_output(output) {};
+
+    void begin(uint32_t rows, uint32_t cols, Position start, const std::vector<Position> &goals) override;
+
+    void writeRow(const std::vector<CellType> &row) override;
+
+    void finish(void) override;
+
+private:
+    std::ostream &m_output;
+
+    std::vector<char> m_packed;
+};
+
+/** Checks magic of the stream without consuming it */
+bool isBinaryMap(std::istream &input);
+
+/** Reads binary map into the grid representation Graph uses, goals start with the end, throws std::invalid_argument if
+    the map is malformed */
+void readBinaryMap(std::istream &input, MapGrid &grid, Position &start, std::vector<Position> &goals);
@@ -0,0 +1,398 @@
+/**
+* @file mapGenerator.cpp
+* @author Ondrej
+* @brief Implementation of synthetic map generator
+**/
+
+#include "mapGenerator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+/** Small deterministic random generator, std distributions differ between standard libraries */
+struct SplitMix64
+{
+    uint64_t state;
+
+    uint64_t next(void)
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    /** Random number in range 0, bound - 1 */
+    uint64_t below(uint64_t bound) { return next() % bound; }
+};
+
+/** Random value of a single cell, does not depend on generation order */
+static uint64_t cellHash(uint64_t seed, uint64_t x, uint64_t y)
+{
+    SplitMix64 rng{seed ^ (x * 0x9E3779B97F4A7C15ull) ^ (y * 0xC2B2AE3D27D4EB4Full)};
+    rng.next();
+    return rng.next();
+}
+
+/**
+* @brief Eller's algorithm - generates perfect maze one row of cells at a time
+* - Only the current row of sets is stored, so memory depends on width only
+**/
+class EllerMaze
+{
+public:
+    EllerMaze(size_t cells, uint64_t seed)
+        : m_rng{seed},
+          m_set(cells),
+          m_parent(cells),
+          m_count(cells),
+          m_candidate(cells),
+          m_hasDown(cells),
+          m_remap(cells),
+          m_rightOpen(cells),
+          m_downOpen(cells)
+    {
+        for (size_t i = 0; i < cells; i++)
+            m_set[i] = i;
+    };
+
+    /** Generates next row of cells, last row joins all remaining sets */
+    void nextRow(bool last);
+
+    /** Is there passage between cell i and i + 1 */
+    bool rightOpen(size_t i) const { return m_rightOpen[i]; }
+
+    /** Is there passage from cell i to the cell below */
+    bool downOpen(size_t i) const { return m_downOpen[i]; }
+
+private:
+    size_t find(size_t label);
+
+    SplitMix64 m_rng;
+
+    /** Set label of every cell in the current row, labels are always less than number of cells */
+    std::vector<size_t> m_set;
+
+    /** Union find over labels of the current row */
+    std::vector<size_t> m_parent;
+
+    std::vector<size_t> m_count;
+    std::vector<size_t> m_candidate;
+    std::vector<uint8_t> m_hasDown;
+    std::vector<size_t> m_remap;
+
+    std::vector<uint8_t> m_rightOpen;
+    std::vector<uint8_t> m_downOpen;
+};
+
+size_t EllerMaze::find(size_t label)
+{
+    while (m_parent[label] != label)
+    {
+        m_parent[label] = m_parent[m_parent[label]];
+        label = m_parent[label];
+    }
+    return label;
+}
+
+void EllerMaze::nextRow(bool last)
+{
+    size_t cells = m_set.size();
+
+    for (size_t i = 0; i < cells; i++)
+        m_parent[i] = i;
+
+    /* Randomly join adjacent cells from different sets, last row has to join all of them */
+    for (size_t i = 0; i + 1 < cells; i++)
+    {
+        size_t a = this->find(m_set[i]);
+        size_t b = this->find(m_set[i + 1]);
+        m_rightOpen[i] = a != b && (last || (m_rng.next() & 1));
+        if (m_rightOpen[i])
+            m_parent[a] = b;
+    }
+    m_rightOpen[cells - 1] = false;
+
+    if (last)
+    {
+        std::fill(m_downOpen.begin(), m_downOpen.end(), 0);
+        return;
+    }
+
+    /* Random passages down, every set needs at least one (candidate is picked uniformly from the set) */
+    std::fill(m_count.begin(), m_count.end(), 0);
+    std::fill(m_hasDown.begin(), m_hasDown.end(), 0);
+    for (size_t i = 0; i < cells; i++)
+    {
+        size_t root = this->find(m_set[i]);
+        if (m_rng.below(++m_count[root]) == 0)
+            m_candidate[root] = i;
+
+        m_downOpen[i] = m_rng.next() & 1;
+        if (m_downOpen[i])
+            m_hasDown[root] = 1;
+    }
+    for (size_t i = 0; i < cells; i++)
+    {
+        size_t root = this->find(m_set[i]);
+        if (!m_hasDown[root])
+        {
+            m_downOpen[m_candidate[root]] = 1;
+            m_hasDown[root] = 1;
+        }
+    }
+
+    /* Cells below keep set of the cell above, the rest gets new sets, labels are compacted */
+    const size_t none = cells;
+    std::fill(m_remap.begin(), m_remap.end(), none);
+    size_t nextLabel = 0;
+    for (size_t i = 0; i < cells; i++)
+    {
+        if (!m_downOpen[i])
+            continue;
+        size_t root = this->find(m_set[i]);
+        if (m_remap[root] == none)
+            m_remap[root] = nextLabel++;
+        m_count[i] = m_remap[root];
+    }
+    for (size_t i = 0; i < cells; i++)
+        m_set[i] = m_downOpen[i] ? m_count[i] : nextLabel++;
+}
+
+/** Smooth noise in range 0, 1 - bilinear interpolation of random values on lattice */
+static double valueNoise(uint64_t seed, double x, double y)
+{
+    double fx = std::floor(x);
+    double fy = std::floor(y);
+    uint64_t ix = static_cast<uint64_t>(fx);
+    uint64_t iy = static_cast<uint64_t>(fy);
+
+    auto lattice = [seed](uint64_t lx, uint64_t ly) { return (cellHash(seed, lx, ly) >> 11) * (1.0 / 9007199254740992.0); };
+    auto smooth = [](double t) { return t * t * (3 - 2 * t); };
+
+    double tx = smooth(x - fx);
+    double ty = smooth(y - fy);
+    double top = lattice(ix, iy) * (1 - tx) + lattice(ix + 1, iy) * tx;
+    double bottom = lattice(ix, iy + 1) * (1 - tx) + lattice(ix + 1, iy + 1) * tx;
+
+    return top * (1 - ty) + bottom * ty;
+}
+
+/** Three octaves of value noise */
+static double terrainNoise(uint64_t seed, uint32_t x, uint32_t y)
+{
+    double value = 0.0;
+    double amplitude = 0.5;
+    double scale = 1.0 / 48;
+    for (int octave = 0; octave < 3; octave++)
+    {
+        value += amplitude * valueNoise(seed + octave, x * scale, y * scale);
+        amplitude /= 2;
+        scale *= 2;
+    }
+    return value / 0.875;
+}
+
+/**
+* @brief Frees the cells of row y on a 4-connected staircase from start to end, so the two are always connected
+* - Start is the top left and end the bottom right end, the staircase follows the line between them and every row
+*   holds the cells from its column to the column of the next row
+**/
+static void carveRoad(std::vector<CellType> &row, uint32_t y, Position start, Position end)
+{
+    int64_t top = start.second;
+    int64_t bottom = end.second;
+    int64_t line = y;
+    if (line < top || line > bottom)
+        return;
+
+    auto column = [&](int64_t at) { return bottom == top ? end.first : start.first + (at - top) * (end.first - start.first) / (bottom - top); };
+    int64_t from = bottom == top ? start.first : column(line);
+    int64_t to = line < bottom ? column(line + 1) : end.first;
+    std::fill(row.begin() + from, row.begin() + to + 1, CellType::Empty);
+}
+
+/**
+* @brief Maze and rooms share the same layout - cells of given size separated by walls of width 1
+* - Maze removes the whole wall between connected cells
+* - Rooms put a door of width 1 into the wall and add extra doors so there are loops
+**/
+static void generateCellular(const GeneratorOptions &options, uint32_t cellSize, bool rooms, MapWriter &writer)
+{
+    uint32_t pitch = cellSize + 1;
+    size_t cellCols = (options.cols - 1) / pitch;
+    size_t cellRows = (options.rows - 1) / pitch;
+    if (cellCols == 0 || cellRows == 0)
+        throw std::invalid_argument("Map is too small for given corridor/room size");
+    if (cellCols == 1 && cellRows == 1 && cellSize == 1)
+        throw std::invalid_argument("Map is too small, start and end would be the same cell");
+
+    Position start(1, 1);
+    Position end(static_cast<int>((cellCols - 1) * pitch + cellSize), static_cast<int>((cellRows - 1) * pitch + cellSize));
+    writer.begin(options.rows, options.cols, start, {end});
+
+    EllerMaze maze(cellCols, options.seed);
+    SplitMix64 doorRng{options.seed ^ 0xD00Dull};
+    std::vector<CellType> row(options.cols, CellType::Wall);
+
+    /* Door offsets of the wall column to the right of every cell, chosen once per row of cells */
+    std::vector<int64_t> rightDoor(cellCols);
+
+    /* First row is wall */
+    writer.writeRow(row);
+
+    uint32_t written = 1;
+    for (size_t cellRow = 0; cellRow < cellRows; cellRow++)
+    {
+        maze.nextRow(cellRow + 1 == cellRows);
+
+        for (size_t i = 0; i < cellCols; i++)
+        {
+            bool open = maze.rightOpen(i) || (rooms && i + 1 < cellCols && doorRng.below(2) == 0);
+            if (!open)
+                rightDoor[i] = -1;
+            else
+                rightDoor[i] = rooms ? static_cast<int64_t>(doorRng.below(cellSize)) : cellSize;
+        }
+
+        /* Inside of the cells */
+        for (uint32_t line = 0; line < cellSize; line++)
+        {
+            std::fill(row.begin(), row.end(), CellType::Wall);
+            for (size_t i = 0; i < cellCols; i++)
+            {
+                size_t x = 1 + i * pitch;
+                std::fill(row.begin() + x, row.begin() + x + cellSize, CellType::Empty);
+                if (rightDoor[i] == cellSize || rightDoor[i] == line)
+                    row[x + cellSize] = CellType::Empty;
+            }
+            writer.writeRow(row);
+        }
+
+        /* Wall below the cells */
+        std::fill(row.begin(), row.end(), CellType::Wall);
+        for (size_t i = 0; i < cellCols && cellRow + 1 < cellRows; i++)
+        {
+            bool open = maze.downOpen(i) || (rooms && doorRng.below(2) == 0);
+            if (!open)
+                continue;
+
+            size_t x = 1 + i * pitch;
+            if (rooms)
+                row[x + doorRng.below(cellSize)] = CellType::Empty;
+            else
+                std::fill(row.begin() + x, row.begin() + x + cellSize, CellType::Empty);
+        }
+        writer.writeRow(row);
+        written += pitch;
+    }
+
+    /* Rows that do not fit another row of cells */
+    std::fill(row.begin(), row.end(), CellType::Wall);
+    for (; written < options.rows; written++)
+        writer.writeRow(row);
+
+    writer.finish();
+}
+
+/** Random obstacles, each cell is wall with probability density / 100, a road keeps start and end connected */
+static void generateRandom(const GeneratorOptions &options, MapWriter &writer)
+{
+    Position start(1, 1);
+    Position end(static_cast<int>(options.cols) - 2, static_cast<int>(options.rows) - 2);
+    writer.begin(options.rows, options.cols, start, {end});
+
+    std::vector<CellType> row(options.cols);
+    for (uint32_t y = 0; y < options.rows; y++)
+    {
+        for (uint32_t x = 0; x < options.cols; x++)
+            row[x] = cellHash(options.seed, x, y) % 100 < options.density ? CellType::Wall : CellType::Empty;
+        carveRoad(row, y, start, end);
+
+        writer.writeRow(row);
+    }
+    writer.finish();
+}
+
+/** Terrain - high noise values are walls, surrounded by a band of trees, a road keeps start and end connected */
+static void generateTerrain(const GeneratorOptions &options, MapWriter &writer)
+{
+    const double wallLevel = 0.66;
+    const double treeLevel = 0.58;
+
+    Position start(1, 1);
+    Position end(static_cast<int>(options.cols) - 2, static_cast<int>(options.rows) - 2);
+    writer.begin(options.rows, options.cols, start, {end});
+
+    std::vector<CellType> row(options.cols);
+    for (uint32_t y = 0; y < options.rows; y++)
+    {
+        for (uint32_t x = 0; x < options.cols; x++)
+        {
+            double value = terrainNoise(options.seed, x, y);
+            if (value > wallLevel)
+                row[x] = CellType::Wall;
+            else if (value > treeLevel)
+                row[x] = CellType::Tree;
+            else
+                row[x] = CellType::Empty;
+        }
+        carveRoad(row, y, start, end);
+
+        writer.writeRow(row);
+    }
+    writer.finish();
+}
+
+/** Converts string to map family */
+bool strToMapFamily(std::string str, MapFamily &family)
+{
+    std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return std::tolower(c); });
+
+    if (str == "maze")
+        family = MapFamily::Maze;
+    else if (str == "random")
+        family = MapFamily::Random;
+    else if (str == "rooms")
+        family = MapFamily::Rooms;
+    else if (str == "terrain")
+        family = MapFamily::Terrain;
+    else
+        return false;
+
+    return true;
+}
+
+/** Generates the map into the writer */
+void generateMap(const GeneratorOptions &options, MapWriter &writer)
+{
+    if (options.rows < 3 || options.cols < 3 || options.rows > maxGeneratedSize || options.cols > maxGeneratedSize)
+        throw std::invalid_argument("Map size has to be between 3 and 100000");
+    /* Random and terrain maps start at (1, 1) and end at (cols - 2, rows - 2) */
+    bool cornerEndpoints = options.family == MapFamily::Random || options.family == MapFamily::Terrain;
+    if (cornerEndpoints && options.rows == 3 && options.cols == 3)
+        throw std::invalid_argument("Map is too small, start and end would be the same cell");
+
+    switch (options.family)
+    {
+        case MapFamily::Maze:
+            if (options.corridorWidth == 0)
+                throw std::invalid_argument("Corridor width has to be at least 1");
+            generateCellular(options, options.corridorWidth, false, writer);
+            break;
+        case MapFamily::Rooms:
+            if (options.roomSize < 2)
+                throw std::invalid_argument("Room size has to be at least 2");
+            generateCellular(options, options.roomSize - 1, true, writer);
+            break;
+        case MapFamily::Random:
+            if (options.density > 100)
+                throw std::invalid_argument("Density has to be in range 0 - 100");
+            generateRandom(options, writer);
+            break;
+        case MapFamily::Terrain:
+            generateTerrain(options, writer);
+            break;
+    }
+}
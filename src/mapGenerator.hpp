@@ -0,0 +1,56 @@
+/**
+* @file mapGenerator.hpp
+* @author Ondrej
+* @brief Deterministic generator of synthetic maps in the same families as the dataset
+*
+* Maps are generated row by row and passed to MapWriter, memory usage depends only on the number of columns,
+* so maps up to 100000 x 100000 can be generated.
+**/
+
+#pragma once
+
+#include "mapFormat.hpp"
+
+#include <cstdint>
+#include <string>
+
+
+/** Map families, same as in the dataset */
+enum class MapFamily
+{
+    /** Perfect maze with configurable corridor width (maze512-<w>-*) */
+    Maze,
+    /** Random obstacles with given density in percent (random512-<pct>-*) */
+    Random,
+    /** Grid of square rooms connected by doors (*room_*) */
+    Rooms,
+    /** Smooth terrain with walls surrounded by trees (lak303d) */
+    Terrain
+};
+
+/** Parameters of generated map */
+struct GeneratorOptions
+{
+    MapFamily family = MapFamily::Maze;
+    uint32_t rows = 512;
+    uint32_t cols = 512;
+    uint64_t seed = 0;
+
+    /** Maze - width of corridors */
+    uint32_t corridorWidth = 1;
+
+    /** Random - obstacle density in percent */
+    uint32_t density = 10;
+
+    /** Rooms - distance between room walls (room interior is one less) */
+    uint32_t roomSize = 8;
+};
+
+/** Largest supported number of rows/columns */
+const uint32_t maxGeneratedSize = 100000;
+
+/** Converts string to map family, returns false if there is no such family */
+bool strToMapFamily(std::string str, MapFamily &family);
+
+/** Generates the map into the writer, throws std::invalid_argument if the options are invalid */
+void generateMap(const GeneratorOptions &options, MapWriter &writer);
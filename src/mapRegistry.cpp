@@ -0,0 +1,174 @@
+/**
+* @file mapRegistry.cpp
+* @author Ondrej
+* @brief Implementation of MapRegistry
+**/
+
+#include "mapRegistry.hpp"
+#include "threadPool.hpp"
+
+#include <filesystem>
+#include <future>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+/** Hash of cells, start and goals, maps differing only in start or goals are different maps */
+static uint64_t contentHash(const GridMap &map)
+{
+    uint64_t hash = map.hash();
+    auto add = [&hash](int value) {
+        hash ^= static_cast<uint32_t>(value);
+        hash *= 1099511628211ull;
+    };
+
+    add(map.start().first);
+    add(map.start().second);
+    for (Position goal: map.goals())
+    {
+        add(goal.first);
+        add(goal.second);
+    }
+    return hash;
+}
+
+static bool sameContent(const GridMap &a, const GridMap &b)
+{
+    return a.start() == b.start() && a.goals() == b.goals() && a.grid() == b.grid();
+}
+
+bool MapRegistry::add(const std::string &name, const std::string &path)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_entries.count(name))
+        return false;
+
+    auto entry = std::make_unique<Entry>();
+    entry->path = path;
+    m_entries[name] = std::move(entry);
+    return true;
+}
+
+size_t MapRegistry::addDirectory(const std::string &directory)
+{
+    size_t added = 0;
+    for (const auto &file: fs::directory_iterator(directory))
+    {
+        if (file.is_regular_file() && this->add(file.path().filename().string(), file.path().string()))
+            added++;
+    }
+    return added;
+}
+
+std::vector<std::string> MapRegistry::loadAll(void)
+{
+    std::vector<std::string> errors;
+    std::vector<std::pair<std::string, std::future<void>>> loads;
+    {
+        ThreadPool pool(m_threads);
+        for (const std::string &name: this->names())
+        {
+            Entry *entry = this->find(name);
+            loads.push_back({name, pool.submit([this, name, entry]() { this->load(name, *entry); })});
+        }
+
+        for (auto &[name, load]: loads)
+        {
+            try
+            {
+                load.get();
+            }
+            catch (const std::exception &error)
+            {
+                errors.push_back(name + ": " + error.what());
+            }
+        }
+    }
+    return errors;
+}
+
+std::shared_ptr<const GridMap> MapRegistry::get(const std::string &name)
+{
+    Entry *entry = this->find(name);
+    return entry ? this->load(name, *entry) : nullptr;
+}
+
+bool MapRegistry::contains(const std::string &name) const
+{
+    return this->find(name) != nullptr;
+}
+
+std::vector<std::string> MapRegistry::names(void) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<std::string> names;
+    for (const auto &[name, entry]: m_entries)
+        names.push_back(name);
+    return names;
+}
+
+std::vector<MapUsage> MapRegistry::usage(void) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<MapUsage> usage;
+    for (const auto &[name, entry]: m_entries)
+    {
+        MapUsage map;
+        map.name = name;
+        map.path = entry->path;
+        map.loaded = entry->map != nullptr;
+        map.duplicateOf = entry->duplicateOf;
+        if (map.loaded && map.duplicateOf.empty())
+            map.bytes = entry->map->bytes();
+        usage.push_back(map);
+    }
+    return usage;
+}
+
+size_t MapRegistry::bytes(void) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t bytes = 0;
+    for (const auto &[hash, maps]: m_byContent)
+    {
+        for (const auto &[name, map]: maps)
+            bytes += map->bytes();
+    }
+    return bytes;
+}
+
+std::shared_ptr<const GridMap> MapRegistry::load(const std::string &name, Entry &entry)
+{
+    std::lock_guard<std::mutex> loading(entry.loading);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (entry.map)
+            return entry.map;
+    }
+
+    /* Parsing runs outside of the registry lock, other maps load at the same time */
+    std::shared_ptr<const GridMap> map = GridMap::load(entry.path);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto &candidates = m_byContent[contentHash(*map)];
+    for (const auto &[first, loaded]: candidates)
+    {
+        if (sameContent(*loaded, *map))
+        {
+            entry.map = loaded;
+            entry.duplicateOf = first;
+            return loaded;
+        }
+    }
+
+    candidates.push_back({name, map});
+    entry.map = map;
+    return map;
+}
+
+MapRegistry::Entry *MapRegistry::find(const std::string &name) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto found = m_entries.find(name);
+    return found == m_entries.end() ? nullptr : found->second.get();
+}
@@ -0,0 +1,95 @@
+/**
+* @file mapRegistry.hpp
+* @author Ondrej
+* @brief Maps registered by name, loaded on first access or all at once in parallel, identical maps are kept once
+**/
+
+#pragma once
+
+#include "gridMap.hpp"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+/** Memory report of one registered map */
+struct MapUsage
+{
+    std::string name;
+    std::string path;
+    bool loaded = false;
+    /** Memory of the map, 0 if it is not loaded or it is a duplicate */
+    size_t bytes = 0;
+    /** Name of the map with the same content whose memory this one shares, empty if none */
+    std::string duplicateOf;
+};
+
+/**
+* @brief Registry of maps shared by the tools
+* - Registering does not read the file, the map is loaded by the first get or by loadAll
+* - Maps with the same cells, start and goals (content hash, then full comparison) share one GridMap
+* - Methods may be called from any thread, one map is loaded only once even when requested by more threads
+**/
+class MapRegistry
+{
+public:
+    /** Threads used by loadAll, 0 means one per hardware thread */
+    explicit MapRegistry(size_t threads = 0) : m_threads(threads) {};
+
+    MapRegistry(const MapRegistry &) = delete;
+    MapRegistry &operator=(const MapRegistry &) = delete;
+
+    /** Registers file under name, false if the name is already registered */
+    bool add(const std::string &name, const std::string &path);
+
+    /** Registers every regular file of the directory under its file name, returns number of newly registered maps */
+    size_t addDirectory(const std::string &directory);
+
+    /** Loads every registered map that is not loaded yet on a thread pool, returns messages of maps that failed */
+    std::vector<std::string> loadAll(void);
+
+    /** Map of the name, loaded on first access, nullptr for unknown name, throws std::invalid_argument if it cannot be loaded */
+    std::shared_ptr<const GridMap> get(const std::string &name);
+
+    bool contains(const std::string &name) const;
+
+    /** Registered names in alphabetical order */
+    std::vector<std::string> names(void) const;
+
+    /** Report of every registered map in alphabetical order */
+    std::vector<MapUsage> usage(void) const;
+
+    /** Memory of all loaded maps, duplicates are counted once */
+    size_t bytes(void) const;
+
+private:
+    struct Entry
+    {
+        std::string path;
+        /** Held while the file is loaded, so other threads wait for it instead of loading it again */
+        std::mutex loading;
+        /** Guarded by m_mutex */
+        std::shared_ptr<const GridMap> map;
+        std::string duplicateOf;
+    };
+
+    /** Loads the map of the entry unless it is loaded, replaces it with an already loaded map of the same content */
+    std::shared_ptr<const GridMap> load(const std::string &name, Entry &entry);
+
+    Entry *find(const std::string &name) const;
+
+    size_t m_threads;
+
+    /** Guards everything below and maps of the entries */
+    mutable std::mutex m_mutex;
+
+    /** Entries are never removed, so pointers to them stay valid */
+    std::map<std::string, std::unique_ptr<Entry>> m_entries;
+
+    /** Loaded distinct maps by content hash, with the name they were loaded under */
+    std::unordered_map<uint64_t, std::vector<std::pair<std::string, std::shared_ptr<const GridMap>>>> m_byContent;
+};
@@ -0,0 +1,128 @@
+/**
+* @file multiGoal.cpp
+* @author Ondrej
+* @brief Implementation of GoalIndex
+**/
+
+#include "multiGoal.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+/** Smallest tile, with few goals tiles grow to cover the map with about one goal per tile */
+static const int minTileSize = 8;
+
+GoalIndex::GoalIndex(uint32_t width, uint32_t height, const std::vector<Position> &goals)
+{
+    for (Position goal: goals)
+    {
+        if (goal.first >= 0 && goal.second >= 0 && goal.first < static_cast<int>(width) && goal.second < static_cast<int>(height))
+            m_goals.push_back(goal);
+    }
+    std::sort(m_goals.begin(), m_goals.end());
+    m_goals.erase(std::unique(m_goals.begin(), m_goals.end()), m_goals.end());
+    if (m_goals.empty())
+        return;
+
+    double area = static_cast<double>(width) * height;
+    int side = static_cast<int>(std::max(width, height));
+    m_tileSize = std::clamp(static_cast<int>(std::sqrt(area / m_goals.size())), std::min(minTileSize, side), side);
+    m_tilesX = (static_cast<int>(width) + m_tileSize - 1) / m_tileSize;
+    m_tilesY = (static_cast<int>(height) + m_tileSize - 1) / m_tileSize;
+
+    /* Counting sort of the goals by tile */
+    size_t tiles = static_cast<size_t>(m_tilesX) * m_tilesY;
+    m_offsets.assign(tiles + 1, 0);
+    for (Position goal: m_goals)
+        m_offsets[this->tile(goal.first, goal.second) + 1]++;
+    for (size_t t = 0; t < tiles; t++)
+        m_offsets[t + 1] += m_offsets[t];
+
+    m_entries.resize(m_goals.size());
+    m_tileRemaining.assign(tiles, 0);
+    for (uint32_t goal = 0; goal < m_goals.size(); goal++)
+    {
+        uint32_t t = this->tile(m_goals[goal].first, m_goals[goal].second);
+        m_entries[m_offsets[t] + m_tileRemaining[t]++] = goal;
+    }
+
+    m_removed.assign(m_goals.size(), 0);
+    m_remaining = m_goals.size();
+}
+
+uint32_t GoalIndex::find(int x, int y) const
+{
+    if (m_remaining == 0 || x < 0 || y < 0 || x >= m_tilesX * m_tileSize || y >= m_tilesY * m_tileSize)
+        return none;
+
+    uint32_t t = this->tile(x, y);
+    if (m_tileRemaining[t] == 0)
+        return none;
+    for (uint32_t i = m_offsets[t]; i < m_offsets[t + 1]; i++)
+    {
+        uint32_t goal = m_entries[i];
+        if (!m_removed[goal] && m_goals[goal] == Position(x, y))
+            return goal;
+    }
+    return none;
+}
+
+void GoalIndex::remove(uint32_t goal)
+{
+    if (m_removed[goal])
+        return;
+    m_removed[goal] = 1;
+    m_tileRemaining[this->tile(m_goals[goal].first, m_goals[goal].second)]--;
+    m_remaining--;
+}
+
+/** Tiles at Chebyshev distance r (in tiles) from the tile of the cell are at least (r - 1) * tileSize + 1 cells away,
+    rings stop when that bound cannot beat the best goal */
+int GoalIndex::distance(int x, int y) const
+{
+    if (m_remaining == 0)
+        return unreachable;
+
+    int tileX = x / m_tileSize;
+    int tileY = y / m_tileSize;
+    int best = unreachable;
+
+    auto scan = [&](int tx, int ty) {
+        if (tx < 0 || ty < 0 || tx >= m_tilesX || ty >= m_tilesY)
+            return;
+        uint32_t t = static_cast<uint32_t>(ty) * m_tilesX + static_cast<uint32_t>(tx);
+        if (m_tileRemaining[t] == 0)
+            return;
+        for (uint32_t i = m_offsets[t]; i < m_offsets[t + 1]; i++)
+        {
+            uint32_t goal = m_entries[i];
+            if (!m_removed[goal])
+                best = std::min(best, std::abs(m_goals[goal].first - x) + std::abs(m_goals[goal].second - y));
+        }
+    };
+
+    int rings = std::max(m_tilesX, m_tilesY);
+    for (int ring = 0; ring < rings; ring++)
+    {
+        if (ring > 0 && (ring - 1) * m_tileSize + 1 >= best)
+            break;
+        if (ring == 0)
+        {
+            scan(tileX, tileY);
+            continue;
+        }
+
+        for (int tx = tileX - ring; tx <= tileX + ring; tx++)
+        {
+            scan(tx, tileY - ring);
+            scan(tx, tileY + ring);
+        }
+        for (int ty = tileY - ring + 1; ty <= tileY + ring - 1; ty++)
+        {
+            scan(tileX - ring, ty);
+            scan(tileX + ring, ty);
+        }
+    }
+    return best;
+}
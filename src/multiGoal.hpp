@@ -0,0 +1,277 @@
+/**
+* @file multiGoal.hpp
+* @author Ondrej
+* @brief Nearest k of many goals and their paths found by one search from the start
+*
+* BFS stops after it has reached k goals, with unit costs a goal is final when it is reached. A* uses the distance to
+* the nearest goal that has not been found yet, it is a minimum of Manhattan distances, so it stays admissible and
+* consistent and goals are expanded in the order of their distances. The minimum is taken from GoalIndex, goals bucketed
+* in tiles that are searched in rings around the cell, so the heuristic does not cost O(goals) per cell.
+**/
+
+#pragma once
+
+#include "searchKernel.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+
+/** Goal found by the multi-goal search */
+struct GoalPath
+{
+    Position goal;
+    double cost = 0.0;
+    /** From start to goal */
+    std::vector<Position> path;
+};
+
+/**
+* @brief Goals of one search bucketed in square tiles (about one goal per tile), found goals are removed
+* - Goals outside the grid are dropped, duplicates are kept once
+**/
+class GoalIndex
+{
+public:
+    static constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+
+    /** Distance when no goal is left */
+    static constexpr int unreachable = std::numeric_limits<int>::max();
+
+    GoalIndex(uint32_t width, uint32_t height, const std::vector<Position> &goals);
+
+    /** Goals that were not removed */
+    size_t remaining(void) const { return m_remaining; }
+
+    Position goal(uint32_t goal) const { return m_goals[goal]; }
+
+    /** Goal at (x, y) that was not removed, none otherwise */
+    uint32_t find(int x, int y) const;
+
+    void remove(uint32_t goal);
+
+    /** L1 distance from (x, y) inside the grid to the nearest goal that was not removed, unreachable if there is none */
+    int distance(int x, int y) const;
+
+private:
+    uint32_t tile(int x, int y) const { return static_cast<uint32_t>(y / m_tileSize) * m_tilesX + static_cast<uint32_t>(x / m_tileSize); }
+
+    int m_tileSize = 1;
+
+    int m_tilesX = 0;
+
+    int m_tilesY = 0;
+
+    std::vector<Position> m_goals;
+
+    /** Goals of tile t are m_entries[m_offsets[t]] .. m_entries[m_offsets[t + 1] - 1] */
+    std::vector<uint32_t> m_offsets;
+
+    std::vector<uint32_t> m_entries;
+
+    /** Goals of the tile that were not removed, empty tiles are skipped */
+    std::vector<uint32_t> m_tileRemaining;
+
+    std::vector<uint8_t> m_removed;
+
+    size_t m_remaining = 0;
+};
+
+/** Distance to the nearest goal that has not been found, it only grows as goals are removed */
+class NearestGoalHeuristic
+{
+public:
+    explicit NearestGoalHeuristic(const GoalIndex &goals) : m_goals(goals) {};
+
+    double operator()(int x, int y) const { return m_goals.remaining() ? m_goals.distance(x, y) : 0.0; }
+
+private:
+    const GoalIndex &m_goals;
+};
+
+/**
+* @brief Search from start (4-connected, unit costs) until k goals are found or no cell is left
+* - Informed false is BFS, a goal is final when it is reached; Informed true is A* with NearestGoalHeuristic, a goal is
+*   final when it is expanded, then the heuristic grows and the open list is re-keyed, so the search is no longer pulled
+*   towards the found goal
+* - Found goals (if not nullptr) are ordered from the nearest, goal at the start is found with cost 0 and path of one
+*   position; stats.found is set if any goal was found and stats.cost is the cost of the nearest one
+* - Trace receives visited and opened positions as from searchKernel, found goals that do not end the search are opened
+**/
+template <bool Informed, typename Trace, typename Grid>
+KernelStats nearestGoalsKernel(const Grid &grid, SearchWorkspace &work, Trace &trace, Position start, GoalIndex &goals, size_t k,
+                               std::vector<GoalPath> *found)
+{
+    KernelStats stats;
+    if (found)
+        found->clear();
+    if (!grid.inside(start.first, start.second) || k == 0 || goals.remaining() == 0)
+        return stats;
+
+    work.prepare(grid.size());
+    uint32_t startCell = grid.index(start.first, start.second);
+    size_t reached = 0;
+    bool done = false;
+
+    auto visit = [&](Position pos) {
+        stats.visited++;
+        if constexpr (Trace::enabled)
+            trace.visited(pos);
+    };
+
+    /* Returns whether pos is a goal, done is set with the k-th goal or the last one */
+    auto reachGoal = [&](Position pos, double cost) {
+        uint32_t goal = goals.find(pos.first, pos.second);
+        if (goal == GoalIndex::none)
+            return false;
+
+        goals.remove(goal);
+        if (found)
+            found->push_back(GoalPath{pos, cost, {}});
+        if (reached++ == 0)
+            stats.cost = cost;
+        stats.found = true;
+        done = reached == k || goals.remaining() == 0;
+        return true;
+    };
+
+    if constexpr (!Informed)
+    {
+        FifoOpen open(work);
+        work.reach(startCell, 0.0, startCell);
+        open.push(startCell, 0.0, 0.0);
+        visit(start);
+        reachGoal(start, 0.0);
+
+        while (!open.empty() && !done)
+        {
+            if constexpr (Trace::enabled)
+            {
+                if (trace.cancelled())
+                    break;
+            }
+
+            uint32_t cell = open.pop();
+            Position pos = grid.position(cell);
+            stats.expanded++;
+
+            double g = work.g(cell);
+            FourConnected::forEach(grid, pos.first, pos.second, [&](int x, int y, double cost) {
+                uint32_t next = grid.index(x, y);
+                if (done || work.seen(next))
+                    return;
+
+                work.reach(next, g + cost, cell);
+                open.push(next, g + cost, 0.0);
+                visit(Position(x, y));
+                if (reachGoal(Position(x, y), g + cost) && done)
+                    return;
+
+                stats.opened++;
+                if constexpr (Trace::enabled)
+                    trace.opened(pos, Position(x, y));
+            });
+        }
+    }
+    else
+    {
+        NearestGoalHeuristic heuristic(goals);
+        std::pmr::vector<SearchWorkspace::HeapEntry> &heap = work.heap();
+        heap.clear();
+        uint64_t order = 0;
+
+        /* Same order as BestFirstOpen, equal keys are popped first in first out */
+        auto later = [](const SearchWorkspace::HeapEntry &a, const SearchWorkspace::HeapEntry &b) {
+            return a.key > b.key || (a.key == b.key && a.order > b.order);
+        };
+        auto push = [&](uint32_t cell, double g, int x, int y) {
+            heap.push_back({g + heuristic(x, y), order++, cell});
+            std::push_heap(heap.begin(), heap.end(), later);
+        };
+
+        work.reach(startCell, 0.0, startCell);
+        push(startCell, 0.0, start.first, start.second);
+
+        while (!heap.empty() && !done)
+        {
+            if constexpr (Trace::enabled)
+            {
+                if (trace.cancelled())
+                    break;
+            }
+
+            std::pop_heap(heap.begin(), heap.end(), later);
+            uint32_t cell = heap.back().cell;
+            heap.pop_back();
+
+            /* Cell may be in the open list more times, it is expanded only once */
+            if (work.closed(cell))
+                continue;
+            work.close(cell);
+
+            Position pos = grid.position(cell);
+            double g = work.g(cell);
+            visit(pos);
+            if (reachGoal(pos, g))
+            {
+                if (done)
+                    break;
+
+                /* Keys only grow, older entries of a cell get its current (lowest) g, such entries are skipped once the
+                   cell is closed */
+                for (auto &entry: heap)
+                {
+                    Position open = grid.position(entry.cell);
+                    entry.key = work.g(entry.cell) + heuristic(open.first, open.second);
+                }
+                std::make_heap(heap.begin(), heap.end(), later);
+            }
+            stats.expanded++;
+
+            FourConnected::forEach(grid, pos.first, pos.second, [&](int x, int y, double cost) {
+                uint32_t next = grid.index(x, y);
+                double nextG = g + cost;
+                if (work.closed(next) || (work.seen(next) && nextG >= work.g(next)))
+                    return;
+
+                work.reach(next, nextG, cell);
+                push(next, nextG, x, y);
+                stats.opened++;
+                if constexpr (Trace::enabled)
+                    trace.opened(pos, Position(x, y));
+            });
+        }
+    }
+
+    /* Parents of reached (BFS) and expanded (A*) cells never change, so paths are read after the search */
+    if (found)
+    {
+        for (GoalPath &target: *found)
+        {
+            for (uint32_t cell = grid.index(target.goal.first, target.goal.second); cell != startCell; cell = work.parent(cell))
+                target.path.push_back(grid.position(cell));
+            target.path.push_back(start);
+            std::reverse(target.path.begin(), target.path.end());
+        }
+    }
+
+    return stats;
+}
+
+/** Nearest k goals by BFS or A* (the other algorithms do not find nearest goals, they return no goals), found is ordered
+    from the nearest goal */
+template <typename Trace, typename Grid>
+KernelStats runNearestGoals(SearchAlgorithmType algoType, const Grid &grid, SearchWorkspace &work, Trace &trace, Position start,
+                            const std::vector<Position> &goals, size_t k, std::vector<GoalPath> *found)
+{
+    GoalIndex index(grid.width(), grid.height(), goals);
+    if (algoType == SearchAlgorithmType::BFS)
+        return nearestGoalsKernel<false>(grid, work, trace, start, index, k, found);
+    if (algoType == SearchAlgorithmType::AStar)
+        return nearestGoalsKernel<true>(grid, work, trace, start, index, k, found);
+
+    if (found)
+        found->clear();
+    return KernelStats();
+}
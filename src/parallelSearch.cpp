@@ -0,0 +1,295 @@
+/**
+* @file parallelSearch.cpp
+* @author Ondrej
+* @brief Implementation of ParallelAStar
+**/
+
+#include "parallelSearch.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <thread>
+
+/** Heap order, the top is the lowest f and among equal f the highest g (the deepest node, closest to the goal) */
+static bool worse(double fa, double ga, double fb, double gb)
+{
+    return fa > fb || (fa == fb && ga < gb);
+}
+
+ParallelAStar::ParallelAStar(size_t threads)
+{
+    if (threads == 0)
+        threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    m_threads = threads;
+
+    m_workers = std::vector<Worker>(m_threads);
+    for (auto &worker: m_workers)
+    {
+        worker.outboxes.resize(m_threads);
+        worker.sent.assign(m_threads, 0);
+    }
+
+    /* Mailboxes from a thread to itself are never used */
+    m_mailboxes.resize(m_threads * m_threads);
+    for (size_t from = 0; from < m_threads; from++)
+    {
+        for (size_t to = 0; to < m_threads; to++)
+        {
+            if (from != to)
+                m_mailboxes[from * m_threads + to] = std::make_unique<SpscQueue<Message>>(mailboxCapacity);
+        }
+    }
+}
+
+size_t ParallelAStar::messages(void) const
+{
+    size_t messages = 0;
+    for (const auto &worker: m_workers)
+        messages += worker.messages;
+    return messages;
+}
+
+std::vector<size_t> ParallelAStar::expandedPerThread(void) const
+{
+    std::vector<size_t> expanded;
+    for (const auto &worker: m_workers)
+        expanded.push_back(worker.expanded);
+    return expanded;
+}
+
+double ParallelAStar::heuristic(uint32_t cell) const
+{
+    Position pos = m_grid->position(cell);
+    return std::abs(pos.first - m_goal.first) + std::abs(pos.second - m_goal.second);
+}
+
+void ParallelAStar::improveIncumbent(double cost)
+{
+    double current = m_incumbent.load();
+    while (cost < current && !m_incumbent.compare_exchange_weak(current, cost))
+        ;
+}
+
+void ParallelAStar::receive(Worker &worker, const Message &message)
+{
+    uint32_t cell = message.cell;
+    double f = message.g + this->heuristic(cell);
+    if (f >= m_incumbent.load(std::memory_order_relaxed))
+        return;
+    if (m_stamp[cell] == m_generation && message.g >= m_g[cell])
+        return;
+
+    m_stamp[cell] = m_generation;
+    m_g[cell] = message.g;
+    m_parent[cell] = message.parent;
+    worker.opened++;
+
+    /* Goal is never expanded, reaching it can only end paths through it */
+    if (cell == m_goalCell)
+    {
+        this->improveIncumbent(message.g);
+        return;
+    }
+
+    worker.open.push_back({f, message.g, cell});
+    std::push_heap(worker.open.begin(), worker.open.end(), [](const OpenEntry &a, const OpenEntry &b) { return worse(a.f, a.g, b.f, b.g); });
+}
+
+bool ParallelAStar::expandNext(Worker &worker, size_t id)
+{
+    auto order = [](const OpenEntry &a, const OpenEntry &b) { return worse(a.f, a.g, b.f, b.g); };
+    const SearchGrid &grid = *m_grid;
+
+    while (!worker.open.empty())
+    {
+        std::pop_heap(worker.open.begin(), worker.open.end(), order);
+        OpenEntry entry = worker.open.back();
+        worker.open.pop_back();
+
+        /* Entries of cells reached more cheaply since they were pushed are skipped, so are the ones the incumbent beats */
+        if (entry.g > m_g[entry.cell] || entry.f >= m_incumbent.load(std::memory_order_relaxed))
+            continue;
+
+        worker.expanded++;
+        Position pos = grid.position(entry.cell);
+        uint32_t parent = m_parent[entry.cell];
+        double incumbent = m_incumbent.load(std::memory_order_relaxed);
+        FourConnected::forEach(grid, pos.first, pos.second, [&](int x, int y, double cost) {
+            uint32_t next = grid.index(x, y);
+            Message message{next, entry.cell, entry.g + cost};
+
+            /* Parent is already cheaper, nodes that cannot beat the incumbent are not worth sending */
+            if (next == parent || message.g + std::abs(x - m_goal.first) + std::abs(y - m_goal.second) >= incumbent)
+                return;
+
+            uint32_t to = this->owner(x, y);
+            if (to == id)
+            {
+                this->receive(worker, message);
+                return;
+            }
+            worker.outboxes[to].push_back(message);
+            worker.unannounced++;
+            worker.messages++;
+        });
+        return true;
+    }
+    return false;
+}
+
+bool ParallelAStar::flush(Worker &worker, size_t id)
+{
+    /* Nodes are counted before the receiver can take them, so the counter cannot reach zero while they are in flight */
+    if (worker.unannounced > 0)
+    {
+        m_pending.fetch_add(worker.unannounced);
+        worker.unannounced = 0;
+    }
+
+    bool flushed = true;
+    for (size_t to = 0; to < m_threads; to++)
+    {
+        std::vector<Message> &outbox = worker.outboxes[to];
+        size_t &sent = worker.sent[to];
+        if (outbox.empty())
+            continue;
+
+        SpscQueue<Message> &mailbox = this->mailbox(id, to);
+        while (sent < outbox.size() && mailbox.tryPush(outbox[sent]))
+            sent++;
+        if (sent == outbox.size())
+        {
+            outbox.clear();
+            sent = 0;
+        }
+        else
+            flushed = false;
+    }
+    return flushed;
+}
+
+void ParallelAStar::work(size_t id)
+{
+    Worker &worker = m_workers[id];
+    bool busy = true;
+
+    while (true)
+    {
+        size_t received = 0;
+        Message message;
+        for (size_t from = 0; from < m_threads; from++)
+        {
+            if (from == id)
+                continue;
+
+            SpscQueue<Message> &mailbox = this->mailbox(from, id);
+            while (mailbox.tryPop(message))
+            {
+                /* Becomes busy before the node stops being counted */
+                if (!busy)
+                {
+                    m_pending.fetch_add(1);
+                    busy = true;
+                }
+                this->receive(worker, message);
+                received++;
+            }
+        }
+        if (received > 0)
+            m_pending.fetch_sub(received);
+
+        bool flushed = this->flush(worker, id);
+
+        size_t expanded = 0;
+        while (expanded < expansionBatch && this->expandNext(worker, id))
+            expanded++;
+        if (expanded > 0 || received > 0)
+            continue;
+
+        /* Nodes waiting for a full mailbox keep the thread busy */
+        if (!flushed)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        /* Nothing to expand, send or receive, only a node from another thread can make the thread busy again */
+        if (busy)
+        {
+            busy = false;
+            m_pending.fetch_sub(1);
+        }
+        if (m_pending.load() == 0)
+            return;
+        std::this_thread::yield();
+    }
+}
+
+KernelStats ParallelAStar::search(const SearchGrid &grid, Position start, Position goal, SearchPath *path)
+{
+    KernelStats stats;
+    if (path)
+        path->clear();
+    if (!grid.inside(start.first, start.second))
+        return stats;
+
+    if (m_stamp.size() < grid.size())
+    {
+        m_stamp.assign(grid.size(), 0);
+        m_g.resize(grid.size());
+        m_parent.resize(grid.size());
+        m_generation = 0;
+    }
+    if (++m_generation == 0)
+    {
+        std::fill(m_stamp.begin(), m_stamp.end(), 0);
+        m_generation = 1;
+    }
+
+    m_grid = &grid;
+    m_goal = goal;
+    m_goalCell = grid.inside(goal.first, goal.second) ? grid.index(goal.first, goal.second) : std::numeric_limits<uint32_t>::max();
+    m_incumbent.store(std::numeric_limits<double>::infinity());
+    for (auto &worker: m_workers)
+    {
+        worker.open.clear();
+        worker.expanded = 0;
+        worker.opened = 0;
+        worker.messages = 0;
+    }
+
+    /* Start is put directly into its owner's open list, every thread starts busy */
+    uint32_t startCell = grid.index(start.first, start.second);
+    this->receive(m_workers[this->owner(start.first, start.second)], Message{startCell, startCell, 0.0});
+    m_pending.store(m_threads);
+
+    std::vector<std::thread> threads;
+    for (size_t id = 1; id < m_threads; id++)
+        threads.emplace_back(&ParallelAStar::work, this, id);
+    this->work(0);
+    for (auto &thread: threads)
+        thread.join();
+
+    for (const auto &worker: m_workers)
+    {
+        stats.expanded += worker.expanded;
+        stats.opened += worker.opened;
+    }
+    stats.visited = stats.expanded;
+
+    if (m_incumbent.load() == std::numeric_limits<double>::infinity())
+        return stats;
+
+    /* Costs only drop, so every cell stays more expensive than its parent and the chain of parents ends at start */
+    stats.found = true;
+    stats.cost = m_g[m_goalCell];
+    if (path)
+    {
+        for (uint32_t cell = m_goalCell; cell != startCell; cell = m_parent[cell])
+            path->push_back(grid.position(cell));
+        path->push_back(start);
+        std::reverse(path->begin(), path->end());
+    }
+    return stats;
+}
@@ -0,0 +1,161 @@
+/**
+* @file parallelSearch.hpp
+* @author Ondrej
+* @brief Hash-distributed A* (HDA*), one search spread over more threads
+*
+* Every cell has an owner thread given by a hash of the 8 x 8 block it lies in. Only the owner keeps the cell in its open
+* list and writes its cost and parent, so the per cell arrays are shared without locks. Expanding a cell sends its
+* neighbours to their owners through single-producer/single-consumer mailboxes (one for every pair of threads), blocks
+* keep most neighbours at the same owner and such cells are inserted directly.
+*
+* Threads expand in parallel, so a cell can be reached more cheaply after it was expanded, it is then opened and expanded
+* again. Reaching the goal only sets the incumbent cost, the search goes on until no thread has a node cheaper than the
+* incumbent and no node is on its way between threads. That is detected with one counter of busy threads and nodes sent
+* but not received yet, the search ends when it drops to zero. With the consistent Manhattan heuristic the incumbent is
+* then the optimal cost.
+**/
+
+#pragma once
+
+#include "searchKernel.hpp"
+#include "spscQueue.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+
+/**
+* @brief Parallel A* (4-connected, unit costs, Manhattan heuristic) over SearchGrid
+* - One object runs one search at a time, threads are started for every search and per cell arrays are reused
+* - Path has the optimal length, it can differ from the path of searchKernel when there are more optimal paths
+**/
+class ParallelAStar
+{
+public:
+    /** Capacity of every mailbox, nodes that do not fit wait in the sender's outbox */
+    static constexpr size_t mailboxCapacity = 4096;
+
+    /** Cells expanded between two reads of the mailboxes */
+    static constexpr size_t expansionBatch = 64;
+
+    /** Owner blocks are (1 << blockShift) cells wide and high */
+    static constexpr uint32_t blockShift = 3;
+
+    /** 0 means one thread per hardware thread */
+    explicit ParallelAStar(size_t threads = 0);
+
+    ParallelAStar(const ParallelAStar &) = delete;
+    ParallelAStar &operator=(const ParallelAStar &) = delete;
+
+    size_t threads(void) const { return m_threads; }
+
+    /**
+    * @brief Searches from start to goal, path (if not nullptr) is filled from start to goal when goal is reachable
+    * - stats.visited and stats.expanded count all expansions (cells expanded more times are counted every time),
+    *   stats.opened counts cells accepted with a lower cost
+    **/
+    KernelStats search(const SearchGrid &grid, Position start, Position goal, SearchPath *path);
+
+    /** Nodes sent to other threads in the last search */
+    size_t messages(void) const;
+
+    /** Expansions of every thread in the last search */
+    std::vector<size_t> expandedPerThread(void) const;
+
+private:
+    /** Cell reached from parent with cost g */
+    struct Message
+    {
+        uint32_t cell;
+        uint32_t parent;
+        double g;
+    };
+
+    struct OpenEntry
+    {
+        double f;
+        double g;
+        uint32_t cell;
+    };
+
+    /** State of one thread, aligned so threads do not share cache lines */
+    struct alignas(64) Worker
+    {
+        /** Binary heap, lowest f first and higher g among equal f */
+        std::vector<OpenEntry> open;
+
+        /** Nodes for every other thread that were not put into its mailbox yet */
+        std::vector<std::vector<Message>> outboxes;
+
+        /** Nodes of outboxes[t] before this index are already in the mailbox */
+        std::vector<size_t> sent;
+
+        /** Nodes added to the outboxes but not to m_pending yet */
+        size_t unannounced = 0;
+
+        size_t expanded = 0;
+
+        size_t opened = 0;
+
+        size_t messages = 0;
+    };
+
+    /** Thread owning the cell at (x, y) */
+    uint32_t owner(int x, int y) const
+    {
+        uint32_t hash = (static_cast<uint32_t>(x) >> blockShift) * 0x9E3779B1u ^ (static_cast<uint32_t>(y) >> blockShift) * 0x85EBCA77u;
+        hash ^= hash >> 15;
+        return static_cast<uint32_t>((static_cast<uint64_t>(hash) * m_threads) >> 32);
+    }
+
+    double heuristic(uint32_t cell) const;
+
+    SpscQueue<Message> &mailbox(size_t from, size_t to) { return *m_mailboxes[from * m_threads + to]; }
+
+    /** Body of thread id, returns when the search is over */
+    void work(size_t id);
+
+    /** Accepts the node if it is cheaper than the cell's cost and can beat the incumbent, called only by the owner */
+    void receive(Worker &worker, const Message &message);
+
+    /** Expands the best open node that can beat the incumbent, returns false if there is none */
+    bool expandNext(Worker &worker, size_t id);
+
+    /** Moves outboxes into the mailboxes, returns false if some nodes did not fit */
+    bool flush(Worker &worker, size_t id);
+
+    /** Lowers the incumbent to cost */
+    void improveIncumbent(double cost);
+
+    size_t m_threads;
+
+    std::vector<std::unique_ptr<SpscQueue<Message>>> m_mailboxes;
+
+    std::vector<Worker> m_workers;
+
+    /* Cell arrays, stamp equal to the generation means the cell was reached in this search */
+
+    uint32_t m_generation = 0;
+
+    std::vector<uint32_t> m_stamp;
+
+    std::vector<double> m_g;
+
+    std::vector<uint32_t> m_parent;
+
+    /* Search in progress */
+
+    const SearchGrid *m_grid = nullptr;
+
+    Position m_goal;
+
+    uint32_t m_goalCell = 0;
+
+    /** Busy threads plus nodes sent and not received, zero means the search is over */
+    alignas(64) std::atomic<size_t> m_pending{0};
+
+    /** Cost of the best path to the goal found so far */
+    alignas(64) std::atomic<double> m_incumbent{0.0};
+};
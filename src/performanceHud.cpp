@@ -0,0 +1,257 @@
+/**
+* @file performanceHud.cpp
+* @author Ondrej
+* @brief Implementation of PerformanceHud
+**/
+
+#include "performanceHud.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+
+/** Character of the pixel font, every row has 3 pixels, bit 2 is the left one */
+struct Glyph
+{
+    char character;
+    std::array<uint8_t, 5> rows;
+};
+
+static const Glyph glyphs[] = {
+    {' ', {0b000, 0b000, 0b000, 0b000, 0b000}}, {'0', {0b111, 0b101, 0b101, 0b101, 0b111}},
+    {'1', {0b010, 0b110, 0b010, 0b010, 0b111}}, {'2', {0b111, 0b001, 0b111, 0b100, 0b111}},
+    {'3', {0b111, 0b001, 0b111, 0b001, 0b111}}, {'4', {0b101, 0b101, 0b111, 0b001, 0b001}},
+    {'5', {0b111, 0b100, 0b111, 0b001, 0b111}}, {'6', {0b111, 0b100, 0b111, 0b101, 0b111}},
+    {'7', {0b111, 0b001, 0b001, 0b001, 0b001}}, {'8', {0b111, 0b101, 0b111, 0b101, 0b111}},
+    {'9', {0b111, 0b101, 0b111, 0b001, 0b111}}, {'A', {0b010, 0b101, 0b111, 0b101, 0b101}},
+    {'B', {0b110, 0b101, 0b110, 0b101, 0b110}}, {'C', {0b011, 0b100, 0b100, 0b100, 0b011}},
+    {'D', {0b110, 0b101, 0b101, 0b101, 0b110}}, {'E', {0b111, 0b100, 0b110, 0b100, 0b111}},
+    {'F', {0b111, 0b100, 0b110, 0b100, 0b100}}, {'G', {0b011, 0b100, 0b101, 0b101, 0b011}},
+    {'H', {0b101, 0b101, 0b111, 0b101, 0b101}}, {'I', {0b111, 0b010, 0b010, 0b010, 0b111}},
+    {'J', {0b001, 0b001, 0b001, 0b101, 0b010}}, {'K', {0b101, 0b101, 0b110, 0b101, 0b101}},
+    {'L', {0b100, 0b100, 0b100, 0b100, 0b111}}, {'M', {0b101, 0b111, 0b111, 0b101, 0b101}},
+    {'N', {0b110, 0b101, 0b101, 0b101, 0b101}}, {'O', {0b010, 0b101, 0b101, 0b101, 0b010}},
+    {'P', {0b110, 0b101, 0b110, 0b100, 0b100}}, {'Q', {0b010, 0b101, 0b101, 0b110, 0b011}},
+    {'R', {0b110, 0b101, 0b110, 0b101, 0b101}}, {'S', {0b011, 0b100, 0b010, 0b001, 0b110}},
+    {'T', {0b111, 0b010, 0b010, 0b010, 0b010}}, {'U', {0b101, 0b101, 0b101, 0b101, 0b111}},
+    {'V', {0b101, 0b101, 0b101, 0b101, 0b010}}, {'W', {0b101, 0b101, 0b111, 0b111, 0b101}},
+    {'X', {0b101, 0b101, 0b010, 0b101, 0b101}}, {'Y', {0b101, 0b101, 0b010, 0b010, 0b010}},
+    {'Z', {0b111, 0b001, 0b010, 0b100, 0b111}}, {'.', {0b000, 0b000, 0b000, 0b000, 0b010}},
+    {',', {0b000, 0b000, 0b000, 0b010, 0b100}}, {':', {0b000, 0b010, 0b000, 0b010, 0b000}},
+    {'/', {0b001, 0b001, 0b010, 0b100, 0b100}}, {'-', {0b000, 0b000, 0b111, 0b000, 0b000}},
+    {'+', {0b000, 0b010, 0b111, 0b010, 0b000}}, {'=', {0b000, 0b111, 0b000, 0b111, 0b000}},
+    {'*', {0b000, 0b101, 0b010, 0b101, 0b000}}, {'%', {0b101, 0b001, 0b010, 0b100, 0b101}},
+    {'(', {0b001, 0b010, 0b010, 0b010, 0b001}}, {')', {0b100, 0b010, 0b010, 0b010, 0b100}},
+    {'?', {0b111, 0b001, 0b010, 0b000, 0b010}},
+};
+
+/** Glyph of the character, '?' if the font does not have it */
+static const Glyph &findGlyph(char character)
+{
+    character = static_cast<char>(std::toupper(static_cast<unsigned char>(character)));
+    for (const Glyph &glyph: glyphs)
+    {
+        if (glyph.character == character)
+            return glyph;
+    }
+    return glyphs[std::size(glyphs) - 1];
+}
+
+/** Number with given count of decimal places */
+static std::string fixed(double value, int precision)
+{
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(precision) << value;
+    return text.str();
+}
+
+/** Short form of large counts (12.3K, 4.5M), the overlay has to stay narrow */
+static std::string compact(double value)
+{
+    if (value < 10000.0)
+        return fixed(value, 0);
+    if (value < 10000000.0)
+        return fixed(value / 1000.0, 1) + "K";
+    return fixed(value / 1000000.0, 1) + "M";
+}
+
+/** Glyph is 3 x 5 pixels, characters and lines are separated by 1 and 2 pixels */
+static const float glyphAdvance = 4 * PerformanceHud::fontScale;
+static const float lineAdvance = 7 * PerformanceHud::fontScale;
+
+/** Space between the panel border and its content */
+static const float padding = 8.0f;
+
+/** Height of the frame time graph in window pixels, every frame is a bar 2 pixels wide */
+static const float graphHeight = 60.0f;
+static const float barWidth = 2.0f;
+
+void PerformanceHud::addFrame(const HudFrame &frame)
+{
+    m_history[m_next] = frame;
+    m_next = (m_next + 1) % historySize;
+    m_count = std::min(m_count + 1, historySize);
+}
+
+void PerformanceHud::clear(void)
+{
+    m_next = 0;
+    m_count = 0;
+}
+
+const HudFrame &PerformanceHud::frame(size_t i) const
+{
+    return m_history[(m_next + historySize - 1 - i) % historySize];
+}
+
+std::vector<std::string> PerformanceHud::lines(const HudSearch &search) const
+{
+    double seconds = 0.0;
+    double workSeconds = 0.0;
+    double maxSeconds = 0.0;
+    RenderStats render;
+    for (size_t i = 0; i < m_count; i++)
+    {
+        const HudFrame &measured = this->frame(i);
+        seconds += measured.seconds;
+        workSeconds += measured.workSeconds;
+        maxSeconds = std::max(maxSeconds, measured.seconds);
+        render.cellsUpdated += measured.render.cellsUpdated;
+        render.uploads += measured.render.uploads;
+        render.drawCalls += measured.render.drawCalls;
+        render.vertices += measured.render.vertices;
+    }
+
+    /* Averages over the kept frames, nothing is measured right after the start */
+    double frames = static_cast<double>(std::max<size_t>(m_count, 1));
+    double fps = seconds > 0.0 ? m_count / seconds : 0.0;
+    double cellsPerSecond = seconds > 0.0 ? render.cellsUpdated / seconds : 0.0;
+
+    std::vector<std::string> text;
+    text.push_back("FPS " + fixed(fps, 1) + "  FRAME " + fixed(1000.0 * seconds / frames, 1) + " MS  MAX " + fixed(1000.0 * maxSeconds, 1) + " MS");
+    text.push_back("WORK " + fixed(1000.0 * workSeconds / frames, 2) + " MS  WAIT " + fixed(1000.0 * (seconds - workSeconds) / frames, 2) + " MS");
+    text.push_back("DRAW CALLS " + fixed(render.drawCalls / frames, 1) + " +1 HUD  VERTICES " + compact(render.vertices / frames) + " +" +
+                   compact(static_cast<double>(this->vertices())) + " HUD");
+    text.push_back("CELLS " + compact(cellsPerSecond) + "/S  UPLOADS " + fixed(render.uploads / frames, 1) + "/FRAME");
+    text.push_back("BATCH " + std::to_string(search.shown) + "/" + std::to_string(search.batchSize) + "  MAX " + compact(static_cast<double>(search.maxBatchSize)) +
+                   "  SPEED " + compact(search.speed) + "/S" + (search.paused ? "  PAUSED" : ""));
+    text.push_back(search.algorithm + "  EXPANDED " + compact(static_cast<double>(search.expanded)) + "  FRONTIER " +
+                   compact(static_cast<double>(search.frontier)));
+    if (search.cached)
+        text.push_back("SEARCH CACHED");
+    else if (search.searchSeconds >= 0.0)
+        text.push_back("SEARCH " + fixed(1000.0 * search.searchSeconds, 2) + " MS" + (search.running ? "  RUNNING" : ""));
+    return text;
+}
+
+void PerformanceHud::appendRect(sf::VertexArray &vertices, float x, float y, float width, float height, const sf::Color &color)
+{
+    vertices.append(sf::Vertex(sf::Vector2f(x, y), color));
+    vertices.append(sf::Vertex(sf::Vector2f(x + width, y), color));
+    vertices.append(sf::Vertex(sf::Vector2f(x + width, y + height), color));
+    vertices.append(sf::Vertex(sf::Vector2f(x, y + height), color));
+}
+
+/** Runs of lit pixels in a row are one quad */
+void PerformanceHud::appendText(sf::VertexArray &vertices, float x, float y, const std::string &text, const sf::Color &color)
+{
+    for (char character: text)
+    {
+        const Glyph &glyph = findGlyph(character);
+        for (size_t row = 0; row < glyph.rows.size(); row++)
+        {
+            for (int column = 0; column < 3;)
+            {
+                if (!(glyph.rows[row] & (0b100 >> column)))
+                {
+                    column++;
+                    continue;
+                }
+
+                int end = column;
+                while (end < 3 && (glyph.rows[row] & (0b100 >> end)))
+                    end++;
+                appendRect(vertices, x + column * fontScale, y + row * fontScale, (end - column) * fontScale, fontScale, color);
+                column = end;
+            }
+        }
+        x += glyphAdvance;
+    }
+}
+
+void PerformanceHud::appendLabel(sf::VertexArray &vertices, float x, float y, const std::vector<std::string> &text)
+{
+    size_t columns = 0;
+    for (const auto &line: text)
+        columns = std::max(columns, line.size());
+
+    /* Last column and line end with the space between characters and lines, it is not part of the text */
+    float width = columns * glyphAdvance - fontScale + 2 * padding;
+    float height = text.size() * lineAdvance - 2 * fontScale + 2 * padding;
+    appendRect(vertices, x, y, width, height, sf::Color(20, 20, 20, 190));
+    for (const auto &line: text)
+    {
+        appendText(vertices, x + padding, y + padding, line, sf::Color(235, 235, 235));
+        y += lineAdvance;
+    }
+}
+
+void PerformanceHud::appendGraph(float x, float y, float width, float height, double targetSeconds)
+{
+    appendRect(m_vertices, x, y, width, height, sf::Color(0, 0, 0, 120));
+
+    float pixelsPerSecond = static_cast<float>(height / graphSeconds);
+    for (size_t i = 0; i < m_count; i++)
+    {
+        const HudFrame &measured = this->frame(i);
+        float total = std::min(static_cast<float>(measured.seconds) * pixelsPerSecond, height);
+        float work = std::min(static_cast<float>(measured.workSeconds) * pixelsPerSecond, total);
+        float barX = x + width - (i + 1) * barWidth;
+
+        /* Green within the target frame time (with small tolerance), yellow up to its double, red above */
+        sf::Color color(80, 200, 80);
+        if (measured.seconds > 2.0 * targetSeconds)
+            color = sf::Color(230, 70, 60);
+        else if (measured.seconds > 1.2 * targetSeconds)
+            color = sf::Color(230, 200, 60);
+
+        /* Waiting is the lighter top part of the bar, work the full colour bottom part */
+        appendRect(m_vertices, barX, y + height - total, barWidth, total - work, sf::Color(color.r, color.g, color.b, 90));
+        appendRect(m_vertices, barX, y + height - work, barWidth, work, color);
+    }
+
+    for (double mark: {targetSeconds, 2.0 * targetSeconds})
+    {
+        float markY = y + height - static_cast<float>(mark) * pixelsPerSecond;
+        if (markY >= y)
+            appendRect(m_vertices, x, markY, width, 1.0f, sf::Color(255, 255, 255, 110));
+    }
+}
+
+void PerformanceHud::draw(sf::RenderTarget &target, const HudSearch &search, double targetSeconds)
+{
+    std::vector<std::string> text = this->lines(search);
+    size_t columns = 0;
+    for (const auto &line: text)
+        columns = std::max(columns, line.size());
+
+    float graphWidth = historySize * barWidth;
+    float width = std::max(columns * glyphAdvance, graphWidth) + 2 * padding;
+    float height = text.size() * lineAdvance + graphHeight + 3 * padding;
+
+    m_vertices.clear();
+    appendRect(m_vertices, padding, padding, width, height, sf::Color(20, 20, 20, 190));
+
+    float y = 2 * padding;
+    for (const auto &line: text)
+    {
+        appendText(m_vertices, 2 * padding, y, line, sf::Color(235, 235, 235));
+        y += lineAdvance;
+    }
+    this->appendGraph(2 * padding, y + padding, graphWidth, graphHeight, targetSeconds);
+
+    target.draw(m_vertices);
+}
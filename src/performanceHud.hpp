@@ -0,0 +1,100 @@
+/**
+* @file performanceHud.hpp
+* @author Ondrej
+* @brief On-screen overlay with frame, rendering, playback and search statistics of the visualiser
+*
+* The overlay is drawn in window pixels as one vertex array (one draw call). Text uses a built-in 3x5 pixel font, so no
+* font file is needed. Frame statistics are averaged over the last historySize frames, the graph shows time of every
+* one of them split into upload/draw work and the rest of the frame (waiting in display for the framerate limit).
+**/
+
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <string>
+#include <vector>
+
+#include "gridRenderer.hpp"
+
+
+/** Measurements of one displayed frame */
+struct HudFrame
+{
+    double seconds = 0.0;
+    /** Time spent uploading changed cells and drawing, without waiting in display */
+    double workSeconds = 0.0;
+    RenderStats render;
+};
+
+/** Playback and search state shown under the frame statistics */
+struct HudSearch
+{
+    std::string algorithm;
+    /** Steps displayed in the last frame and steps the scheduler asked for */
+    size_t shown = 0;
+    size_t batchSize = 0;
+    size_t maxBatchSize = 0;
+    /** Steps per second */
+    double speed = 0.0;
+    size_t expanded = 0;
+    /** Cells shown as opened and not expanded yet */
+    size_t frontier = 0;
+    /** Search time without waiting for the animation, negative if it is not known (replayed from the cache) */
+    double searchSeconds = -1.0;
+    bool running = false;
+    bool cached = false;
+    bool paused = false;
+};
+
+class PerformanceHud
+{
+public:
+    /** Frames kept for the averages and the graph */
+    static constexpr size_t historySize = 120;
+
+    /** Size of one pixel of the font in window pixels */
+    static constexpr float fontScale = 2.0f;
+
+    /** Frame time at the top of the graph, longer frames are cut */
+    static constexpr double graphSeconds = 0.050;
+
+    /** Adds measurements of the frame that was just displayed */
+    void addFrame(const HudFrame &frame);
+
+    /** Forgets the measured frames */
+    void clear(void);
+
+    /** Draws the overlay in the top left corner, the target has to use its default view */
+    void draw(sf::RenderTarget &target, const HudSearch &search, double targetSeconds);
+
+    /** Vertices of the last drawn overlay */
+    size_t vertices(void) const { return m_vertices.getVertexCount(); }
+
+    static void appendRect(sf::VertexArray &vertices, float x, float y, float width, float height, const sf::Color &color);
+
+    /** Appends text in the pixel font, lowercase letters are drawn as uppercase, unknown characters as '?' */
+    static void appendText(sf::VertexArray &vertices, float x, float y, const std::string &text, const sf::Color &color);
+
+    /** Appends lines of text on a dark panel whose top left corner is at (x, y), as the overlay draws them */
+    static void appendLabel(sf::VertexArray &vertices, float x, float y, const std::vector<std::string> &text);
+
+private:
+    /** Lines of text describing frames and the search */
+    std::vector<std::string> lines(const HudSearch &search) const;
+
+    /** Frame that was added i frames ago (0 = last one), i has to be less than m_count */
+    const HudFrame &frame(size_t i) const;
+
+    /** Bars of frame times from the oldest to the newest frame, lines mark the target frame time and its double */
+    void appendGraph(float x, float y, float width, float height, double targetSeconds);
+
+    std::array<HudFrame, historySize> m_history;
+
+    /** Index where the next frame is written */
+    size_t m_next = 0;
+
+    size_t m_count = 0;
+
+    sf::VertexArray m_vertices{sf::Quads};
+};
@@ -0,0 +1,67 @@
+/**
+* @file playbackScheduler.cpp
+* @author Ondrej
+* @brief Implementation of PlaybackScheduler
+**/
+
+#include "playbackScheduler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+/** Steps due since the previous frame, limited by the frame budget */
+size_t PlaybackScheduler::stepsForFrame(void)
+{
+    Clock::time_point now = Clock::now();
+    double elapsed = std::chrono::duration<double>(now - m_lastFrame).count();
+    m_lastFrame = now;
+
+    /* After a stall (window dragged, breakpoint) playback continues, it does not try to catch up */
+    elapsed = std::min(elapsed, 4.0 / refreshRate);
+    m_due += m_rate * elapsed;
+
+    size_t limit = this->maxStepsPerFrame();
+    size_t steps = static_cast<size_t>(std::min(std::floor(m_due), static_cast<double>(limit)));
+    m_due -= static_cast<double>(steps);
+
+    /* Steps over the budget are dropped, otherwise they would pile up and every later frame would be over budget */
+    m_due = std::min(m_due, static_cast<double>(limit));
+
+    return steps;
+}
+
+/** Updates average cost of one step, frames count by their steps, so few steps (mostly timer noise) count little */
+void PlaybackScheduler::stepsDone(size_t steps, double seconds)
+{
+    if (steps == 0)
+        return;
+
+    /* Every frame fades the older ones, one slow frame is forgotten after a few dozen frames of any size */
+    const double keep = 0.8;
+    m_stepSeconds = keep * m_stepSeconds + seconds;
+    m_stepCount = keep * m_stepCount + static_cast<double>(steps);
+}
+
+void PlaybackScheduler::frameDrawn(double seconds)
+{
+    const double weight = 0.2;
+    m_drawSeconds = (1.0 - weight) * m_drawSeconds + weight * seconds;
+}
+
+void PlaybackScheduler::idle(void)
+{
+    m_lastFrame = Clock::now();
+}
+
+void PlaybackScheduler::setRate(double stepsPerSecond)
+{
+    m_rate = std::clamp(stepsPerSecond, minRate, maxRate);
+    m_due = std::min(m_due, 1.0);
+}
+
+size_t PlaybackScheduler::maxStepsPerFrame(void) const
+{
+    double budget = std::max(workBudget / refreshRate - m_drawSeconds, minStepBudget / refreshRate);
+    double steps = budget / this->secondsPerStep();
+    return static_cast<size_t>(std::max(steps, 1.0));
+}
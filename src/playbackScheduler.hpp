@@ -0,0 +1,79 @@
+/**
+* @file playbackScheduler.hpp
+* @author Ondrej
+* @brief Decides how many steps of the animation are displayed in each frame
+**/
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+
+/**
+* @brief Playback at fixed refresh rate with independent speed (steps per second)
+* - Every frame gets the steps that became due since the previous frame
+* - Work of one frame (displaying steps, uploading and drawing them) may take only part of the frame, if the speed
+*   cannot be reached the playback slows down instead of dropping frames
+* - Drawing a frame and displaying one step are measured separately, steps get the budget that drawing leaves, at least
+*   minStepBudget of the frame even if drawing alone is over the budget; uploading the shown steps is part of drawing,
+*   so more steps leave less budget to the next frames
+**/
+class PlaybackScheduler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /** Frames per second the window is limited to */
+    static const unsigned refreshRate = 60;
+
+    /** Part of the frame that the work of a frame may take, rest is left for input and display */
+    static constexpr double workBudget = 0.8;
+
+    /** Part of the frame that steps always get, so slow drawing never stops the playback */
+    static constexpr double minStepBudget = 0.1;
+
+    static constexpr double minRate = 1.0;
+
+    static constexpr double maxRate = 1e8;
+
+    explicit PlaybackScheduler(double stepsPerSecond) { this->setRate(stepsPerSecond); };
+
+    /** Number of steps to display in this frame */
+    size_t stepsForFrame(void);
+
+    /** Reports how long displaying the steps of this frame took, without drawing */
+    void stepsDone(size_t steps, double seconds);
+
+    /** Reports how long uploading and drawing this frame took, also for frames without steps */
+    void frameDrawn(double seconds);
+
+    /** Frame without playback (paused, finished), time does not accumulate steps */
+    void idle(void);
+
+    void setRate(double stepsPerSecond);
+
+    double rate(void) const { return m_rate; }
+
+    /** Steps that fit into the budget of one frame left by drawing with the measured step cost */
+    size_t maxStepsPerFrame(void) const;
+
+    /** Measured time of one step */
+    double secondsPerStep(void) const { return m_stepSeconds / m_stepCount; }
+
+private:
+    double m_rate = 0.0;
+
+    /** Steps that are due but were not displayed yet, fractional at low speeds */
+    double m_due = 0.0;
+
+    /** Time and count of the displayed steps, older frames fade out; starts with optimistic guess of one step */
+    double m_stepSeconds = 1e-7;
+
+    double m_stepCount = 1.0;
+
+    /** Moving average of time of drawing one frame */
+    double m_drawSeconds = 0.0;
+
+    Clock::time_point m_lastFrame = Clock::now();
+};
@@ -0,0 +1,126 @@
+/**
+* @file profiler.cpp
+* @author Ondrej
+* @brief Implementation of Profiler
+**/
+
+#include "profiler.hpp"
+
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> Profiler::s_enabled{false};
+
+/** Finished zone */
+struct ProfileEvent
+{
+    const char *name;
+    int64_t begin;
+    int64_t end;
+};
+
+/** Zones of one thread, the mutex is only contended while the trace is started or written */
+struct ProfileThread
+{
+    std::mutex mutex;
+    uint32_t id;
+    std::string name;
+    std::vector<ProfileEvent> events;
+};
+
+/** Buffers of all threads that ever recorded or were named, kept after the threads exit */
+struct ProfileRegistry
+{
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ProfileThread>> threads;
+    int64_t origin = 0;
+};
+
+static ProfileRegistry &registry(void)
+{
+    static ProfileRegistry registry;
+    return registry;
+}
+
+static ProfileThread &currentThread(void)
+{
+    thread_local std::shared_ptr<ProfileThread> thread = []() {
+        auto thread = std::make_shared<ProfileThread>();
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        thread->id = static_cast<uint32_t>(registry().threads.size()) + 1;
+        thread->name = "thread " + std::to_string(thread->id);
+        registry().threads.push_back(thread);
+        return thread;
+    }();
+    return *thread;
+}
+
+/** Names are ours, only quotes and backslashes need escaping */
+static std::string escape(const std::string &text)
+{
+    std::string escaped;
+    for (char c: text)
+    {
+        if (c == '"' || c == '\\')
+            escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+void Profiler::start(void)
+{
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    for (auto &thread: registry().threads)
+    {
+        std::lock_guard<std::mutex> threadLock(thread->mutex);
+        thread->events.clear();
+    }
+    registry().origin = now();
+    s_enabled.store(true);
+}
+
+bool Profiler::finish(const std::string &path)
+{
+    s_enabled.store(false);
+
+    std::ofstream output(path);
+    if (!output)
+        return false;
+
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    int64_t origin = registry().origin;
+    output << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (auto &thread: registry().threads)
+    {
+        std::lock_guard<std::mutex> threadLock(thread->mutex);
+        output << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->id
+               << ",\"args\":{\"name\":\"" << escape(thread->name) << "\"}}";
+        first = false;
+        for (const auto &event: thread->events)
+        {
+            output << ",\n{\"name\":\"" << escape(event.name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->id
+                   << ",\"ts\":" << event.begin - origin << ",\"dur\":" << event.end - event.begin << "}";
+        }
+        thread->events.clear();
+    }
+    output << "\n]}\n";
+    return static_cast<bool>(output);
+}
+
+void Profiler::record(const char *name, int64_t begin, int64_t end)
+{
+    ProfileThread &thread = currentThread();
+    std::lock_guard<std::mutex> lock(thread.mutex);
+    thread.events.push_back(ProfileEvent{name, begin, end});
+}
+
+void Profiler::nameThread(const std::string &name)
+{
+    ProfileThread &thread = currentThread();
+    std::lock_guard<std::mutex> lock(thread.mutex);
+    thread.name = name;
+}
@@ -0,0 +1,318 @@
+/**
+* @file queryServer.cpp
+* @author Ondrej
+* @brief Implementation of QueryServer
+**/
+
+#include "queryServer.hpp"
+#include "conversion.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+QueryServer::QueryServer(size_t threads) : m_pool(threads)
+{
+    m_latencies.reserve(latencySamples);
+}
+
+/** Reader thread only splits lines, searches run in the pool */
+void QueryServer::serve(int input, int output)
+{
+    Connection connection;
+    connection.output = output;
+
+    std::string pending;
+    size_t request = 0;
+    char buffer[1 << 16];
+
+    while (true)
+    {
+        ssize_t count = read(input, buffer, sizeof(buffer));
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count <= 0)
+            break;
+        pending.append(buffer, count);
+
+        size_t begin = 0;
+        size_t end;
+        while ((end = pending.find('\n', begin)) != std::string::npos)
+        {
+            std::string line = pending.substr(begin, end - begin);
+            begin = end + 1;
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if (line.find_first_not_of(" \t") == std::string::npos)
+                continue;
+
+            size_t number = request++;
+            if (line == "stats")
+            {
+                this->respond(connection, number, this->latencyReport());
+                continue;
+            }
+
+            /* Pipelining is limited, so slow queries cannot pile up without bound */
+            {
+                std::unique_lock<std::mutex> lock(connection.mutex);
+                connection.answered.wait(lock, [&connection]() { return connection.inFlight < maxInFlight; });
+                connection.inFlight++;
+            }
+
+            auto received = std::chrono::steady_clock::now();
+            m_pool.submit([this, &connection, number, line, received]() {
+                std::string response = this->answer(line);
+
+                /* Recorded before writing, so stats requested after the response already include it */
+                this->addLatency(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - received).count());
+                this->respond(connection, number, response);
+
+                std::lock_guard<std::mutex> lock(connection.mutex);
+                connection.inFlight--;
+                connection.answered.notify_all();
+            });
+        }
+        pending.erase(0, begin);
+    }
+
+    /* Connection lives on this stack, queries still running refer to it */
+    std::unique_lock<std::mutex> lock(connection.mutex);
+    connection.answered.wait(lock, [&connection]() { return connection.inFlight == 0; });
+}
+
+bool QueryServer::listen(const std::string &socketPath)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path))
+        return false;
+    socketPath.copy(address.sun_path, socketPath.size());
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+        return false;
+
+    unlink(socketPath.c_str());
+    if (bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || ::listen(listener, 64) != 0)
+    {
+        close(listener);
+        return false;
+    }
+
+    /* Connection threads are detached, the last one to finish wakes up the listener when stopping */
+    std::mutex clientsMutex;
+    std::condition_variable clientClosed;
+    std::vector<int> clients;
+
+    while (!m_stopping.load())
+    {
+        /* Timeout lets the loop notice stop */
+        pollfd waiting{listener, POLLIN, 0};
+        if (poll(&waiting, 1, 200) <= 0)
+            continue;
+
+        int client = accept(listener, nullptr, nullptr);
+        if (client < 0)
+            continue;
+
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        clients.push_back(client);
+        std::thread([this, client, &clientsMutex, &clientClosed, &clients]() {
+            PROFILE_THREAD("connection");
+            this->serve(client, client);
+
+            std::lock_guard<std::mutex> lock(clientsMutex);
+            close(client);
+            clients.erase(std::find(clients.begin(), clients.end(), client));
+            clientClosed.notify_all();
+        }).detach();
+    }
+
+    /* Reading ends, requests already read are still answered */
+    std::unique_lock<std::mutex> lock(clientsMutex);
+    for (int client: clients)
+        shutdown(client, SHUT_RD);
+    clientClosed.wait(lock, [&clients]() { return clients.empty(); });
+
+    close(listener);
+    unlink(socketPath.c_str());
+    return true;
+}
+
+std::string QueryServer::latencyReport(void)
+{
+    std::vector<double> latencies;
+    size_t queries;
+    {
+        std::lock_guard<std::mutex> lock(m_latencyMutex);
+        latencies = m_latencies;
+        queries = m_queries;
+    }
+
+    std::ostringstream report;
+    report << "stats count=" << queries;
+    if (latencies.empty())
+        return report.str();
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) {
+        size_t index = std::min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()));
+        return static_cast<long>(latencies[index]);
+    };
+
+    report << " p50=" << percentile(0.5) << " p90=" << percentile(0.9) << " p99=" << percentile(0.99)
+           << " p999=" << percentile(0.999) << " max=" << static_cast<long>(latencies.back());
+    return report.str();
+}
+
+std::string QueryServer::answer(const std::string &line)
+{
+    PROFILE_ZONE("query");
+    std::istringstream fields(line);
+    std::string name;
+    std::string word;
+    std::string algo;
+    Position start;
+    Position goal;
+    size_t k = 0;
+    std::vector<Position> goals;
+    SearchAlgorithmType algoType;
+
+    if (!(fields >> name >> start.first >> start.second >> word))
+        return "error expected: map start_x start_y goal_x goal_y algorithm";
+
+    /* Nearest query lists its goals after the algorithm, without them the goals of the map are used */
+    bool nearest = word == "nearest";
+    if (nearest)
+    {
+        if (!(fields >> word >> algo) || !strToNum(word, k) || k == 0)
+            return "error expected: map start_x start_y nearest k algorithm [goal_x goal_y]...";
+        while (fields >> goal.first >> goal.second)
+            goals.push_back(goal);
+        if (!fields.eof())
+            return "error goals have to be pairs of numbers";
+    }
+    else
+    {
+        std::istringstream first(word);
+        if (!(first >> goal.first) || !(fields >> goal.second >> algo))
+            return "error expected: map start_x start_y goal_x goal_y algorithm";
+    }
+
+    if (!strToAlgoType(algo, algoType))
+        return "error unknown algorithm " + algo;
+    if (nearest && algoType != SearchAlgorithmType::BFS && algoType != SearchAlgorithmType::AStar)
+        return "error nearest goals are searched only by bfs and astar";
+
+    std::shared_ptr<const GridMap> map;
+    try
+    {
+        map = m_maps.get(name);
+    }
+    catch (const std::exception &error)
+    {
+        return "error cannot load map " + name + ": " + error.what();
+    }
+    if (!map)
+        return "error unknown map " + name;
+
+    /* Searches expect the start and the goals of the query to be free cells of the map, goals of the map are not checked
+       (goal on a wall is never found) */
+    std::vector<Position> checked = {start};
+    if (!nearest)
+        goals.push_back(goal);
+    checked.insert(checked.end(), goals.begin(), goals.end());
+    if (nearest && goals.empty())
+        goals = map->goals();
+
+    const auto &grid = map->grid();
+    for (Position pos: checked)
+    {
+        if (pos.second < 0 || pos.second >= static_cast<int>(grid.size()) || pos.first < 0 ||
+            pos.first >= static_cast<int>(grid[pos.second].size()) || grid[pos.second][pos.first] == 0)
+            return "error position " + std::to_string(pos.first) + " " + std::to_string(pos.second) + " is not a free cell";
+    }
+
+    std::unique_ptr<SearchSession> session;
+    {
+        std::lock_guard<std::mutex> lock(m_idleMutex);
+        auto &idle = m_idle[map.get()];
+        if (!idle.empty())
+        {
+            session = std::move(idle.back());
+            idle.pop_back();
+        }
+    }
+    if (!session)
+        session = std::make_unique<SearchSession>(map);
+
+    auto begin = std::chrono::steady_clock::now();
+    const KernelStats &stats = nearest ? session->runNearest(algoType, start, goals, k)
+                                       : session->run(algoType, start, goal, m_reduction, m_suboptimality);
+    long micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+
+    auto writePath = [](std::ostringstream &response, const auto &path) {
+        for (size_t i = 0; i < path.size(); i++)
+            response << (i ? ";" : "") << path[i].first << ',' << path[i].second;
+    };
+
+    std::ostringstream response;
+    if (nearest)
+    {
+        const auto &targets = session->nearest();
+        response << "ok " << targets.size() << ' ' << stats.visited << ' ' << micros << ' ';
+        for (size_t i = 0; i < targets.size(); i++)
+        {
+            response << (i ? "|" : "");
+            writePath(response, targets[i].path);
+        }
+    }
+    else
+    {
+        const auto &path = session->path();
+        response << "ok " << path.size() << ' ' << stats.visited << ' ' << micros << ' ';
+        writePath(response, path);
+    }
+
+    std::lock_guard<std::mutex> lock(m_idleMutex);
+    m_idle[map.get()].push_back(std::move(session));
+    return response.str();
+}
+
+void QueryServer::respond(Connection &connection, size_t request, const std::string &response)
+{
+    std::string line = std::to_string(request) + ' ' + response + '\n';
+
+    std::lock_guard<std::mutex> lock(connection.writeMutex);
+    size_t written = 0;
+    while (written < line.size())
+    {
+        ssize_t count = write(connection.output, line.data() + written, line.size() - written);
+        if (count < 0 && errno == EINTR)
+            continue;
+        /* Client went away, remaining responses are dropped */
+        if (count <= 0)
+            return;
+        written += count;
+    }
+}
+
+void QueryServer::addLatency(double microseconds)
+{
+    std::lock_guard<std::mutex> lock(m_latencyMutex);
+    if (m_latencies.size() < latencySamples)
+        m_latencies.push_back(microseconds);
+    else
+        m_latencies[m_queries % latencySamples] = microseconds;
+    m_queries++;
+}
@@ -0,0 +1,118 @@
+/**
+* @file queryServer.hpp
+* @author Ondrej
+* @brief Answers path queries over loaded maps, line protocol over any pair of file descriptors
+*
+* Protocol (one request per line, responses may come in different order, they start with the number of the request
+* on the connection, counted from 0, empty lines are ignored):
+* - "<map> <start x> <start y> <goal x> <goal y> <algorithm>"
+*   -> "<n> ok <path length> <visited> <microseconds> <x,y;x,y;...>" or "<n> error <message>"
+* - "<map> <start x> <start y> nearest <k> <algorithm> [<goal x> <goal y>]..." (bfs or astar, goals of the map if none
+*   are given) -> "<n> ok <goals found> <visited> <microseconds> <path>|<path>|..." nearest k goals found by one search,
+*   from the nearest one, every path is "x,y;x,y;..." from the start to its goal
+* - "stats" -> "<n> stats count=<queries> p50=<us> p90=<us> p99=<us> p999=<us> max=<us>"
+*   latency is measured from reading the line to the finished response, over the last latencySamples queries
+**/
+
+#pragma once
+
+#include "mapRegistry.hpp"
+#include "searchSession.hpp"
+#include "threadPool.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+class QueryServer
+{
+public:
+    /** Requests of one connection that may wait for a worker, reading stops until some are answered */
+    static const size_t maxInFlight = 1024;
+
+    /** Latency percentiles are computed from this many last queries */
+    static const size_t latencySamples = 1 << 16;
+
+    /** Threads answering queries, 0 means one per hardware thread */
+    explicit QueryServer(size_t threads = 0);
+
+    QueryServer(const QueryServer &) = delete;
+    QueryServer &operator=(const QueryServer &) = delete;
+
+    /** Registers map that queries refer to by name, it is loaded by preload or by the first query, false if the name is taken */
+    bool addMap(const std::string &name, const std::string &path) { return m_maps.add(name, path); }
+
+    /** Registers every file of the directory under its file name, returns number of registered maps */
+    size_t addDirectory(const std::string &directory) { return m_maps.addDirectory(directory); }
+
+    /** Loads all registered maps in parallel, returns messages of maps that failed */
+    std::vector<std::string> preload(void) { return m_maps.loadAll(); }
+
+    /** Preprocessing BFS and A* queries use, set before serving */
+    void setReduction(SearchReduction reduction) { m_reduction = reduction; }
+
+    /** Bound of weighted A* and focal search queries, set before serving */
+    void setSuboptimality(double suboptimality) { m_suboptimality = suboptimality; }
+
+    /** Registered maps and their memory */
+    const MapRegistry &maps(void) const { return m_maps; }
+
+    /** Answers requests read from input until end of input, returns after all responses were written */
+    void serve(int input, int output);
+
+    /** Accepts connections on Unix domain socket until stop is called, false if the socket cannot be created */
+    bool listen(const std::string &socketPath);
+
+    /** Makes listen return (safe to call from signal handler) */
+    void stop(void) { m_stopping.store(true); }
+
+    /** Response to "stats" without the request number */
+    std::string latencyReport(void);
+
+private:
+    /** Output side of one connection */
+    struct Connection
+    {
+        int output;
+        std::mutex writeMutex;
+        std::mutex mutex;
+        std::condition_variable answered;
+        size_t inFlight = 0;
+    };
+
+    /** Parses and runs one query, returns response without the request number */
+    std::string answer(const std::string &line);
+
+    /** Writes whole line, responses of different workers do not interleave */
+    void respond(Connection &connection, size_t request, const std::string &response);
+
+    /** Records latency of one query */
+    void addLatency(double microseconds);
+
+    MapRegistry m_maps;
+
+    SearchReduction m_reduction = SearchReduction::None;
+
+    double m_suboptimality = defaultSuboptimality;
+
+    std::mutex m_idleMutex;
+
+    /** Idle sessions of every loaded map (names of duplicate maps share them), one session answers one query at a time */
+    std::map<const GridMap *, std::vector<std::unique_ptr<SearchSession>>> m_idle;
+
+    ThreadPool m_pool;
+
+    std::atomic<bool> m_stopping{false};
+
+    std::mutex m_latencyMutex;
+
+    /** Ring of the last latencies */
+    std::vector<double> m_latencies;
+
+    size_t m_queries = 0;
+};
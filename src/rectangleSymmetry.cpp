@@ -0,0 +1,85 @@
+/**
+* @file rectangleSymmetry.cpp
+* @author Ondrej
+* @brief Implementation of the rectangle decomposition
+**/
+
+#include "rectangleSymmetry.hpp"
+
+RectangleDecomposition::RectangleDecomposition(const SearchGrid &grid) : m_rectangleOf(grid.size(), none)
+{
+    int width = static_cast<int>(grid.width());
+    int height = static_cast<int>(grid.height());
+    auto free = [&](int x, int y) { return grid.passable(x, y) && m_rectangleOf[grid.index(x, y)] == none; };
+
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            if (!free(x, y))
+                continue;
+
+            /* Growing in turns keeps the rectangles close to squares, which have the most interior cells */
+            Rectangle rectangle{x, y, x, y};
+            bool right = true;
+            bool down = true;
+            while (right || down)
+            {
+                if (right)
+                {
+                    for (int row = rectangle.y0; row <= rectangle.y1 && right; row++)
+                        right = free(rectangle.x1 + 1, row);
+                    rectangle.x1 += right;
+                }
+                if (down)
+                {
+                    for (int column = rectangle.x0; column <= rectangle.x1 && down; column++)
+                        down = free(column, rectangle.y1 + 1);
+                    rectangle.y1 += down;
+                }
+            }
+
+            uint32_t id = static_cast<uint32_t>(m_rectangles.size());
+            for (int row = rectangle.y0; row <= rectangle.y1; row++)
+            {
+                for (int column = rectangle.x0; column <= rectangle.x1; column++)
+                    m_rectangleOf[grid.index(column, row)] = id;
+            }
+            m_rectangles.push_back(rectangle);
+            m_interiorCells += static_cast<size_t>(std::max(0, rectangle.x1 - rectangle.x0 - 1)) * std::max(0, rectangle.y1 - rectangle.y0 - 1);
+        }
+    }
+}
+
+RectangleGrid::RectangleGrid(const SearchGrid &grid, const RectangleDecomposition &rectangles, Position goal)
+    : m_grid(grid), m_rectangles(rectangles), m_goal(goal)
+{
+    if (grid.passable(goal.first, goal.second))
+        m_goalRectangle = this->interiorOf(goal.first, goal.second);
+}
+
+void expandRectanglePath(SearchPath &path)
+{
+    if (path.size() < 2)
+        return;
+
+    SearchPath expanded(path.get_allocator());
+    expanded.push_back(path.front());
+    for (size_t i = 1; i < path.size(); i++)
+    {
+        /* Rectangle between the two positions is empty, any monotone walk stays in it */
+        Position pos = expanded.back();
+        Position next = path[i];
+        while (pos.first != next.first)
+        {
+            pos.first += pos.first < next.first ? 1 : -1;
+            expanded.push_back(pos);
+        }
+        while (pos.second != next.second)
+        {
+            pos.second += pos.second < next.second ? 1 : -1;
+            expanded.push_back(pos);
+        }
+    }
+    path = std::move(expanded);
+}
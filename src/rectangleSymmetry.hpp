@@ -0,0 +1,200 @@
+/**
+* @file rectangleSymmetry.hpp
+* @author Ondrej
+* @brief Rectangular symmetry reduction, searches over empty rectangles skip their interiors
+*
+* Free cells are decomposed into empty rectangles. Cells strictly inside a rectangle are never expanded, a cell on the
+* perimeter jumps straight across the rectangle to the opposite side instead. Every path through the interior has an
+* equally long one along the perimeter and the jumps, so BFS (run as uniform cost search, the jumps cost more than one
+* step) and A* over the reduced grid still find shortest 4-connected paths.
+**/
+
+#pragma once
+
+#include "graph.hpp"
+#include "gridMap.hpp"
+#include "searchKernel.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+
+/** Empty rectangle, corners included */
+struct Rectangle
+{
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+
+    /** Strictly inside, not on the perimeter */
+    bool interior(int x, int y) const { return x > x0 && x < x1 && y > y0 && y < y1; }
+};
+
+/** Free cells of a map split into empty rectangles, built once per map (GridMap::rectangles) */
+class RectangleDecomposition
+{
+public:
+    /** Rectangle of walls */
+    static constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+
+    /** Grows every rectangle from its top left cell right and down in turns while whole columns and rows are free */
+    explicit RectangleDecomposition(const SearchGrid &grid);
+
+    size_t size(void) const { return m_rectangles.size(); }
+
+    const Rectangle &rectangle(uint32_t id) const { return m_rectangles[id]; }
+
+    /** Rectangle containing the cell of the grid, none for walls */
+    uint32_t rectangleOf(uint32_t cell) const { return m_rectangleOf[cell]; }
+
+    /** Cells the searches never expand */
+    size_t interiorCells(void) const { return m_interiorCells; }
+
+    size_t bytes(void) const { return m_rectangles.capacity() * sizeof(Rectangle) + m_rectangleOf.capacity() * sizeof(uint32_t); }
+
+private:
+    std::vector<Rectangle> m_rectangles;
+
+    std::vector<uint32_t> m_rectangleOf;
+
+    size_t m_interiorCells = 0;
+};
+
+/** Grid of one reduced search, the decomposition with the goal of the search (it may lie inside a rectangle) */
+class RectangleGrid
+{
+public:
+    RectangleGrid(const SearchGrid &grid, const RectangleDecomposition &rectangles, Position goal);
+
+    uint32_t width(void) const { return m_grid.width(); }
+
+    uint32_t height(void) const { return m_grid.height(); }
+
+    size_t size(void) const { return m_grid.size(); }
+
+    uint32_t index(int x, int y) const { return m_grid.index(x, y); }
+
+    Position position(uint32_t cell) const { return m_grid.position(cell); }
+
+    bool inside(int x, int y) const { return m_grid.inside(x, y); }
+
+    bool passable(int x, int y) const { return m_grid.passable(x, y); }
+
+    bool passable(uint32_t cell) const { return m_grid.passable(cell); }
+
+    /** Rectangle of the cell if the cell is inside it, none for perimeter cells and walls */
+    uint32_t interiorOf(int x, int y) const
+    {
+        uint32_t id = m_rectangles.rectangleOf(this->index(x, y));
+        return id != RectangleDecomposition::none && m_rectangles.rectangle(id).interior(x, y) ? id : RectangleDecomposition::none;
+    }
+
+    const RectangleDecomposition &rectangles(void) const { return m_rectangles; }
+
+    Position goal(void) const { return m_goal; }
+
+    /** Rectangle the goal is inside, none if the goal is on a perimeter or outside the free cells */
+    uint32_t goalRectangle(void) const { return m_goalRectangle; }
+
+private:
+    const SearchGrid &m_grid;
+
+    const RectangleDecomposition &m_rectangles;
+
+    Position m_goal;
+
+    uint32_t m_goalRectangle = RectangleDecomposition::none;
+};
+
+/**
+* @brief Neighbourhood of the reduced search, costs are the numbers of 4-connected steps
+* - Perimeter cell: its 4 neighbours except interior ones, the cell straight across the rectangle and the goal if it is
+*   inside this rectangle in the same row or column
+* - Interior cell (only the start): the 4 perimeter cells straight from it and the goal if it is in the same rectangle
+**/
+struct RectangleSymmetry
+{
+    template <typename Visit>
+    static void forEach(const RectangleGrid &grid, int x, int y, Visit &&visit)
+    {
+        const RectangleDecomposition &rectangles = grid.rectangles();
+        Position goal = grid.goal();
+        auto toGoal = [&]() {
+            visit(goal.first, goal.second, std::abs(goal.first - x) + std::abs(goal.second - y));
+        };
+
+        uint32_t id = grid.passable(x, y) ? rectangles.rectangleOf(grid.index(x, y)) : RectangleDecomposition::none;
+        if (id == RectangleDecomposition::none)
+        {
+            /* Start on a wall, walls never border interiors */
+            FourConnected::forEach(grid, x, y, visit);
+            return;
+        }
+
+        const Rectangle &rectangle = rectangles.rectangle(id);
+        if (rectangle.interior(x, y))
+        {
+            if (id == grid.goalRectangle())
+                toGoal();
+            visit(rectangle.x0, y, x - rectangle.x0);
+            visit(rectangle.x1, y, rectangle.x1 - x);
+            visit(x, rectangle.y0, y - rectangle.y0);
+            visit(x, rectangle.y1, rectangle.y1 - y);
+            return;
+        }
+
+        FourConnected::forEach(grid, x, y, [&](int nextX, int nextY, double cost) {
+            if (grid.interiorOf(nextX, nextY) == RectangleDecomposition::none)
+                visit(nextX, nextY, cost);
+        });
+
+        /* Jumps skip at least one interior cell */
+        if (y > rectangle.y0 && y < rectangle.y1 && rectangle.x1 - rectangle.x0 >= 2)
+        {
+            if (x == rectangle.x0)
+                visit(rectangle.x1, y, rectangle.x1 - rectangle.x0);
+            else if (x == rectangle.x1)
+                visit(rectangle.x0, y, rectangle.x1 - rectangle.x0);
+        }
+        if (x > rectangle.x0 && x < rectangle.x1 && rectangle.y1 - rectangle.y0 >= 2)
+        {
+            if (y == rectangle.y0)
+                visit(x, rectangle.y1, rectangle.y1 - rectangle.y0);
+            else if (y == rectangle.y1)
+                visit(x, rectangle.y0, rectangle.y1 - rectangle.y0);
+        }
+
+        if (id == grid.goalRectangle() && (x == goal.first || y == goal.second))
+            toGoal();
+    }
+};
+
+/** Fills the cells skipped by the jumps of path, consecutive positions lie in one empty rectangle */
+void expandRectanglePath(SearchPath &path);
+
+/**
+* @brief BFS and A* over the rectangle decomposition of the map (built on the first use), other algorithms run unreduced
+* - BFS is uniform cost search over the reduced grid, it finds a path as short as BFS, not necessarily the same one
+* - Trace receives only the expanded cells, path receives every cell
+**/
+template <typename Trace>
+KernelStats runRectangleAlgorithm(SearchAlgorithmType algoType, const GridMap &map, SearchWorkspace &work, Trace &trace, Position start,
+                                  Position goal, SearchPath *path, double suboptimality = defaultSuboptimality)
+{
+    if (algoType != SearchAlgorithmType::BFS && algoType != SearchAlgorithmType::AStar)
+        return runAlgorithm(algoType, map.searchGrid(), work, trace, start, goal, path, suboptimality);
+
+    RectangleGrid grid(map.searchGrid(), map.rectangles(), goal);
+    ZeroHeuristic zero;
+    ManhattanHeuristic manhattan;
+    KernelStats stats = algoType == SearchAlgorithmType::BFS
+                            ? searchKernel<RectangleSymmetry, ZeroHeuristic, BestFirstOpen<AStarKey>>(grid, work, zero, trace, start, goal, path)
+                            : searchKernel<RectangleSymmetry, ManhattanHeuristic, BestFirstOpen<AStarKey>>(grid, work, manhattan, trace, start,
+                                                                                                           goal, path);
+    if (path)
+        expandRectanglePath(*path);
+    return stats;
+}
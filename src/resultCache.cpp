@@ -0,0 +1,435 @@
+/**
+* @file resultCache.cpp
+* @author Ondrej
+* @brief Implementation of ResultCache and SearchResult
+**/
+
+#include "resultCache.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+/** Extension of result files, other files in the directory are never touched */
+const std::string resultExtension = ".result";
+
+/** Header of the result file */
+struct ResultHeader
+{
+    char magic[8];
+    SearchKey key;
+    uint64_t visited;
+    uint64_t events;
+    uint64_t pathLength;
+};
+
+const char resultMagic[8] = {'G', 'V', 'R', 'E', 'S', 'L', 'T', '1'};
+
+uint64_t SearchKey::hash(void) const
+{
+    uint64_t hash = 14695981039346656037ull;
+    auto add = [&hash](uint64_t value) {
+        for (int i = 0; i < 8; i++)
+        {
+            hash ^= (value >> (8 * i)) & 0xff;
+            hash *= 1099511628211ull;
+        }
+    };
+
+    add(mapHash);
+    add(parameters);
+    add(algoType);
+    add(static_cast<uint32_t>(startX));
+    add(static_cast<uint32_t>(startY));
+    add(static_cast<uint32_t>(endX));
+    add(static_cast<uint32_t>(endY));
+    return hash;
+}
+
+SearchKey searchKey(const Graph &graph, SearchAlgorithmType algoType, uint64_t parameters)
+{
+    SearchKey key;
+    key.mapHash = graph.mapHash();
+    key.parameters = parameters;
+    if (isBoundedAlgorithm(algoType))
+        key.parameters ^= std::bit_cast<uint64_t>(graph.suboptimality());
+    if (graph.subgoals() && (algoType == SearchAlgorithmType::BFS || algoType == SearchAlgorithmType::AStar))
+        key.parameters ^= subgoalSearch;
+    key.algoType = static_cast<uint32_t>(algoType);
+    key.startX = graph.startPos().first;
+    key.startY = graph.startPos().second;
+    key.endX = graph.endPos().first;
+    key.endY = graph.endPos().second;
+    return key;
+}
+
+bool isCacheableAlgorithm(SearchAlgorithmType algoType)
+{
+    return algoType != SearchAlgorithmType::RandomSearch;
+}
+
+/** Keeps events of the search, stops the search when cancel is set */
+class ResultRecorder : public SearchListener
+{
+public:
+    explicit ResultRecorder(const std::atomic<bool> &cancel) : m_cancel(cancel) {};
+
+    void visited(Position pos) override { events.push_back(SearchEvent{SearchEvent::Type::Visit, pos.first, pos.second}); }
+
+    void opened(Position, Position to) override { events.push_back(SearchEvent{SearchEvent::Type::Open, to.first, to.second}); }
+
+    bool cancelled(void) override { return m_cancel.load(std::memory_order_relaxed); }
+
+    std::vector<SearchEvent> events;
+
+private:
+    const std::atomic<bool> &m_cancel;
+};
+
+std::shared_ptr<const SearchResult> computeResult(Graph &graph, const std::atomic<bool> &cancel)
+{
+    ResultRecorder recorder(cancel);
+    graph.reset();
+    graph.setListener(&recorder);
+    graph.setUp(-1);
+    graph.setListener(nullptr);
+
+    if (cancel.load())
+        return nullptr;
+
+    std::vector<Position> path(graph.path().begin(), graph.path().end());
+    return std::make_shared<const SearchResult>(std::move(recorder.events), std::move(path));
+}
+
+SearchResult::SearchResult(std::vector<SearchEvent> events, std::vector<Position> path)
+    : m_ownedEvents(std::move(events)),
+      m_path(std::move(path))
+{
+    m_events = m_ownedEvents.data();
+    m_eventCount = m_ownedEvents.size();
+    m_visited = std::count_if(m_ownedEvents.begin(), m_ownedEvents.end(),
+                              [](const SearchEvent &event) { return event.type == SearchEvent::Type::Visit; });
+}
+
+SearchResult::~SearchResult()
+{
+    if (m_mapping)
+        munmap(m_mapping, m_mappingSize);
+}
+
+/** Events stay in the mapping, only the (short) path is copied */
+std::shared_ptr<const SearchResult> SearchResult::load(const std::string &file, const SearchKey &key)
+{
+    int fd = open(file.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(ResultHeader))
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    size_t size = static_cast<size_t>(info.st_size);
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+        return nullptr;
+
+    /* Result owns the mapping from now on, returning nullptr unmaps it */
+    std::shared_ptr<SearchResult> result(new SearchResult());
+    result->m_mapping = mapping;
+    result->m_mappingSize = size;
+
+    ResultHeader header;
+    std::memcpy(&header, mapping, sizeof(header));
+    if (std::memcmp(header.magic, resultMagic, sizeof(resultMagic)) != 0 || !(header.key == key))
+        return nullptr;
+
+    size_t eventsBytes = header.events * sizeof(SearchEvent);
+    size_t pathBytes = header.pathLength * 2 * sizeof(int32_t);
+    if (header.events > size / sizeof(SearchEvent) || header.pathLength > size || sizeof(header) + eventsBytes + pathBytes != size)
+        return nullptr;
+
+    const char *data = static_cast<const char *>(mapping) + sizeof(header);
+    result->m_events = reinterpret_cast<const SearchEvent *>(data);
+    result->m_eventCount = header.events;
+    result->m_visited = header.visited;
+
+    const char *pathData = data + eventsBytes;
+    result->m_path.resize(header.pathLength);
+    for (size_t i = 0; i < header.pathLength; i++)
+    {
+        int32_t coordinates[2];
+        std::memcpy(coordinates, pathData + i * sizeof(coordinates), sizeof(coordinates));
+        result->m_path[i] = Position(coordinates[0], coordinates[1]);
+    }
+
+    return result;
+}
+
+bool SearchResult::save(const std::string &file, const SearchKey &key) const
+{
+    ResultHeader header{};
+    std::memcpy(header.magic, resultMagic, sizeof(resultMagic));
+    header.key = key;
+    header.visited = m_visited;
+    header.events = m_eventCount;
+    header.pathLength = m_path.size();
+
+    /* Unique among processes and threads saving the same key */
+    static std::atomic<size_t> saveCounter{0};
+    std::string temporary = file + ".tmp" + std::to_string(getpid()) + "-" + std::to_string(saveCounter++);
+    {
+        std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+        output.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        output.write(reinterpret_cast<const char *>(m_events), m_eventCount * sizeof(SearchEvent));
+        for (const Position &pos: m_path)
+        {
+            int32_t coordinates[2] = {pos.first, pos.second};
+            output.write(reinterpret_cast<const char *>(coordinates), sizeof(coordinates));
+        }
+
+        if (!output)
+        {
+            output.close();
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+
+    return std::rename(temporary.c_str(), file.c_str()) == 0;
+}
+
+ResultCache::ResultCache(const std::string &directory, size_t memoryLimit, size_t diskLimit)
+    : m_directory(directory),
+      m_memoryLimit(memoryLimit),
+      m_diskLimit(diskLimit)
+{
+    /* Disk store is silently disabled if the directory cannot be created */
+    std::error_code error;
+    if (!m_directory.empty() && !fs::create_directories(m_directory, error) && !fs::is_directory(m_directory, error))
+        m_directory.clear();
+    if (!m_directory.empty())
+        m_diskBytes = this->diskBytes();
+}
+
+std::shared_ptr<const SearchResult> ResultCache::find(const SearchKey &key)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        auto found = m_index.find(key);
+        if (found != m_index.end())
+        {
+            m_recent.splice(m_recent.begin(), m_recent, found->second);
+            m_stats.memoryHits++;
+            return found->second->second;
+        }
+    }
+
+    /* File is mapped and touched outside of the lock, other threads keep finding results in memory meanwhile */
+    std::shared_ptr<const SearchResult> result;
+    if (!m_directory.empty())
+    {
+        std::string file = this->filePath(key);
+        result = SearchResult::load(file, key);
+        if (result)
+        {
+            /* Modification time orders files for eviction */
+            std::error_code error;
+            fs::last_write_time(file, fs::file_time_type::clock::now(), error);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!result)
+    {
+        m_stats.misses++;
+        return nullptr;
+    }
+
+    /* Another thread may have loaded or inserted the key meanwhile, its result is shared */
+    m_stats.diskHits++;
+    auto found = m_index.find(key);
+    if (found != m_index.end())
+    {
+        m_recent.splice(m_recent.begin(), m_recent, found->second);
+        return found->second->second;
+    }
+
+    this->remember(key, result);
+    return result;
+}
+
+bool ResultCache::contains(const SearchKey &key)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_index.count(key) > 0)
+            return true;
+    }
+
+    std::error_code error;
+    return !m_directory.empty() && fs::exists(this->filePath(key), error);
+}
+
+void ResultCache::insert(const SearchKey &key, std::shared_ptr<const SearchResult> result)
+{
+    /* File of the same key is overwritten, its old size is not in the directory any more */
+    size_t written = 0;
+    size_t replaced = 0;
+    if (!m_directory.empty() && result->bytes() <= m_diskLimit)
+    {
+        std::error_code error;
+        std::string file = this->filePath(key);
+        size_t old = fs::file_size(file, error);
+        replaced = error ? 0 : old;
+        if (result->save(file, key))
+        {
+            size_t size = fs::file_size(file, error);
+            written = error ? 0 : size;
+        }
+        else
+            replaced = 0;
+    }
+
+    bool overLimit;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_diskBytes = m_diskBytes + written - std::min(replaced, m_diskBytes + written);
+        overLimit = written > 0 && m_diskBytes > m_diskLimit;
+        this->remember(key, std::move(result));
+    }
+
+    /* Only one thread scans the directory, the others keep inserting and finding meanwhile */
+    std::unique_lock<std::mutex> trimming(m_trimMutex, std::try_to_lock);
+    if (!overLimit || !trimming.owns_lock())
+        return;
+    size_t removed = 0;
+    size_t left = this->trimDisk(removed);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_diskBytes = left;
+    m_stats.filesRemoved += removed;
+}
+
+CacheStats ResultCache::stats(void)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+size_t ResultCache::memoryBytes(void)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_memoryBytes;
+}
+
+void ResultCache::remember(const SearchKey &key, std::shared_ptr<const SearchResult> result)
+{
+    auto found = m_index.find(key);
+    if (found != m_index.end())
+    {
+        m_memoryBytes -= found->second->second->bytes();
+        m_recent.erase(found->second);
+        m_index.erase(found);
+    }
+
+    /* Result that does not fit at all is not kept, it would only push out everything else */
+    if (result->bytes() > m_memoryLimit)
+        return;
+
+    m_memoryBytes += result->bytes();
+    m_recent.emplace_front(key, std::move(result));
+    m_index[key] = m_recent.begin();
+
+    while (m_memoryBytes > m_memoryLimit)
+    {
+        m_memoryBytes -= m_recent.back().second->bytes();
+        m_index.erase(m_recent.back().first);
+        m_recent.pop_back();
+        m_stats.evicted++;
+    }
+}
+
+size_t ResultCache::diskBytes(void) const
+{
+    std::error_code error;
+    size_t total = 0;
+    for (const auto &entry: fs::directory_iterator(m_directory, error))
+    {
+        if (!entry.is_regular_file(error) || entry.path().extension() != resultExtension)
+            continue;
+        size_t size = entry.file_size(error);
+        if (!error)
+            total += size;
+    }
+    return total;
+}
+
+size_t ResultCache::trimDisk(size_t &removed) const
+{
+    struct CacheFile
+    {
+        fs::file_time_type time;
+        size_t size;
+        fs::path path;
+    };
+
+    std::error_code error;
+    std::vector<CacheFile> files;
+    size_t total = 0;
+
+    for (const auto &entry: fs::directory_iterator(m_directory, error))
+    {
+        if (!entry.is_regular_file(error) || entry.path().extension() != resultExtension)
+            continue;
+
+        size_t size = entry.file_size(error);
+        if (error)
+            continue;
+        total += size;
+        files.push_back({entry.last_write_time(error), size, entry.path()});
+    }
+
+    if (total <= m_diskLimit)
+        return total;
+
+    /* Oldest first, mapped files stay readable until they are unmapped; trimmed a tenth under the limit, so the next
+       scan is not due at the next insert */
+    size_t target = m_diskLimit - m_diskLimit / 10;
+    std::sort(files.begin(), files.end(), [](const CacheFile &a, const CacheFile &b) { return a.time < b.time; });
+    for (const auto &file: files)
+    {
+        if (total <= target)
+            break;
+
+        if (fs::remove(file.path, error))
+        {
+            total -= file.size;
+            removed++;
+        }
+    }
+    return total;
+}
+
+std::string ResultCache::filePath(const SearchKey &key) const
+{
+    std::ostringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << key.hash() << resultExtension;
+    return (fs::path(m_directory) / name.str()).string();
+}
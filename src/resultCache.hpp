@@ -0,0 +1,196 @@
+/**
+* @file resultCache.hpp
+* @author Ondrej
+* @brief Cache of finished searches (steps and path), kept in memory and in files that survive restarts
+*
+* File of one result (native byte order, the cache is local to the machine):
+* - 8 bytes magic "GVRESLT1", SearchKey, uint64 visited, uint64 events, uint64 path length
+* - events as SearchEvent array, path as pairs of int32
+* Files are named by the hash of the key, the whole key in the header decides whether the file belongs to the key.
+**/
+
+#pragma once
+
+#include "graph.hpp"
+#include "searchWorker.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+/** Everything the result of the search depends on */
+struct SearchKey
+{
+    uint64_t mapHash = 0;
+    /** Parameters of the algorithm that change its result, 0 if it has none */
+    uint64_t parameters = 0;
+    uint32_t algoType = 0;
+    int32_t startX = 0;
+    int32_t startY = 0;
+    int32_t endX = 0;
+    int32_t endY = 0;
+
+    bool operator==(const SearchKey &other) const = default;
+
+    /** FNV-1a of all fields */
+    uint64_t hash(void) const;
+};
+
+struct SearchKeyHash
+{
+    size_t operator()(const SearchKey &key) const { return static_cast<size_t>(key.hash()); }
+};
+
+/** Parameters of BFS and A* over the subgoal graph (Graph::setSubgoals), they take other steps than over all cells */
+constexpr uint64_t subgoalSearch = 1ull << 63;
+
+/** Key of the search of algoType over map, start and end of the graph, the suboptimality of the graph is added to the
+    parameters of weighted A* and focal search, subgoalSearch to the parameters of BFS and A* over the subgoal graph */
+SearchKey searchKey(const Graph &graph, SearchAlgorithmType algoType, uint64_t parameters = 0);
+
+/** Random search takes different steps every run, replaying one run would hide that */
+bool isCacheableAlgorithm(SearchAlgorithmType algoType);
+
+class SearchResult;
+
+/** Runs the search of the graph without visualisation and records its events, nullptr if cancel was set */
+std::shared_ptr<const SearchResult> computeResult(Graph &graph, const std::atomic<bool> &cancel);
+
+/** Steps and path of one finished search, events are either owned or mapped read only from the cache file */
+class SearchResult
+{
+public:
+    SearchResult(std::vector<SearchEvent> events, std::vector<Position> path);
+
+    ~SearchResult();
+
+    SearchResult(const SearchResult &) = delete;
+    SearchResult &operator=(const SearchResult &) = delete;
+
+    /** Maps the file, returns nullptr if it is missing, damaged or stores other key */
+    static std::shared_ptr<const SearchResult> load(const std::string &file, const SearchKey &key);
+
+    /** Writes the file through temporary file, so other processes never see it half written */
+    bool save(const std::string &file, const SearchKey &key) const;
+
+    /** Visit and Open events in the order the search produced them, without Done */
+    const SearchEvent *events(void) const { return m_events; }
+
+    size_t eventCount(void) const { return m_eventCount; }
+
+    /** Number of Visit events */
+    size_t visitedCount(void) const { return m_visited; }
+
+    /** From start to end, empty if there is no path */
+    const std::vector<Position> &path(void) const { return m_path; }
+
+    /** Memory taken by events and path */
+    size_t bytes(void) const { return m_eventCount * sizeof(SearchEvent) + m_path.size() * sizeof(Position); }
+
+private:
+    SearchResult() = default;
+
+    std::vector<SearchEvent> m_ownedEvents;
+
+    const SearchEvent *m_events = nullptr;
+
+    size_t m_eventCount = 0;
+
+    size_t m_visited = 0;
+
+    std::vector<Position> m_path;
+
+    /** Mapped file, events point into it */
+    void *m_mapping = nullptr;
+
+    size_t m_mappingSize = 0;
+};
+
+/** Hits and misses since the cache was created */
+struct CacheStats
+{
+    size_t memoryHits = 0;
+    size_t diskHits = 0;
+    size_t misses = 0;
+    size_t evicted = 0;
+    size_t filesRemoved = 0;
+};
+
+/**
+* @brief Two level cache of search results
+* - Memory: results of this session, least recently used ones are dropped over the memory limit
+* - Disk: one file per result in the directory, files are memory mapped when found,
+*   least recently used files (modification time is updated on every hit) are removed over the disk limit
+* - Methods may be called from any thread, files are written, loaded and the directory is trimmed outside of the
+*   lock; the size of the directory is counted as files are written, it is scanned only when it grows over the limit
+**/
+class ResultCache
+{
+public:
+    static const size_t defaultMemoryLimit = 256ull << 20;
+
+    static const size_t defaultDiskLimit = 1024ull << 20;
+
+    /** Empty directory keeps results only in memory */
+    explicit ResultCache(const std::string &directory, size_t memoryLimit = defaultMemoryLimit, size_t diskLimit = defaultDiskLimit);
+
+    /** Result from memory or disk, nullptr if the search has to run */
+    std::shared_ptr<const SearchResult> find(const SearchKey &key);
+
+    /** True if find would return the result, does not count as use */
+    bool contains(const SearchKey &key);
+
+    /** Stores result in memory and on disk */
+    void insert(const SearchKey &key, std::shared_ptr<const SearchResult> result);
+
+    /** False if both limits are zero (or there is no directory and no memory), inserted results are dropped at once */
+    bool keepsResults(void) const { return m_memoryLimit > 0 || (!m_directory.empty() && m_diskLimit > 0); }
+
+    CacheStats stats(void);
+
+    /** Memory taken by results kept in memory */
+    size_t memoryBytes(void);
+
+private:
+    /** Keeps result in memory as the most recently used one, drops old ones over the limit */
+    void remember(const SearchKey &key, std::shared_ptr<const SearchResult> result);
+
+    /** Bytes of the result files in the directory */
+    size_t diskBytes(void) const;
+
+    /** Removes least recently used files until the directory fits under the limit with some room, returns the bytes
+        left; removed counts the removed files */
+    size_t trimDisk(size_t &removed) const;
+
+    std::string filePath(const SearchKey &key) const;
+
+    std::string m_directory;
+
+    size_t m_memoryLimit;
+
+    size_t m_diskLimit;
+
+    /** Most recently used first */
+    std::list<std::pair<SearchKey, std::shared_ptr<const SearchResult>>> m_recent;
+
+    std::unordered_map<SearchKey, decltype(m_recent)::iterator, SearchKeyHash> m_index;
+
+    size_t m_memoryBytes = 0;
+
+    /** Bytes of the result files, counted since the last scan of the directory */
+    size_t m_diskBytes = 0;
+
+    CacheStats m_stats;
+
+    /** Guards everything above except the constant directory and limits */
+    std::mutex m_mutex;
+
+    /** Held by the thread trimming the directory, others skip trimming meanwhile */
+    std::mutex m_trimMutex;
+};
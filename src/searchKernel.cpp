@@ -0,0 +1,33 @@
+/**
+* @file searchKernel.cpp
+* @author Ondrej
+* @brief Implementation of BasicSearchGrid, the kernel itself is a template in the header
+**/
+
+#include "searchKernel.hpp"
+
+/** Length of the longest row */
+static uint32_t gridWidth(const MapGrid &grid)
+{
+    uint32_t width = 0;
+    for (const auto &row: grid)
+        width = std::max(width, static_cast<uint32_t>(row.size()));
+    return width;
+}
+
+template <typename Layout>
+BasicSearchGrid<Layout>::BasicSearchGrid(const MapGrid &grid)
+    : m_width(gridWidth(grid)), m_height(static_cast<uint32_t>(grid.size())), m_layout(m_width, m_height)
+{
+    /* Same cells as Graph::Adjacent accepts, trees block too */
+    m_cells.assign(m_layout.size(), 0);
+    for (uint32_t y = 0; y < m_height; y++)
+    {
+        for (uint32_t x = 0; x < grid[y].size(); x++)
+            m_cells[this->index(x, y)] = grid[y][x] == 1;
+    }
+}
+
+template class BasicSearchGrid<RowMajorLayout>;
+template class BasicSearchGrid<MortonLayout>;
+template class BasicSearchGrid<BlockedLayout<8>>;
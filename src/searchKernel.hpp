@@ -0,0 +1,1006 @@
+/**
+* @file searchKernel.hpp
+* @author Ondrej
+* @brief Grid search template specialised at compile time by neighbourhood, heuristic, open list and tracing
+*
+* Every algorithm of Graph is an instantiation of searchKernel (see runAlgorithm). Cells live in flat arrays ordered by
+* the layout of the grid (row-major, Morton or tiles) and the workspace is reset in O(1), so repeated searches neither
+* allocate nor touch std::map. Nothing here needs SFML.
+**/
+
+#pragma once
+
+#include "graph.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <random>
+#include <vector>
+
+
+/* Cell layout policies, they map (x, y) of width x height grid to the index of the cell in the flat arrays of the grid
+   and of the workspace and back, size is the length of the arrays (layouts may pad the grid) */
+
+/** Rows one after another, horizontal neighbours are adjacent, vertical ones a whole row apart */
+class RowMajorLayout
+{
+public:
+    RowMajorLayout(uint32_t width, uint32_t height) : m_width(width), m_height(height) {};
+
+    size_t size(void) const { return static_cast<size_t>(m_width) * m_height; }
+
+    uint32_t index(int x, int y) const { return static_cast<uint32_t>(y) * m_width + static_cast<uint32_t>(x); }
+
+    Position position(uint32_t cell) const { return Position(cell % m_width, cell / m_width); }
+
+private:
+    uint32_t m_width;
+
+    uint32_t m_height;
+};
+
+/**
+* @brief Z-order curve, bits of x and y are interleaved, so cells close in both directions are close in memory
+* - Both sides are padded to a power of two, high bits of the longer side that have no pair follow the interleaved ones
+**/
+class MortonLayout
+{
+public:
+    MortonLayout(uint32_t width, uint32_t height) : m_bitsX(bits(width)), m_bitsY(bits(height))
+    {
+        m_shared = std::min(m_bitsX, m_bitsY);
+        m_lowMask = (uint64_t(1) << (2 * m_shared)) - 1;
+    };
+
+    size_t size(void) const { return size_t(1) << (m_bitsX + m_bitsY); }
+
+    uint32_t index(int x, int y) const
+    {
+        uint32_t ux = static_cast<uint32_t>(x);
+        uint32_t uy = static_cast<uint32_t>(y);
+        uint32_t low = spread(ux & ((1u << m_shared) - 1)) | (spread(uy & ((1u << m_shared) - 1)) << 1);
+        uint32_t high = (m_bitsX > m_bitsY ? ux : uy) >> m_shared;
+        return low | (high << (2 * m_shared));
+    }
+
+    Position position(uint32_t cell) const
+    {
+        uint32_t low = static_cast<uint32_t>(cell & m_lowMask);
+        uint32_t high = m_shared == 16 ? 0 : cell >> (2 * m_shared);
+        uint32_t x = compact(low);
+        uint32_t y = compact(low >> 1);
+        if (m_bitsX > m_bitsY)
+            x |= high << m_shared;
+        else
+            y |= high << m_shared;
+        return Position(x, y);
+    }
+
+private:
+    /** Bits needed for coordinates below size */
+    static uint32_t bits(uint32_t size)
+    {
+        uint32_t bits = 0;
+        while ((uint64_t(1) << bits) < size)
+            bits++;
+        return bits;
+    }
+
+    /** Moves bit i of 16 bit value to bit 2 i */
+    static uint32_t spread(uint32_t value)
+    {
+        value &= 0x0000FFFF;
+        value = (value | (value << 8)) & 0x00FF00FF;
+        value = (value | (value << 4)) & 0x0F0F0F0F;
+        value = (value | (value << 2)) & 0x33333333;
+        value = (value | (value << 1)) & 0x55555555;
+        return value;
+    }
+
+    /** Inverse of spread, takes even bits */
+    static uint32_t compact(uint32_t value)
+    {
+        value &= 0x55555555;
+        value = (value | (value >> 1)) & 0x33333333;
+        value = (value | (value >> 2)) & 0x0F0F0F0F;
+        value = (value | (value >> 4)) & 0x00FF00FF;
+        value = (value | (value >> 8)) & 0x0000FFFF;
+        return value;
+    }
+
+    uint32_t m_bitsX;
+
+    uint32_t m_bitsY;
+
+    /** Bits of both coordinates that are interleaved */
+    uint32_t m_shared;
+
+    uint64_t m_lowMask;
+};
+
+/** Square tiles of Tile x Tile cells stored row-major one after another, sides are padded to whole tiles */
+template <uint32_t Tile>
+class BlockedLayout
+{
+public:
+    BlockedLayout(uint32_t width, uint32_t height) : m_tilesX((width + Tile - 1) / Tile), m_tilesY((height + Tile - 1) / Tile) {};
+
+    size_t size(void) const { return static_cast<size_t>(m_tilesX) * m_tilesY * Tile * Tile; }
+
+    uint32_t index(int x, int y) const
+    {
+        uint32_t ux = static_cast<uint32_t>(x);
+        uint32_t uy = static_cast<uint32_t>(y);
+        return ((uy / Tile) * m_tilesX + ux / Tile) * Tile * Tile + (uy % Tile) * Tile + ux % Tile;
+    }
+
+    Position position(uint32_t cell) const
+    {
+        uint32_t tile = cell / (Tile * Tile);
+        uint32_t inside = cell % (Tile * Tile);
+        return Position((tile % m_tilesX) * Tile + inside % Tile, (tile / m_tilesX) * Tile + inside / Tile);
+    }
+
+private:
+    uint32_t m_tilesX;
+
+    uint32_t m_tilesY;
+};
+
+/** Passability of the cells in one flat array ordered by Layout, only Empty cells are passable, cells missing in shorter
+    rows and padding are walls */
+template <typename Layout>
+class BasicSearchGrid
+{
+public:
+    /** Grid as Graph stores it (0 - Wall, 1 - Empty, 2 - Tree) */
+    explicit BasicSearchGrid(const MapGrid &grid);
+
+    uint32_t width(void) const { return m_width; }
+
+    uint32_t height(void) const { return m_height; }
+
+    /** Length of the per cell arrays, padding included */
+    size_t size(void) const { return m_cells.size(); }
+
+    uint32_t index(int x, int y) const { return m_layout.index(x, y); }
+
+    Position position(uint32_t cell) const { return m_layout.position(cell); }
+
+    bool inside(int x, int y) const { return x >= 0 && y >= 0 && x < static_cast<int>(m_width) && y < static_cast<int>(m_height); }
+
+    bool passable(int x, int y) const { return this->inside(x, y) && m_cells[this->index(x, y)]; }
+
+    bool passable(uint32_t cell) const { return m_cells[cell]; }
+
+private:
+    uint32_t m_width;
+
+    uint32_t m_height;
+
+    /** Initialised after the sizes */
+    Layout m_layout;
+
+    std::vector<uint8_t> m_cells;
+};
+
+/** Layout used by GridMap and Graph, the others are selected by instantiating the kernels with their grid */
+using SearchGrid = BasicSearchGrid<RowMajorLayout>;
+
+using MortonSearchGrid = BasicSearchGrid<MortonLayout>;
+
+using BlockedSearchGrid = BasicSearchGrid<BlockedLayout<8>>;
+
+extern template class BasicSearchGrid<RowMajorLayout>;
+extern template class BasicSearchGrid<MortonLayout>;
+extern template class BasicSearchGrid<BlockedLayout<8>>;
+
+
+/* Neighbourhood policies, forEach calls visit(x, y, cost) for every passable neighbour */
+
+/** Left, right, up, down (the order of Graph::Adjacent), unit cost */
+struct FourConnected
+{
+    template <typename Grid, typename Visit>
+    static void forEach(const Grid &grid, int x, int y, Visit &&visit)
+    {
+        if (grid.passable(x - 1, y))
+            visit(x - 1, y, 1.0);
+        if (grid.passable(x + 1, y))
+            visit(x + 1, y, 1.0);
+        if (grid.passable(x, y - 1))
+            visit(x, y - 1, 1.0);
+        if (grid.passable(x, y + 1))
+            visit(x, y + 1, 1.0);
+    }
+};
+
+/** Straight moves first, then diagonals (cost sqrt 2) that do not cut a corner of a wall */
+struct EightConnected
+{
+    template <typename Grid, typename Visit>
+    static void forEach(const Grid &grid, int x, int y, Visit &&visit)
+    {
+        bool left = grid.passable(x - 1, y);
+        bool right = grid.passable(x + 1, y);
+        bool up = grid.passable(x, y - 1);
+        bool down = grid.passable(x, y + 1);
+
+        if (left)
+            visit(x - 1, y, 1.0);
+        if (right)
+            visit(x + 1, y, 1.0);
+        if (up)
+            visit(x, y - 1, 1.0);
+        if (down)
+            visit(x, y + 1, 1.0);
+
+        const double diagonal = std::sqrt(2.0);
+        if (left && up && grid.passable(x - 1, y - 1))
+            visit(x - 1, y - 1, diagonal);
+        if (right && up && grid.passable(x + 1, y - 1))
+            visit(x + 1, y - 1, diagonal);
+        if (left && down && grid.passable(x - 1, y + 1))
+            visit(x - 1, y + 1, diagonal);
+        if (right && down && grid.passable(x + 1, y + 1))
+            visit(x + 1, y + 1, diagonal);
+    }
+};
+
+
+/* Heuristic policies, setGoal is called before the search and operator() estimates the cost to the goal */
+
+/** Uninformed search (BFS, DFS, Dijkstra) */
+struct ZeroHeuristic
+{
+    void setGoal(Position) {}
+
+    double operator()(int, int) const { return 0.0; }
+};
+
+/** L1 distance, exact on empty 4-connected grid */
+struct ManhattanHeuristic
+{
+    void setGoal(Position goal) { m_goal = goal; }
+
+    double operator()(int x, int y) const { return std::abs(x - m_goal.first) + std::abs(y - m_goal.second); }
+
+    Position m_goal;
+};
+
+/** Exact distance on empty 8-connected grid */
+struct OctileHeuristic
+{
+    void setGoal(Position goal) { m_goal = goal; }
+
+    double operator()(int x, int y) const
+    {
+        int dx = std::abs(x - m_goal.first);
+        int dy = std::abs(y - m_goal.second);
+        return std::max(dx, dy) + (std::sqrt(2.0) - 1.0) * std::min(dx, dy);
+    }
+
+    Position m_goal;
+};
+
+/** Heuristic multiplied by weight >= 1 (weighted A*), with a consistent heuristic the search without reopening finds
+    paths at most weight times as long as the shortest one */
+template <typename Heuristic>
+struct WeightedHeuristic
+{
+    void setGoal(Position goal) { m_heuristic.setGoal(goal); }
+
+    double operator()(int x, int y) const { return m_weight * m_heuristic(x, y); }
+
+    Heuristic m_heuristic;
+
+    double m_weight = 1.0;
+};
+
+/** Exact distances from a few landmarks to every cell, built once per map and neighbourhood */
+class LandmarkTable
+{
+public:
+    /** Distance of cell the landmark cannot reach */
+    static constexpr float unreachable = -1.0f;
+
+    /** First landmark is the first free cell, every next one is the cell farthest from the landmarks chosen so far */
+    template <typename Neighbourhood, typename Grid>
+    static std::shared_ptr<const LandmarkTable> build(const Grid &grid, size_t landmarks);
+
+    size_t landmarks(void) const { return m_landmarks.size(); }
+
+    const std::vector<Position> &positions(void) const { return m_landmarks; }
+
+    float distance(size_t landmark, uint32_t cell) const { return m_distances[landmark * m_cells + cell]; }
+
+private:
+    std::vector<Position> m_landmarks;
+
+    size_t m_cells = 0;
+
+    std::vector<float> m_distances;
+};
+
+/** ALT heuristic (triangle inequality over landmark distances), admissible for the neighbourhood of the table,
+    the table has to be built over the same grid (its layout decides the cell indices) */
+template <typename Grid = SearchGrid>
+class LandmarkHeuristic
+{
+public:
+    LandmarkHeuristic(const Grid &grid, std::shared_ptr<const LandmarkTable> table) : m_grid(grid), m_table(std::move(table)) {};
+
+    void setGoal(Position goal)
+    {
+        m_goal.clear();
+        bool inside = m_grid.inside(goal.first, goal.second);
+        for (size_t i = 0; i < m_table->landmarks(); i++)
+            m_goal.push_back(inside ? m_table->distance(i, m_grid.index(goal.first, goal.second)) : LandmarkTable::unreachable);
+    }
+
+    double operator()(int x, int y) const
+    {
+        uint32_t cell = m_grid.index(x, y);
+        float best = 0.0f;
+        for (size_t i = 0; i < m_goal.size(); i++)
+        {
+            float distance = m_table->distance(i, cell);
+            if (distance != LandmarkTable::unreachable && m_goal[i] != LandmarkTable::unreachable)
+                best = std::max(best, std::abs(m_goal[i] - distance));
+        }
+        return best;
+    }
+
+private:
+    const Grid &m_grid;
+
+    std::shared_ptr<const LandmarkTable> m_table;
+
+    std::vector<float> m_goal;
+};
+
+
+/** Path of a search, the caller decides where it is allocated (Graph puts it into its search memory) */
+using SearchPath = std::pmr::vector<Position>;
+
+/** Per cell arrays and open list buffers reused by all searches of one owner, never shared between threads */
+class SearchWorkspace
+{
+public:
+    struct HeapEntry
+    {
+        double key;
+        /** Insertion order, equal keys are popped first in first out */
+        uint64_t order;
+        uint32_t cell;
+    };
+
+    /** Entry of FocalOpen */
+    struct FocalEntry
+    {
+        double f;
+        double h;
+        uint64_t order;
+        uint32_t cell;
+    };
+
+    /** Arrays and buffers are allocated from resource, it has to outlive the workspace */
+    explicit SearchWorkspace(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : m_stamp(resource), m_g(resource), m_parent(resource), m_cells(resource), m_heap(resource), m_focal(resource),
+          m_waiting(resource), m_counts(resource), m_random(std::random_device{}()) {};
+
+    /** Frees the arrays and buffers, before a resource that does not free single allocations (arena) is released */
+    void release(void)
+    {
+        std::pmr::memory_resource *resource = m_stamp.get_allocator().resource();
+        m_stamp = std::pmr::vector<uint32_t>(resource);
+        m_g = std::pmr::vector<double>(resource);
+        m_parent = std::pmr::vector<uint32_t>(resource);
+        m_cells = std::pmr::vector<uint32_t>(resource);
+        m_heap = std::pmr::vector<HeapEntry>(resource);
+        m_focal = std::pmr::vector<FocalEntry>(resource);
+        m_waiting = std::pmr::vector<FocalEntry>(resource);
+        m_counts = std::pmr::vector<uint32_t>(resource);
+        m_generation = 0;
+    }
+
+    /** Forgets the previous search in O(1), arrays grow only for larger grid */
+    void prepare(size_t cells)
+    {
+        if (m_stamp.size() < cells)
+        {
+            m_stamp.assign(cells, 0);
+            m_g.resize(cells);
+            m_parent.resize(cells);
+            m_generation = 0;
+        }
+
+        /* Older stamps are smaller than the generation, it only wraps after a billion searches */
+        m_generation += 4;
+        if (m_generation == 0)
+        {
+            std::fill(m_stamp.begin(), m_stamp.end(), 0);
+            m_generation = 4;
+        }
+    }
+
+    /** Cell got a cost and parent in this search */
+    bool seen(uint32_t cell) const { return m_stamp[cell] >= m_generation; }
+
+    /** Cell was expanded in this search and was not reopened since */
+    bool closed(uint32_t cell) const { return (m_stamp[cell] | 2) == m_generation + 3; }
+
+    /** Cell was expanded in this search and reached more cheaply afterwards (only with Relaxation::Reopen) */
+    bool reopened(uint32_t cell) const { return m_stamp[cell] >= m_generation + 2; }
+
+    double g(uint32_t cell) const { return m_g[cell]; }
+
+    uint32_t parent(uint32_t cell) const { return m_parent[cell]; }
+
+    /** Cell must not be closed */
+    void reach(uint32_t cell, double g, uint32_t parent)
+    {
+        m_stamp[cell] = m_generation;
+        m_g[cell] = g;
+        m_parent[cell] = parent;
+    }
+
+    /** Like reach, cell may be closed, cells expanded before stay marked as reopened */
+    void reopen(uint32_t cell, double g, uint32_t parent)
+    {
+        m_stamp[cell] = m_stamp[cell] > m_generation ? m_generation + 2 : m_generation;
+        m_g[cell] = g;
+        m_parent[cell] = parent;
+    }
+
+    void close(uint32_t cell) { m_stamp[cell] |= 1; }
+
+    std::pmr::vector<uint32_t> &cells(void) { return m_cells; }
+
+    std::pmr::vector<HeapEntry> &heap(void) { return m_heap; }
+
+    /** Buffers of FocalOpen, entries within the bound, entries above it and counts of entries by f */
+    std::pmr::vector<FocalEntry> &focal(void) { return m_focal; }
+
+    std::pmr::vector<FocalEntry> &waiting(void) { return m_waiting; }
+
+    std::pmr::vector<uint32_t> &counts(void) { return m_counts; }
+
+    std::mt19937 &random(void) { return m_random; }
+
+    /** Memory held by the arrays and buffers */
+    size_t bytes(void) const
+    {
+        return (m_stamp.capacity() + m_parent.capacity() + m_cells.capacity() + m_counts.capacity()) * sizeof(uint32_t) +
+               m_g.capacity() * sizeof(double) + m_heap.capacity() * sizeof(HeapEntry) +
+               (m_focal.capacity() + m_waiting.capacity()) * sizeof(FocalEntry);
+    }
+
+private:
+    /** Multiple of 4, stamp equal to it means reached, one more means expanded, two more reopened after expansion
+        and three more expanded again */
+    uint32_t m_generation = 0;
+
+    std::pmr::vector<uint32_t> m_stamp;
+
+    std::pmr::vector<double> m_g;
+
+    std::pmr::vector<uint32_t> m_parent;
+
+    /** Storage of FIFO, LIFO and random open lists */
+    std::pmr::vector<uint32_t> m_cells;
+
+    std::pmr::vector<HeapEntry> m_heap;
+
+    std::pmr::vector<FocalEntry> m_focal;
+
+    std::pmr::vector<FocalEntry> m_waiting;
+
+    std::pmr::vector<uint32_t> m_counts;
+
+    std::mt19937 m_random;
+};
+
+
+/** What happens when a reached cell is reached again, it also decides when the cell counts as visited */
+enum class Relaxation
+{
+    /** Nothing, the first parent is final, so cell is visited when reached and the goal ends the search when reached (BFS) */
+    Once,
+    /** Cell is pushed again with the new parent, it is visited when expanded, the goal ends the search when reached (DFS) */
+    Latest,
+    /** Only cheaper path replaces the old one, cell is visited when expanded, the goal ends the search when expanded (A*) */
+    Cheaper,
+    /** As Cheaper, but cheaper path reopens an expanded cell, it is expanded again and visited only the first time
+        (focal search) */
+    Reopen
+};
+
+/* Open list policies, constructed for one search over the buffers of the workspace */
+
+/** First in, first out */
+class FifoOpen
+{
+public:
+    static constexpr Relaxation relaxation = Relaxation::Once;
+
+    explicit FifoOpen(SearchWorkspace &work) : m_cells(work.cells()) { m_cells.clear(); };
+
+    bool empty(void) const { return m_head == m_cells.size(); }
+
+    void push(uint32_t cell, double, double) { m_cells.push_back(cell); }
+
+    uint32_t pop(void) { return m_cells[m_head++]; }
+
+private:
+    std::pmr::vector<uint32_t> &m_cells;
+
+    size_t m_head = 0;
+};
+
+/** Last in, first out */
+class LifoOpen
+{
+public:
+    static constexpr Relaxation relaxation = Relaxation::Latest;
+
+    explicit LifoOpen(SearchWorkspace &work) : m_cells(work.cells()) { m_cells.clear(); };
+
+    bool empty(void) const { return m_cells.empty(); }
+
+    void push(uint32_t cell, double, double) { m_cells.push_back(cell); }
+
+    uint32_t pop(void)
+    {
+        uint32_t cell = m_cells.back();
+        m_cells.pop_back();
+        return cell;
+    }
+
+private:
+    std::pmr::vector<uint32_t> &m_cells;
+};
+
+/** Uniformly random cell of the open list */
+class RandomOpen
+{
+public:
+    static constexpr Relaxation relaxation = Relaxation::Once;
+
+    explicit RandomOpen(SearchWorkspace &work) : m_cells(work.cells()), m_random(work.random()) { m_cells.clear(); };
+
+    bool empty(void) const { return m_cells.empty(); }
+
+    void push(uint32_t cell, double, double) { m_cells.push_back(cell); }
+
+    uint32_t pop(void)
+    {
+        size_t index = std::uniform_int_distribution<size_t>(0, m_cells.size() - 1)(m_random);
+        uint32_t cell = m_cells[index];
+        m_cells[index] = m_cells.back();
+        m_cells.pop_back();
+        return cell;
+    }
+
+private:
+    std::pmr::vector<uint32_t> &m_cells;
+
+    std::mt19937 &m_random;
+};
+
+/** Priority g + h */
+struct AStarKey
+{
+    static double key(double g, double h) { return g + h; }
+};
+
+/** Priority h */
+struct GreedyKey
+{
+    static double key(double, double h) { return h; }
+};
+
+/** Binary heap ordered by Key, Relax decides whether reached cells are pushed again */
+template <typename Key, Relaxation Relax = Relaxation::Cheaper>
+class BestFirstOpen
+{
+public:
+    static constexpr Relaxation relaxation = Relax;
+
+    explicit BestFirstOpen(SearchWorkspace &work) : m_heap(work.heap()) { m_heap.clear(); };
+
+    bool empty(void) const { return m_heap.empty(); }
+
+    void push(uint32_t cell, double g, double h)
+    {
+        m_heap.push_back({Key::key(g, h), m_order++, cell});
+        std::push_heap(m_heap.begin(), m_heap.end(), &BestFirstOpen::later);
+    }
+
+    uint32_t pop(void)
+    {
+        std::pop_heap(m_heap.begin(), m_heap.end(), &BestFirstOpen::later);
+        uint32_t cell = m_heap.back().cell;
+        m_heap.pop_back();
+        return cell;
+    }
+
+private:
+    static bool later(const SearchWorkspace::HeapEntry &a, const SearchWorkspace::HeapEntry &b)
+    {
+        return a.key > b.key || (a.key == b.key && a.order > b.order);
+    }
+
+    std::pmr::vector<SearchWorkspace::HeapEntry> &m_heap;
+
+    uint64_t m_order = 0;
+};
+
+
+/**
+* @brief Focal list of A*_epsilon, pops the entry with the lowest h among entries with f = g + h at most (1 + suboptimality)
+*        times the lowest f of all entries
+* - Entries above the bound wait in a heap by f and move to the focal list as the lowest f grows; the lowest f is kept by
+*   counts of entries in buckets of width 1 from the f of the first entry, so with fractional costs it can be up to 1
+*   lower than the exact one and the bound only gets tighter
+* - With a consistent heuristic and reopening, some entry with f at most the optimal cost is always open, so the goal
+*   popped from the focal list is at most (1 + suboptimality) times farther than the nearest path
+**/
+class FocalOpen
+{
+public:
+    static constexpr Relaxation relaxation = Relaxation::Reopen;
+
+    FocalOpen(SearchWorkspace &work, double suboptimality)
+        : m_focal(work.focal()), m_waiting(work.waiting()), m_counts(work.counts()), m_factor(1.0 + suboptimality)
+    {
+        m_focal.clear();
+        m_waiting.clear();
+        m_counts.clear();
+    };
+
+    bool empty(void) const { return m_focal.empty() && m_waiting.empty(); }
+
+    void push(uint32_t cell, double g, double h)
+    {
+        SearchWorkspace::FocalEntry entry{g + h, h, m_order++, cell};
+        if (m_counts.empty())
+            m_base = entry.f;
+
+        size_t bucket = this->bucket(entry.f);
+        if (bucket >= m_counts.size())
+            m_counts.resize(bucket + 1, 0);
+        m_counts[bucket]++;
+        m_lowest = std::min(m_lowest, bucket);
+
+        if (entry.f <= this->bound())
+        {
+            m_focal.push_back(entry);
+            std::push_heap(m_focal.begin(), m_focal.end(), &FocalOpen::fartherToGoal);
+        }
+        else
+        {
+            m_waiting.push_back(entry);
+            std::push_heap(m_waiting.begin(), m_waiting.end(), &FocalOpen::higherF);
+        }
+    }
+
+    uint32_t pop(void)
+    {
+        while (m_counts[m_lowest] == 0)
+            m_lowest++;
+
+        /* Lowest f only grows (consistent heuristic), so the entries it lets in stay within the bound */
+        while (!m_waiting.empty() && (m_waiting.front().f <= this->bound() || m_focal.empty()))
+        {
+            std::pop_heap(m_waiting.begin(), m_waiting.end(), &FocalOpen::higherF);
+            m_focal.push_back(m_waiting.back());
+            m_waiting.pop_back();
+            std::push_heap(m_focal.begin(), m_focal.end(), &FocalOpen::fartherToGoal);
+        }
+
+        std::pop_heap(m_focal.begin(), m_focal.end(), &FocalOpen::fartherToGoal);
+        SearchWorkspace::FocalEntry entry = m_focal.back();
+        m_focal.pop_back();
+        m_counts[this->bucket(entry.f)]--;
+        return entry.cell;
+    }
+
+private:
+    size_t bucket(double f) const { return f > m_base ? static_cast<size_t>(f - m_base) : 0; }
+
+    double bound(void) const { return m_factor * (m_base + m_lowest); }
+
+    /** Focal order, lowest h first, then lowest f, then first in first out */
+    static bool fartherToGoal(const SearchWorkspace::FocalEntry &a, const SearchWorkspace::FocalEntry &b)
+    {
+        if (a.h != b.h)
+            return a.h > b.h;
+        if (a.f != b.f)
+            return a.f > b.f;
+        return a.order > b.order;
+    }
+
+    static bool higherF(const SearchWorkspace::FocalEntry &a, const SearchWorkspace::FocalEntry &b)
+    {
+        return a.f > b.f || (a.f == b.f && a.order > b.order);
+    }
+
+    std::pmr::vector<SearchWorkspace::FocalEntry> &m_focal;
+
+    std::pmr::vector<SearchWorkspace::FocalEntry> &m_waiting;
+
+    std::pmr::vector<uint32_t> &m_counts;
+
+    double m_factor;
+
+    /** f of the first entry, buckets start there */
+    double m_base = 0.0;
+
+    /** No entry is in a lower bucket */
+    size_t m_lowest = 0;
+
+    uint64_t m_order = 0;
+};
+
+
+/* Tracing policies, with enabled false every call of the policy is discarded at compile time */
+
+/** Headless search, only the counters of KernelStats are kept */
+struct NoTrace
+{
+    static constexpr bool enabled = false;
+
+    void visited(Position) {}
+
+    void opened(Position, Position) {}
+
+    bool cancelled(void) { return false; }
+};
+
+/** Counters of one search, visited counts the positions a tracing policy would receive */
+struct KernelStats
+{
+    size_t visited = 0;
+    size_t expanded = 0;
+    size_t opened = 0;
+    bool found = false;
+    double cost = 0.0;
+};
+
+/**
+* @brief Grid search from start (it does not have to be passable, some dataset maps start on a wall) to goal
+* - Open is a fresh open list over the buffers of work
+* - Trace receives visited positions (start first, goal last if found) and opened positions the way Graph records them
+* - Path (if not nullptr) receives the positions from start to goal, it is empty if the goal was not found
+**/
+template <typename Neighbourhood, typename Heuristic, typename OpenList, typename Trace, typename Grid>
+KernelStats searchKernel(const Grid &grid, SearchWorkspace &work, OpenList &open, Heuristic &heuristic, Trace &trace, Position start,
+                         Position goal, SearchPath *path)
+{
+    constexpr Relaxation relaxation = OpenList::relaxation;
+    /* Reached goal may still get a cheaper path, the search ends when it is expanded */
+    constexpr bool goalWhenExpanded = relaxation == Relaxation::Cheaper || relaxation == Relaxation::Reopen;
+    constexpr uint32_t nowhere = std::numeric_limits<uint32_t>::max();
+
+    KernelStats stats;
+    if (path)
+        path->clear();
+    if (!grid.inside(start.first, start.second))
+        return stats;
+
+    work.prepare(grid.size());
+    heuristic.setGoal(goal);
+
+    uint32_t startCell = grid.index(start.first, start.second);
+    uint32_t goalCell = grid.inside(goal.first, goal.second) ? grid.index(goal.first, goal.second) : nowhere;
+
+    auto visit = [&](Position pos) {
+        stats.visited++;
+        if constexpr (Trace::enabled)
+            trace.visited(pos);
+    };
+
+    work.reach(startCell, 0.0, startCell);
+    open.push(startCell, 0.0, heuristic(start.first, start.second));
+    if constexpr (relaxation == Relaxation::Once)
+        visit(start);
+    if constexpr (!goalWhenExpanded)
+    {
+        /* Goal is otherwise only found among neighbours */
+        if (startCell == goalCell)
+        {
+            if constexpr (relaxation == Relaxation::Latest)
+                visit(start);
+            stats.found = true;
+        }
+    }
+
+    while (!open.empty() && !stats.found)
+    {
+        if constexpr (Trace::enabled)
+        {
+            if (trace.cancelled())
+                break;
+        }
+
+        uint32_t cell = open.pop();
+        Position pos = grid.position(cell);
+
+        if constexpr (goalWhenExpanded)
+        {
+            if (cell == goalCell)
+            {
+                visit(pos);
+                stats.found = true;
+                break;
+            }
+        }
+        if constexpr (relaxation != Relaxation::Once)
+        {
+            /* Cell may be in the open list more times, it is expanded once (once for every cheaper path with Reopen) */
+            if (work.closed(cell))
+                continue;
+            if (relaxation != Relaxation::Reopen || !work.reopened(cell))
+                visit(pos);
+            work.close(cell);
+        }
+        stats.expanded++;
+
+        double g = work.g(cell);
+        Neighbourhood::forEach(grid, pos.first, pos.second, [&](int x, int y, double cost) {
+            uint32_t next = grid.index(x, y);
+            double nextG = g + cost;
+            if (stats.found)
+                return;
+
+            if constexpr (relaxation == Relaxation::Once)
+            {
+                if (work.seen(next))
+                    return;
+            }
+            else if constexpr (relaxation == Relaxation::Reopen)
+            {
+                if (work.seen(next) && nextG >= work.g(next))
+                    return;
+            }
+            else
+            {
+                if (work.closed(next))
+                    return;
+                if (relaxation == Relaxation::Cheaper && work.seen(next) && nextG >= work.g(next))
+                    return;
+            }
+
+            if constexpr (relaxation == Relaxation::Reopen)
+                work.reopen(next, nextG, cell);
+            else
+                work.reach(next, nextG, cell);
+            open.push(next, nextG, heuristic(x, y));
+            if constexpr (relaxation == Relaxation::Once)
+                visit(Position(x, y));
+
+            if (!goalWhenExpanded && next == goalCell)
+            {
+                if constexpr (relaxation == Relaxation::Latest)
+                    visit(Position(x, y));
+                stats.found = true;
+                return;
+            }
+
+            stats.opened++;
+            if constexpr (Trace::enabled)
+                trace.opened(pos, Position(x, y));
+        });
+    }
+
+    if (stats.found)
+    {
+        stats.cost = work.g(goalCell);
+        if (path)
+        {
+            for (uint32_t cell = goalCell; cell != startCell; cell = work.parent(cell))
+                path->push_back(grid.position(cell));
+            path->push_back(start);
+            std::reverse(path->begin(), path->end());
+        }
+    }
+
+    return stats;
+}
+
+/** Search with a new open list over the buffers of the workspace, open lists with parameters are passed by the overload
+    above */
+template <typename Neighbourhood, typename Heuristic, typename OpenList, typename Trace, typename Grid>
+KernelStats searchKernel(const Grid &grid, SearchWorkspace &work, Heuristic &heuristic, Trace &trace, Position start, Position goal,
+                         SearchPath *path)
+{
+    OpenList open(work);
+    return searchKernel<Neighbourhood>(grid, work, open, heuristic, trace, start, goal, path);
+}
+
+/** Algorithms of SearchAlgorithmType as kernel instantiations, informed ones use Manhattan heuristic like Graph */
+template <typename Trace, typename Grid>
+KernelStats runAlgorithm(SearchAlgorithmType algoType, const Grid &grid, SearchWorkspace &work, Trace &trace, Position start,
+                         Position goal, SearchPath *path, double suboptimality = defaultSuboptimality)
+{
+    ZeroHeuristic zero;
+    ManhattanHeuristic manhattan;
+    WeightedHeuristic<ManhattanHeuristic> weighted{manhattan, 1.0 + suboptimality};
+
+    switch (algoType)
+    {
+        case SearchAlgorithmType::BFS:
+            return searchKernel<FourConnected, ZeroHeuristic, FifoOpen>(grid, work, zero, trace, start, goal, path);
+        case SearchAlgorithmType::DFS:
+            return searchKernel<FourConnected, ZeroHeuristic, LifoOpen>(grid, work, zero, trace, start, goal, path);
+        case SearchAlgorithmType::RandomSearch:
+            return searchKernel<FourConnected, ZeroHeuristic, RandomOpen>(grid, work, zero, trace, start, goal, path);
+        case SearchAlgorithmType::GreedySearch:
+            return searchKernel<FourConnected, ManhattanHeuristic, BestFirstOpen<GreedyKey, Relaxation::Once>>(grid, work, manhattan, trace,
+                                                                                                              start, goal, path);
+        case SearchAlgorithmType::AStar:
+            return searchKernel<FourConnected, ManhattanHeuristic, BestFirstOpen<AStarKey>>(grid, work, manhattan, trace, start, goal, path);
+        case SearchAlgorithmType::WeightedAStar:
+            return searchKernel<FourConnected, WeightedHeuristic<ManhattanHeuristic>, BestFirstOpen<AStarKey>>(grid, work, weighted, trace,
+                                                                                                              start, goal, path);
+        case SearchAlgorithmType::FocalSearch:
+        {
+            FocalOpen open(work, suboptimality);
+            return searchKernel<FourConnected>(grid, work, open, manhattan, trace, start, goal, path);
+        }
+    }
+    return KernelStats();
+}
+
+template <typename Neighbourhood, typename Grid>
+std::shared_ptr<const LandmarkTable> LandmarkTable::build(const Grid &grid, size_t landmarks)
+{
+    auto table = std::make_shared<LandmarkTable>();
+    table->m_cells = grid.size();
+
+    uint32_t next = 0;
+    while (next < grid.size() && !grid.passable(next))
+        next++;
+    if (next == grid.size())
+        return table;
+
+    SearchWorkspace work;
+    ZeroHeuristic zero;
+    NoTrace trace;
+    std::vector<float> nearest(grid.size(), unreachable);
+
+    for (size_t i = 0; i < landmarks; i++)
+    {
+        Position landmark = grid.position(next);
+        table->m_landmarks.push_back(landmark);
+        table->m_distances.resize((i + 1) * grid.size(), unreachable);
+
+        /* Dijkstra without goal expands every reachable cell */
+        searchKernel<Neighbourhood, ZeroHeuristic, BestFirstOpen<AStarKey>>(grid, work, zero, trace, landmark, Position(-1, -1), nullptr);
+
+        float farthest = -1.0f;
+        for (uint32_t cell = 0; cell < grid.size(); cell++)
+        {
+            if (!work.closed(cell))
+                continue;
+
+            float distance = static_cast<float>(work.g(cell));
+            table->m_distances[i * grid.size() + cell] = distance;
+            if (nearest[cell] == unreachable || distance < nearest[cell])
+                nearest[cell] = distance;
+            if (nearest[cell] > farthest)
+            {
+                farthest = nearest[cell];
+                next = cell;
+            }
+        }
+    }
+
+    return table;
+}
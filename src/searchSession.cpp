@@ -0,0 +1,46 @@
+/**
+* @file searchSession.cpp
+* @author Ondrej
+* @brief Implementation of SearchSession
+**/
+
+#include "searchSession.hpp"
+#include "corridorPruning.hpp"
+#include "profiler.hpp"
+#include "rectangleSymmetry.hpp"
+#include "subgoalGraph.hpp"
+
+const KernelStats &SearchSession::run(SearchAlgorithmType algoType, Position start, Position goal, SearchReduction reduction,
+                                      double suboptimality)
+{
+    PROFILE_ZONE("search");
+    NoTrace trace;
+    m_path.clear();
+    if (start == goal)
+        m_stats = KernelStats();
+    else if (reduction == SearchReduction::Rectangles)
+        m_stats = runRectangleAlgorithm(algoType, *m_map, m_workspace, trace, start, goal, &m_path, suboptimality);
+    else if (reduction == SearchReduction::Corridors)
+        m_stats = runCorridorAlgorithm(algoType, *m_map, m_workspace, trace, start, goal, &m_path, suboptimality);
+    else if (reduction == SearchReduction::Subgoals)
+        m_stats = runSubgoalAlgorithm(algoType, *m_map, m_workspace, trace, start, goal, &m_path, suboptimality);
+    else
+        m_stats = runAlgorithm(algoType, m_map->searchGrid(), m_workspace, trace, start, goal, &m_path, suboptimality);
+    return m_stats;
+}
+
+const KernelStats &SearchSession::runNearest(SearchAlgorithmType algoType, Position start, const std::vector<Position> &goals, size_t k)
+{
+    PROFILE_ZONE("nearest search");
+    NoTrace trace;
+    m_stats = runNearestGoals(algoType, m_map->searchGrid(), m_workspace, trace, start, goals, k, &m_nearest);
+    return m_stats;
+}
+
+size_t SearchSession::bytes(void) const
+{
+    size_t bytes = m_workspace.bytes() + m_path.capacity() * sizeof(Position) + m_nearest.capacity() * sizeof(GoalPath);
+    for (const auto &target: m_nearest)
+        bytes += target.path.capacity() * sizeof(Position);
+    return bytes;
+}
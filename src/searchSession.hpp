@@ -0,0 +1,72 @@
+/**
+* @file searchSession.hpp
+* @author Ondrej
+* @brief Per-run state of untraced searches over a shared GridMap
+**/
+
+#pragma once
+
+#include "gridMap.hpp"
+#include "multiGoal.hpp"
+#include "searchKernel.hpp"
+
+#include <memory>
+#include <vector>
+
+
+/** Preprocessing of the map BFS and A* searches use, the other algorithms always search the whole grid */
+enum class SearchReduction
+{
+    None,
+    /** Interiors of empty rectangles are skipped (rectangleSymmetry.hpp) */
+    Rectangles,
+    /** Dead ends are skipped and corridors jumped over (corridorPruning.hpp) */
+    Corridors,
+    /** Search runs over the subgoal graph (subgoalGraph.hpp) */
+    Subgoals
+};
+
+/**
+* @brief Workspace, path and counters of one search at a time, the map is only referenced
+* - Any number of sessions may search one map at once, each session belongs to one thread while searching
+* - Runs the NoTrace kernels, Graph is the traced counterpart used by the visualisation
+**/
+class SearchSession
+{
+public:
+    explicit SearchSession(std::shared_ptr<const GridMap> map) : m_map(std::move(map)) {};
+
+    /** Searches from start to goal, start equal to goal finds no path (as Graph::setUp), with a reduction the path is
+        as short and visited counts only the expanded cells; suboptimality is the bound of weighted A* and focal search */
+    const KernelStats &run(SearchAlgorithmType algoType, Position start, Position goal, SearchReduction reduction = SearchReduction::None,
+                           double suboptimality = defaultSuboptimality);
+
+    /** Nearest k of the goals in one BFS or A* search (multiGoal.hpp), other algorithms find nothing, reductions are
+        not used; path is not changed, the goals are read by nearest */
+    const KernelStats &runNearest(SearchAlgorithmType algoType, Position start, const std::vector<Position> &goals, size_t k);
+
+    const GridMap &map(void) const { return *m_map; }
+
+    /** Path of the last search from start to goal, empty if there is no path */
+    const SearchPath &path(void) const { return m_path; }
+
+    /** Goals found by the last runNearest from the nearest one, with their paths */
+    const std::vector<GoalPath> &nearest(void) const { return m_nearest; }
+
+    /** Counters of the last search */
+    const KernelStats &stats(void) const { return m_stats; }
+
+    /** Memory owned by the session (the map is not counted) */
+    size_t bytes(void) const;
+
+private:
+    std::shared_ptr<const GridMap> m_map;
+
+    SearchWorkspace m_workspace;
+
+    SearchPath m_path;
+
+    std::vector<GoalPath> m_nearest;
+
+    KernelStats m_stats;
+};
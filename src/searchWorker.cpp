@@ -0,0 +1,104 @@
+/**
+* @file searchWorker.cpp
+* @author Ondrej
+* @brief Implementation of SearchWorker
+**/
+
+#include "searchWorker.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+SearchWorker::~SearchWorker()
+{
+    this->cancel();
+    m_graph.setListener(nullptr);
+}
+
+/** Starts new search in background thread */
+void SearchWorker::start(int state)
+{
+    this->cancel();
+
+    /* Nothing else touches the graph or the queue now */
+    m_graph.reset();
+    if (state != -1)
+        m_graph.setAlgoType(static_cast<SearchAlgorithmType>(state));
+    m_graph.setListener(this);
+    m_events.clear();
+    m_recorded.clear();
+    m_cancel.store(false);
+    m_waitedNanos.store(0);
+    m_finishedNanos.store(-1);
+    m_started = std::chrono::steady_clock::now();
+
+    m_thread = std::thread([this]() {
+        PROFILE_THREAD("search worker");
+        m_graph.setUp(-1);
+        m_finishedNanos.store(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_started).count());
+        if (!this->cancelled())
+            this->push(SearchEvent{SearchEvent::Type::Done, 0, 0});
+    });
+}
+
+/** Stops the search at the next step */
+void SearchWorker::cancel(void)
+{
+    m_cancel.store(true);
+    this->join();
+}
+
+/** Waits for the search thread */
+void SearchWorker::join(void)
+{
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+void SearchWorker::visited(Position pos)
+{
+    SearchEvent event{SearchEvent::Type::Visit, pos.first, pos.second};
+    if (m_record)
+        m_recorded.push_back(event);
+    this->push(event);
+}
+
+void SearchWorker::opened(Position, Position to)
+{
+    SearchEvent event{SearchEvent::Type::Open, to.first, to.second};
+    if (m_record)
+        m_recorded.push_back(event);
+    this->push(event);
+}
+
+/** Searching time without waiting, while running it is measured up to now */
+double SearchWorker::searchSeconds(void) const
+{
+    int64_t total = m_finishedNanos.load();
+    if (total < 0)
+        total = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_started).count();
+
+    return std::max<int64_t>(total - m_waitedNanos.load(), 0) / 1e9;
+}
+
+/** Spins shortly, then sleeps, render loop may be paused for a long time */
+void SearchWorker::push(const SearchEvent &event)
+{
+    if (m_events.tryPush(event))
+        return;
+
+    /* Queue is full, waiting for the render loop is not part of the search time */
+    auto waitStart = std::chrono::steady_clock::now();
+    for (size_t attempt = 0; !m_events.tryPush(event); attempt++)
+    {
+        if (this->cancelled())
+            break;
+
+        if (attempt < 64)
+            std::this_thread::yield();
+        else
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    m_waitedNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - waitStart).count());
+}
@@ -0,0 +1,108 @@
+/**
+* @file searchWorker.hpp
+* @author Ondrej
+* @brief Runs search in background thread and streams its steps to the render loop
+**/
+
+#pragma once
+
+#include "graph.hpp"
+#include "spscQueue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+
+/** One step of the search, kept small so the queue stays in cache */
+struct SearchEvent
+{
+    enum class Type : uint8_t
+    {
+        Visit,
+        Open,
+        /** Search finished (not sent when cancelled), results of the graph can be read after join */
+        Done
+    };
+
+    Type type;
+    int32_t x;
+    int32_t y;
+};
+
+/**
+* @brief Owns the search thread of one graph
+* - Graph must not be used by other threads while search is running (until Done is received and join is called)
+* - When the queue is full, search waits until the render loop takes events, so paused visualisation also pauses the search
+**/
+class SearchWorker : public SearchListener
+{
+public:
+    static const size_t queueCapacity = 1 << 16;
+
+    explicit SearchWorker(Graph &graph) : m_graph(graph), m_events(queueCapacity) {};
+
+    /** Cancels the search and removes itself from the graph */
+    ~SearchWorker();
+
+    SearchWorker(const SearchWorker &) = delete;
+    SearchWorker &operator=(const SearchWorker &) = delete;
+
+    /** Cancels running search, resets graph and starts new search (state as in Graph::setUp) */
+    void start(int state);
+
+    /** Asks the search to stop and waits for the thread */
+    void cancel(void);
+
+    /** Waits for the search thread to finish */
+    void join(void);
+
+    /** Takes next event, returns false if there is none at the moment (render thread only) */
+    bool poll(SearchEvent &event) { return m_events.tryPop(event); }
+
+    /** True while the search thread exists (until join/cancel) */
+    bool running(void) const { return m_thread.joinable(); }
+
+    /** Following searches also keep their events (without Done), so the result can be stored */
+    void setRecording(bool record) { m_record = record; }
+
+    /** Events of the last search, only after join, recording is emptied */
+    std::vector<SearchEvent> takeRecording(void) { return std::move(m_recorded); }
+
+    /** Time the last search has been running, time spent waiting for space in the queue is not counted */
+    double searchSeconds(void) const;
+
+private:
+    void visited(Position pos) override;
+
+    void opened(Position from, Position to) override;
+
+    bool cancelled(void) override { return m_cancel.load(std::memory_order_relaxed); }
+
+    /** Waits until there is space in the queue, gives up when cancelled */
+    void push(const SearchEvent &event);
+
+    Graph &m_graph;
+
+    SpscQueue<SearchEvent> m_events;
+
+    std::atomic<bool> m_cancel{false};
+
+    std::thread m_thread;
+
+    bool m_record = false;
+
+    /** Written only by the search thread */
+    std::vector<SearchEvent> m_recorded;
+
+    /** Set by start, before the thread exists */
+    std::chrono::steady_clock::time_point m_started;
+
+    /** Time the search thread waited in push */
+    std::atomic<int64_t> m_waitedNanos{0};
+
+    /** Duration of the finished search including waiting, -1 while running */
+    std::atomic<int64_t> m_finishedNanos{-1};
+};
@@ -0,0 +1,185 @@
+/**
+* @file server.cpp
+* @author Ondrej
+* @brief Path query server, maps are loaded once and queries are answered by worker threads
+*/
+
+#include "conversion.hpp"
+#include "profiler.hpp"
+#include "queryServer.hpp"
+
+#include <chrono>
+#include <csignal>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+/** Server stopped by SIGINT/SIGTERM */
+static QueryServer *runningServer = nullptr;
+
+static void stopServer(int)
+{
+    if (runningServer)
+        runningServer->stop();
+}
+
+/** Prints usage */
+static void usage(void)
+{
+    std::cerr << "Usage: ./server [options] <map>..." << std::endl;
+    std::cerr << "  map is <file> (queries use its file name), <name>=<file> or a directory of maps" << std::endl;
+    std::cerr << "  --socket <path>  listen on Unix domain socket instead of stdin/stdout" << std::endl;
+    std::cerr << "  --threads <n>    worker threads (default one per hardware thread)" << std::endl;
+    std::cerr << "  --lazy           load every map on its first query instead of all at start" << std::endl;
+    std::cerr << "  --rsr            bfs and astar skip interiors of empty rectangles (rectangular symmetry reduction)" << std::endl;
+    std::cerr << "  --prune          bfs and astar skip dead ends and jump over corridors" << std::endl;
+    std::cerr << "  --subgoals       bfs and astar search the subgoal graph of the map (built on its first query)" << std::endl;
+    std::cerr << "  --epsilon <e>    wastar and focal paths are at most 1 + e times longer than the shortest (default " << defaultSuboptimality
+              << ")" << std::endl;
+    std::cerr << "  --trace <file>   write Chrome trace events of map loading and queries of all threads into file" << std::endl;
+    std::cerr << "  query: <map> <start x> <start y> <goal x> <goal y> <bfs|dfs|random|greedy|astar|wastar|focal>, \"stats\" for latencies" << std::endl;
+}
+
+/** Writes the trace if it was requested, false if it cannot be written */
+static bool finishTrace(const std::string &tracePath)
+{
+    if (tracePath.empty())
+        return true;
+    if (Profiler::finish(tracePath))
+        return true;
+    std::cerr << "Cannot write trace " << tracePath << std::endl;
+    return false;
+}
+
+/**
+* @brief Runs the query server
+* - Arguments: maps, at least one
+* - Without --socket requests are read from stdin and responses written to stdout until end of input
+*/
+int main(int argc, char **argv)
+{
+    std::string socketPath;
+    size_t threads = 0;
+    bool lazy = false;
+    SearchReduction reduction = SearchReduction::None;
+    double suboptimality = defaultSuboptimality;
+    std::string tracePath;
+
+    std::vector<std::string> maps;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (argument == "--socket" && hasValue)
+            socketPath = argv[++i];
+        else if (argument == "--threads" && hasValue)
+        {
+            if (!strToNum(argv[++i], threads))
+            {
+                usage();
+                return EXIT_FAILURE;
+            }
+        }
+        else if (argument == "--lazy")
+            lazy = true;
+        else if (argument == "--rsr")
+            reduction = SearchReduction::Rectangles;
+        else if (argument == "--prune")
+            reduction = SearchReduction::Corridors;
+        else if (argument == "--subgoals")
+            reduction = SearchReduction::Subgoals;
+        else if (argument == "--epsilon" && hasValue)
+        {
+            if (!strToNum(argv[++i], suboptimality) || !(suboptimality >= 0.0))
+            {
+                usage();
+                return EXIT_FAILURE;
+            }
+        }
+        else if (argument == "--trace" && hasValue)
+            tracePath = argv[++i];
+        else if (argument.rfind("--", 0) == 0)
+        {
+            usage();
+            return EXIT_FAILURE;
+        }
+        else
+            maps.push_back(argument);
+    }
+
+    if (maps.empty())
+    {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    PROFILE_THREAD("main");
+    if (!tracePath.empty())
+        Profiler::start();
+
+    QueryServer server(threads);
+    server.setReduction(reduction);
+    server.setSuboptimality(suboptimality);
+    for (const auto &map: maps)
+    {
+        size_t separator = map.find('=');
+        if (separator == std::string::npos && std::filesystem::is_directory(map))
+        {
+            server.addDirectory(map);
+            continue;
+        }
+
+        std::string name = separator == std::string::npos ? std::filesystem::path(map).filename().string() : map.substr(0, separator);
+        std::string file = separator == std::string::npos ? map : map.substr(separator + 1);
+        if (!server.addMap(name, file))
+            std::cerr << "Map name " << name << " is used twice, " << file << " is ignored" << std::endl;
+    }
+
+    if (!lazy)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        std::vector<std::string> errors = server.preload();
+        for (const auto &error: errors)
+            std::cerr << error << std::endl;
+        if (!errors.empty())
+            return EXIT_FAILURE;
+
+        size_t distinct = 0;
+        for (const auto &map: server.maps().usage())
+        {
+            distinct += map.duplicateOf.empty();
+            std::cerr << "Loaded " << map.name << " ("
+                      << (map.duplicateOf.empty() ? std::to_string(map.bytes / 1024) + " KB" : "same as " + map.duplicateOf) << ")" << std::endl;
+        }
+        std::cerr << server.maps().names().size() << " maps (" << distinct << " distinct, " << server.maps().bytes() / 1024 << " KB) loaded in "
+                  << std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count() << " s" << std::endl;
+    }
+
+    /* Client that disconnects must not kill the server */
+    std::signal(SIGPIPE, SIG_IGN);
+
+    if (socketPath.empty())
+    {
+        server.serve(STDIN_FILENO, STDOUT_FILENO);
+        std::cerr << server.latencyReport() << std::endl;
+        return finishTrace(tracePath) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    runningServer = &server;
+    std::signal(SIGINT, stopServer);
+    std::signal(SIGTERM, stopServer);
+
+    std::cerr << "Listening on " << socketPath << std::endl;
+    if (!server.listen(socketPath))
+    {
+        std::cerr << "Cannot listen on " << socketPath << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cerr << server.latencyReport() << std::endl;
+
+    return finishTrace(tracePath) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
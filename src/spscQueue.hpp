@@ -0,0 +1,99 @@
+/**
+* @file spscQueue.hpp
+* @author Ondrej
+* @brief Lock-free ring buffer for exactly one producer thread and one consumer thread
+**/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+
+/**
+* @brief Bounded single-producer/single-consumer queue
+* - tryPush may be called only from the producer thread, tryPop only from the consumer thread
+* - Capacity is rounded up to power of two, indices only grow and are masked when accessing the buffer
+**/
+template <typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(size_t capacity)
+    {
+        size_t size = 1;
+        while (size < capacity)
+            size *= 2;
+        m_buffer.resize(size);
+        m_mask = size - 1;
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    /** Appends value, returns false if the queue is full */
+    bool tryPush(const T &value)
+    {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+
+        /* Head seen last time is enough unless the queue looks full */
+        if (tail - m_cachedHead > m_mask)
+        {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail - m_cachedHead > m_mask)
+                return false;
+        }
+
+        m_buffer[tail & m_mask] = value;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Takes the oldest value, returns false if the queue is empty */
+    bool tryPop(T &value)
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+
+        if (head == m_cachedTail)
+        {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cachedTail)
+                return false;
+        }
+
+        value = m_buffer[head & m_mask];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Removes everything, only when neither thread is using the queue */
+    void clear(void)
+    {
+        m_head.store(0, std::memory_order_relaxed);
+        m_tail.store(0, std::memory_order_relaxed);
+        m_cachedHead = 0;
+        m_cachedTail = 0;
+    }
+
+    size_t capacity(void) const { return m_buffer.size(); }
+
+private:
+    std::vector<T> m_buffer;
+
+    size_t m_mask = 0;
+
+    /* Consumer and producer data are on separate cache lines */
+
+    /** Next value to pop, written by consumer */
+    alignas(64) std::atomic<size_t> m_head{0};
+
+    /** Consumer's copy of m_tail */
+    size_t m_cachedTail = 0;
+
+    /** Next free slot, written by producer */
+    alignas(64) std::atomic<size_t> m_tail{0};
+
+    /** Producer's copy of m_head */
+    size_t m_cachedHead = 0;
+};
@@ -0,0 +1,166 @@
+/**
+* @file subgoalGraph.cpp
+* @author Ondrej
+* @brief Implementation of the simple subgoal graph
+**/
+
+#include "subgoalGraph.hpp"
+
+SubgoalGraph::SubgoalGraph(const SearchGrid &grid) : m_subgoalOf(grid.size(), none)
+{
+    /* Diagonal neighbour outside the grid always has a side neighbour outside too, so only walls inside count */
+    for (uint32_t cell = 0; cell < grid.size(); cell++)
+    {
+        if (!grid.passable(cell))
+            continue;
+        Position pos = grid.position(cell);
+        int x = pos.first;
+        int y = pos.second;
+        bool corner = false;
+        for (int dx: {-1, 1})
+        {
+            for (int dy: {-1, 1})
+                corner = corner || (!grid.passable(x + dx, y + dy) && grid.passable(x + dx, y) && grid.passable(x, y + dy));
+        }
+        if (corner)
+        {
+            m_subgoalOf[cell] = static_cast<uint32_t>(m_cells.size());
+            m_cells.push_back(cell);
+        }
+    }
+
+    m_offsets.reserve(m_cells.size() + 1);
+    m_offsets.push_back(0);
+    std::vector<uint32_t> found;
+    for (uint32_t cell: m_cells)
+    {
+        Position pos = grid.position(cell);
+        this->reachable(grid, pos.first, pos.second, none, found);
+        m_targets.insert(m_targets.end(), found.begin(), found.end());
+        m_offsets.push_back(static_cast<uint32_t>(m_targets.size()));
+    }
+    m_targets.shrink_to_fit();
+}
+
+void SubgoalGraph::reachable(const SearchGrid &grid, int x, int y, uint32_t target, std::vector<uint32_t> &found) const
+{
+    found.clear();
+    for (int dx: {-1, 1})
+    {
+        for (int dy: {-1, 1})
+            this->quadrant(grid, x, y, dx, dy, target, found);
+    }
+    /* Cells on the row and the column of the origin lie in two quadrants */
+    std::sort(found.begin(), found.end());
+    found.erase(std::unique(found.begin(), found.end()), found.end());
+}
+
+void SubgoalGraph::quadrant(const SearchGrid &grid, int x, int y, int dx, int dy, uint32_t target, std::vector<uint32_t> &found) const
+{
+    /* Rows are walked away from the origin, a cell is reached from the previous cell of its row or from the cell of its
+       column in the previous row; subgoals are reached but the walk does not go on through them. passes[k] is the cell
+       k steps from the origin column, only the first lastPassing + 1 of the previous row are valid */
+    std::vector<uint8_t> passes(grid.width(), 0);
+    int lastPassing = -1;
+    for (int row = 0; grid.inside(x, y + row * dy); row++)
+    {
+        int cellY = y + row * dy;
+        int rowLast = -1;
+        bool left = false;
+        for (int k = 0; grid.inside(x + k * dx, cellY); k++)
+        {
+            bool origin = row == 0 && k == 0;
+            bool up = k <= lastPassing && passes[k];
+            if (!origin && !left && k > lastPassing)
+                break;
+
+            bool pass = false;
+            if (origin)
+                pass = true;
+            else if ((left || up) && grid.passable(x + k * dx, cellY))
+            {
+                uint32_t cell = grid.index(x + k * dx, cellY);
+                if (cell == target)
+                    found.push_back(cell);
+                if (m_subgoalOf[cell] != none)
+                    found.push_back(cell);
+                else
+                    pass = true;
+            }
+
+            passes[k] = pass;
+            left = pass;
+            if (pass)
+                rowLast = k;
+        }
+        if (rowLast < 0)
+            break;
+        lastPassing = rowLast;
+    }
+}
+
+size_t SubgoalGraph::bytes(void) const
+{
+    return (m_subgoalOf.capacity() + m_cells.capacity() + m_offsets.capacity() + m_targets.capacity()) * sizeof(uint32_t);
+}
+
+SubgoalGrid::SubgoalGrid(const SearchGrid &grid, const SubgoalGraph &subgoals, Position start, Position goal) : m_grid(grid), m_subgoals(subgoals)
+{
+    if (!grid.inside(start.first, start.second))
+        return;
+    m_start = grid.index(start.first, start.second);
+
+    /* Goal on a wall is never reached, as in the searches over all cells */
+    if (grid.passable(goal.first, goal.second))
+    {
+        m_goal = grid.index(goal.first, goal.second);
+        subgoals.reachable(grid, goal.first, goal.second, SubgoalGraph::none, m_toGoal);
+    }
+    subgoals.reachable(grid, start.first, start.second, m_goal, m_fromStart);
+}
+
+void refineSubgoalPath(SearchPath &path, const SearchGrid &grid)
+{
+    if (path.size() < 2)
+        return;
+
+    SearchPath refined(path.get_allocator());
+    refined.push_back(path.front());
+    std::vector<uint8_t> reaches;
+    for (size_t i = 1; i < path.size(); i++)
+    {
+        Position from = path[i - 1];
+        Position to = path[i];
+        int dx = to.first >= from.first ? 1 : -1;
+        int dy = to.second >= from.second ? 1 : -1;
+        int width = std::abs(to.first - from.first) + 1;
+        int height = std::abs(to.second - from.second) + 1;
+
+        /* Cells of the box between the two positions from which to is h-reachable, counted backward from to; from
+           itself may be a wall (start) */
+        reaches.assign(static_cast<size_t>(width) * height, 0);
+        auto at = [&](int u, int v) -> uint8_t & { return reaches[static_cast<size_t>(v) * width + u]; };
+        for (int v = height - 1; v >= 0; v--)
+        {
+            for (int u = width - 1; u >= 0; u--)
+            {
+                bool free = (u == 0 && v == 0) || grid.passable(from.first + u * dx, from.second + v * dy);
+                bool last = u == width - 1 && v == height - 1;
+                at(u, v) = free && (last || (u + 1 < width && at(u + 1, v)) || (v + 1 < height && at(u, v + 1)));
+            }
+        }
+
+        /* Walks in x while that keeps to h-reachable, the search only connected h-reachable positions */
+        int u = 0;
+        int v = 0;
+        while (at(0, 0) && (u != width - 1 || v != height - 1))
+        {
+            if (u + 1 < width && at(u + 1, v))
+                u++;
+            else
+                v++;
+            refined.emplace_back(from.first + u * dx, from.second + v * dy);
+        }
+    }
+    path = std::move(refined);
+}
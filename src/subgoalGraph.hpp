@@ -0,0 +1,180 @@
+/**
+* @file subgoalGraph.hpp
+* @author Ondrej
+* @brief Simple subgoal graph, searches run over convex corners of the walls instead of over cells
+*
+* A free cell is a subgoal if a wall touches it only diagonally (its two cells next to the wall are free), shortest
+* 4-connected paths bend only around such corners. Two cells are h-reachable if a path as long as their Manhattan
+* distance connects them (it never turns back in x or y). Subgoals are connected by an edge of that length when one is
+* h-reachable from the other without passing a third subgoal. A query connects the start and the goal to the subgoals
+* h-reachable from them the same way and searches the graph, consecutive positions of the result are filled in again.
+**/
+
+#pragma once
+
+#include "graph.hpp"
+#include "gridMap.hpp"
+#include "searchKernel.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+
+/** Subgoals of a map and the edges between them, built once per map (GridMap::subgoals) */
+class SubgoalGraph
+{
+public:
+    static constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+
+    explicit SubgoalGraph(const SearchGrid &grid);
+
+    size_t subgoals(void) const { return m_cells.size(); }
+
+    /** Undirected edges, every one is stored in both directions */
+    size_t edges(void) const { return m_targets.size() / 2; }
+
+    /** Subgoal of the cell of the grid, none for other cells */
+    uint32_t subgoalOf(uint32_t cell) const { return m_subgoalOf[cell]; }
+
+    uint32_t cell(uint32_t subgoal) const { return m_cells[subgoal]; }
+
+    /** Cells of the subgoals connected to the subgoal */
+    const uint32_t *neighboursBegin(uint32_t subgoal) const { return m_targets.data() + m_offsets[subgoal]; }
+
+    const uint32_t *neighboursEnd(uint32_t subgoal) const { return m_targets.data() + m_offsets[subgoal + 1]; }
+
+    /**
+    * @brief Fills found with the cells of the subgoals h-reachable from the cell at (x, y) without passing another subgoal
+    * - The cell itself is not added, it may be a wall (the path then leaves it to a free neighbour)
+    * - target (a cell, none for no target) is added too if it is h-reachable the same way
+    * - Cells are sorted and unique
+    **/
+    void reachable(const SearchGrid &grid, int x, int y, uint32_t target, std::vector<uint32_t> &found) const;
+
+    size_t bytes(void) const;
+
+private:
+    /** Reachable of one quadrant, x grows in direction dx and y in direction dy */
+    void quadrant(const SearchGrid &grid, int x, int y, int dx, int dy, uint32_t target, std::vector<uint32_t> &found) const;
+
+    std::vector<uint32_t> m_subgoalOf;
+
+    std::vector<uint32_t> m_cells;
+
+    /** Edges of subgoal s are m_targets[m_offsets[s]] to m_targets[m_offsets[s + 1]] */
+    std::vector<uint32_t> m_offsets;
+
+    std::vector<uint32_t> m_targets;
+};
+
+/** Grid of one subgoal search, the graph with the start and the goal connected to it */
+class SubgoalGrid
+{
+public:
+    SubgoalGrid(const SearchGrid &grid, const SubgoalGraph &subgoals, Position start, Position goal);
+
+    uint32_t width(void) const { return m_grid.width(); }
+
+    uint32_t height(void) const { return m_grid.height(); }
+
+    size_t size(void) const { return m_grid.size(); }
+
+    uint32_t index(int x, int y) const { return m_grid.index(x, y); }
+
+    Position position(uint32_t cell) const { return m_grid.position(cell); }
+
+    bool inside(int x, int y) const { return m_grid.inside(x, y); }
+
+    bool passable(int x, int y) const { return m_grid.passable(x, y); }
+
+    bool passable(uint32_t cell) const { return m_grid.passable(cell); }
+
+    const SubgoalGraph &subgoals(void) const { return m_subgoals; }
+
+    uint32_t startCell(void) const { return m_start; }
+
+    uint32_t goalCell(void) const { return m_goal; }
+
+    /** Cells h-reachable from the start: subgoals and the goal */
+    const std::vector<uint32_t> &fromStart(void) const { return m_fromStart; }
+
+    /** Subgoal cell has an edge to the goal */
+    bool reachesGoal(uint32_t cell) const { return std::binary_search(m_toGoal.begin(), m_toGoal.end(), cell); }
+
+private:
+    const SearchGrid &m_grid;
+
+    const SubgoalGraph &m_subgoals;
+
+    uint32_t m_start = SubgoalGraph::none;
+
+    uint32_t m_goal = SubgoalGraph::none;
+
+    std::vector<uint32_t> m_fromStart;
+
+    std::vector<uint32_t> m_toGoal;
+};
+
+/**
+* @brief Neighbourhood of the subgoal search, costs are Manhattan distances (the lengths of the h-reachable paths)
+* - Start reaches the cells of SubgoalGrid::fromStart, a subgoal its neighbours in the graph and the goal if it is
+*   connected to it; other cells have no neighbours
+**/
+struct SubgoalEdges
+{
+    template <typename Visit>
+    static void forEach(const SubgoalGrid &grid, int x, int y, Visit &&visit)
+    {
+        const SubgoalGraph &subgoals = grid.subgoals();
+        uint32_t cell = grid.index(x, y);
+        auto edge = [&](uint32_t next) {
+            Position pos = grid.position(next);
+            visit(pos.first, pos.second, std::abs(pos.first - x) + std::abs(pos.second - y));
+        };
+
+        if (cell == grid.startCell())
+        {
+            for (uint32_t next: grid.fromStart())
+                edge(next);
+            return;
+        }
+
+        uint32_t subgoal = subgoals.subgoalOf(cell);
+        if (subgoal == SubgoalGraph::none)
+            return;
+        for (const uint32_t *next = subgoals.neighboursBegin(subgoal); next != subgoals.neighboursEnd(subgoal); next++)
+            edge(*next);
+        if (grid.reachesGoal(cell))
+            edge(grid.goalCell());
+    }
+};
+
+/** Fills the cells between consecutive positions of path, which are h-reachable from each other */
+void refineSubgoalPath(SearchPath &path, const SearchGrid &grid);
+
+/**
+* @brief BFS and A* over the subgoal graph (built on the first use), other algorithms run over all cells
+* - BFS is uniform cost search over the graph, it finds a path as short as BFS, not necessarily the same one
+* - Trace receives only the expanded subgoals (and the start and goal), path receives every cell
+**/
+template <typename Trace>
+KernelStats runSubgoalAlgorithm(SearchAlgorithmType algoType, const GridMap &map, SearchWorkspace &work, Trace &trace, Position start,
+                                Position goal, SearchPath *path, double suboptimality = defaultSuboptimality)
+{
+    if (algoType != SearchAlgorithmType::BFS && algoType != SearchAlgorithmType::AStar)
+        return runAlgorithm(algoType, map.searchGrid(), work, trace, start, goal, path, suboptimality);
+
+    SubgoalGrid grid(map.searchGrid(), map.subgoals(), start, goal);
+    ZeroHeuristic zero;
+    ManhattanHeuristic manhattan;
+    KernelStats stats = algoType == SearchAlgorithmType::BFS
+                            ? searchKernel<SubgoalEdges, ZeroHeuristic, BestFirstOpen<AStarKey>>(grid, work, zero, trace, start, goal, path)
+                            : searchKernel<SubgoalEdges, ManhattanHeuristic, BestFirstOpen<AStarKey>>(grid, work, manhattan, trace, start,
+                                                                                                      goal, path);
+    if (path)
+        refineSubgoalPath(*path, map.searchGrid());
+    return stats;
+}
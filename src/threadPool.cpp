@@ -0,0 +1,52 @@
+/**
+* @file threadPool.cpp
+* @author Ondrej
+* @brief Implementation of ThreadPool
+**/
+
+#include "threadPool.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t threads)
+{
+    if (threads == 0)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    for (size_t i = 0; i < threads; i++)
+        m_threads.emplace_back([this]() { this->run(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wakeUp.notify_all();
+
+    for (auto &thread: m_threads)
+        thread.join();
+}
+
+/** Takes tasks until the pool is destroyed and the queue is empty */
+void ThreadPool::run(void)
+{
+    PROFILE_THREAD("pool worker");
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeUp.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+            if (m_tasks.empty())
+                return;
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        PROFILE_ZONE("task");
+        task();
+    }
+}
@@ -0,0 +1,62 @@
+/**
+* @file threadPool.hpp
+* @author Ondrej
+* @brief Fixed number of threads executing submitted tasks in order of submission
+**/
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+class ThreadPool
+{
+public:
+    /** Starts the threads, 0 means one thread per hardware thread */
+    explicit ThreadPool(size_t threads = 0);
+
+    /** Finishes all submitted tasks and joins the threads */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /** Queues task, result (or exception thrown by the task) is available through the future */
+    template <typename Function>
+    auto submit(Function function) -> std::future<decltype(function())>
+    {
+        using Result = decltype(function());
+
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::move(function));
+        std::future<Result> result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push_back([task]() { (*task)(); });
+        }
+        m_wakeUp.notify_one();
+        return result;
+    }
+
+    size_t size(void) const { return m_threads.size(); }
+
+private:
+    /** Loop of one thread */
+    void run(void);
+
+    std::vector<std::thread> m_threads;
+
+    std::deque<std::function<void()>> m_tasks;
+
+    std::mutex m_mutex;
+
+    std::condition_variable m_wakeUp;
+
+    bool m_stopping = false;
+};
@@ -0,0 +1,171 @@
+/**
+* @file boundedBench.cpp
+* @author Ondrej
+* @brief Expansions against path cost of weighted A* and focal search over suboptimality bounds
+*
+* Every map is searched from its start to its end by A* and, for every epsilon, by weighted A* and focal search. Rows
+* are totals over the maps with a path:
+* - expanded: all expansions and their share of the A* expansions
+* - cost: sum of path costs divided by the sum of the optimal ones, and the worst ratio of a single map
+* - ms: sum of the best times of the repeated searches
+* Paths longer than 1 + epsilon times the optimal one are reported and make the benchmark fail.
+**/
+
+#include "conversion.hpp"
+#include "gridMap.hpp"
+#include "mapRegistry.hpp"
+#include "searchKernel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+/** Milliseconds taken by run */
+template <typename Run>
+static double elapsedMs(Run &&run)
+{
+    auto begin = std::chrono::steady_clock::now();
+    run();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+/** Totals of one algorithm and bound over the maps */
+struct CurvePoint
+{
+    size_t expanded = 0;
+    double cost = 0.0;
+    double worstRatio = 1.0;
+    double ms = 0.0;
+};
+
+/**
+* @brief Runs the benchmark
+* - Arguments: map files or directories of maps (default "dataset")
+* - --repeat <n>: every search is run n times and the best time is used (default 3)
+* - --epsilon <e>: bound to measure, repeat for more (default 0, 0.1, 0.25, 0.5, 1, 2 and 5)
+*/
+int main(int argc, char **argv)
+{
+    size_t repeat = 3;
+    std::vector<double> bounds;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (argument == "--repeat" && i + 1 < argc)
+        {
+            if (!strToNum(argv[++i], repeat) || repeat == 0)
+                return EXIT_FAILURE;
+        }
+        else if (argument == "--epsilon" && i + 1 < argc)
+        {
+            double bound;
+            if (!strToNum(argv[++i], bound) || !(bound >= 0.0))
+                return EXIT_FAILURE;
+            bounds.push_back(bound);
+        }
+        else if (argument.rfind("--", 0) == 0)
+        {
+            std::cerr << "Unknown option " << argument << std::endl;
+            return EXIT_FAILURE;
+        }
+        else
+            paths.push_back(argument);
+    }
+    if (paths.empty())
+        paths.push_back("dataset");
+    if (bounds.empty())
+        bounds = {0.0, 0.1, 0.25, 0.5, 1.0, 2.0, 5.0};
+
+    MapRegistry registry;
+    for (const auto &path: paths)
+    {
+        if (fs::is_directory(path))
+            registry.addDirectory(path);
+        else
+            registry.add(fs::path(path).filename().string(), path);
+    }
+    for (const auto &error: registry.loadAll())
+    {
+        std::cerr << error << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::vector<SearchAlgorithmType> algorithms = {SearchAlgorithmType::WeightedAStar, SearchAlgorithmType::FocalSearch};
+    CurvePoint optimal;
+    std::vector<std::vector<CurvePoint>> curves(algorithms.size(), std::vector<CurvePoint>(bounds.size()));
+    bool violated = false;
+    SearchWorkspace work;
+    NoTrace trace;
+
+    /* Best time of the repeated searches, stats of the last one */
+    auto measure = [&](SearchAlgorithmType algoType, const GridMap &map, double suboptimality, KernelStats &stats) {
+        double best = 0.0;
+        for (size_t i = 0; i < repeat; i++)
+        {
+            double ms = elapsedMs([&]() {
+                stats = runAlgorithm(algoType, map.searchGrid(), work, trace, map.start(), map.end(), nullptr, suboptimality);
+            });
+            best = i == 0 ? ms : std::min(best, ms);
+        }
+        return best;
+    };
+
+    for (const auto &name: registry.names())
+    {
+        auto map = registry.get(name);
+        KernelStats astar;
+        double astarMs = measure(SearchAlgorithmType::AStar, *map, 0.0, astar);
+        if (!astar.found || astar.cost == 0.0)
+            continue;
+
+        optimal.expanded += astar.expanded;
+        optimal.cost += astar.cost;
+        optimal.ms += astarMs;
+
+        for (size_t algo = 0; algo < algorithms.size(); algo++)
+        {
+            for (size_t bound = 0; bound < bounds.size(); bound++)
+            {
+                KernelStats stats;
+                CurvePoint &point = curves[algo][bound];
+                point.ms += measure(algorithms[algo], *map, bounds[bound], stats);
+                point.expanded += stats.expanded;
+                point.cost += stats.cost;
+                point.worstRatio = std::max(point.worstRatio, stats.cost / astar.cost);
+
+                if (!stats.found || stats.cost > (1.0 + bounds[bound]) * astar.cost + 1e-9)
+                {
+                    std::cerr << name << " " << algoTypeToStr(algorithms[algo]) << " epsilon " << bounds[bound] << ": cost " << stats.cost
+                              << ", optimal " << astar.cost << std::endl;
+                    violated = true;
+                }
+            }
+        }
+    }
+
+    std::cout << std::left << std::setw(8) << "algo" << std::right << std::setw(9) << "epsilon" << std::setw(12) << "expanded" << std::setw(9)
+              << "of A*" << std::setw(11) << "cost" << std::setw(11) << "worst" << std::setw(11) << "ms" << std::endl;
+    auto row = [&](const std::string &algo, double bound, const CurvePoint &point) {
+        std::cout << std::left << std::setw(8) << algo << std::right << std::fixed << std::setprecision(2) << std::setw(9) << bound
+                  << std::setw(12) << point.expanded << std::setw(8) << std::setprecision(1)
+                  << 100.0 * point.expanded / std::max<size_t>(optimal.expanded, 1) << "%" << std::setprecision(4) << std::setw(11)
+                  << point.cost / std::max(optimal.cost, 1.0) << std::setw(11) << point.worstRatio << std::setprecision(2) << std::setw(11)
+                  << point.ms << std::endl;
+    };
+    row("astar", 0.0, optimal);
+    for (size_t algo = 0; algo < algorithms.size(); algo++)
+    {
+        for (size_t bound = 0; bound < bounds.size(); bound++)
+            row(algoTypeToStr(algorithms[algo]), bounds[bound], curves[algo][bound]);
+    }
+    return violated ? EXIT_FAILURE : EXIT_SUCCESS;
+}
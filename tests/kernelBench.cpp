@@ -0,0 +1,180 @@
+/**
+* @file kernelBench.cpp
+* @author Ondrej
+* @brief Headless throughput of the reference Graph members against the kernel instantiations
+*
+* For every map and algorithm measures the best of the repeated runs of:
+* - reference: the original member of Graph (BFS(), AStar(), ...)
+* - traced: Graph::setUp, the kernel with the tracing policy the visualisation uses
+* - headless: the same kernel with NoTrace
+* and prints the times and the speedup of the headless kernel, the totals are over all maps.
+**/
+
+#include "conversion.hpp"
+#include "graph.hpp"
+#include "mapRegistry.hpp"
+#include "searchKernel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+/** Best time of repeated calls of run in milliseconds */
+template <typename Run>
+static double bestMs(size_t repeat, Run &&run)
+{
+    double best = 0.0;
+    for (size_t i = 0; i < repeat; i++)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        run();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        best = i == 0 ? ms : std::min(best, ms);
+    }
+    return best;
+}
+
+static void runReference(Graph &graph, SearchAlgorithmType algoType)
+{
+    switch (algoType)
+    {
+        case SearchAlgorithmType::BFS:
+            graph.BFS();
+            break;
+        case SearchAlgorithmType::DFS:
+            graph.DFS();
+            break;
+        case SearchAlgorithmType::RandomSearch:
+            graph.RandomSearch();
+            break;
+        case SearchAlgorithmType::GreedySearch:
+            graph.GreedySearch();
+            break;
+        case SearchAlgorithmType::AStar:
+            graph.AStar();
+            break;
+        case SearchAlgorithmType::WeightedAStar:
+        case SearchAlgorithmType::FocalSearch:
+            /* Only kernels, there are no reference members */
+            break;
+    }
+}
+
+/**
+* @brief Runs the benchmark
+* - Arguments: map files or directories of maps (default "dataset")
+* - --repeat <n>: every search is run n times and the best time is used (default 3)
+* - --algo <name>: only this algorithm
+*/
+int main(int argc, char **argv)
+{
+    size_t repeat = 3;
+    std::vector<SearchAlgorithmType> algorithms;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+        SearchAlgorithmType algoType;
+
+        if (argument == "--repeat" && hasValue)
+        {
+            if (!strToNum(argv[++i], repeat) || repeat == 0)
+                return EXIT_FAILURE;
+        }
+        else if (argument == "--algo" && hasValue)
+        {
+            if (!strToAlgoType(argv[++i], algoType) || isBoundedAlgorithm(algoType))
+            {
+                std::cerr << "Unknown algorithm or algorithm without reference member " << argv[i] << std::endl;
+                return EXIT_FAILURE;
+            }
+            algorithms.push_back(algoType);
+        }
+        else if (argument.rfind("--", 0) == 0)
+        {
+            std::cerr << "Unknown option " << argument << std::endl;
+            return EXIT_FAILURE;
+        }
+        else
+            paths.push_back(argument);
+    }
+
+    if (paths.empty())
+        paths.push_back("dataset");
+    if (algorithms.empty())
+    {
+        /* Weighted A* and focal search have no reference member, bench-bounded measures them */
+        for (int state = 0; state < searchAlgorithmCount; state++)
+        {
+            if (!isBoundedAlgorithm(static_cast<SearchAlgorithmType>(state)))
+                algorithms.push_back(static_cast<SearchAlgorithmType>(state));
+        }
+    }
+
+    /* All maps are loaded in parallel before anything is measured */
+    MapRegistry registry;
+    for (const auto &path: paths)
+    {
+        if (fs::is_directory(path))
+            registry.addDirectory(path);
+        else
+            registry.add(fs::path(path).filename().string(), path);
+    }
+    for (const auto &error: registry.loadAll())
+    {
+        std::cerr << error << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << std::left << std::setw(34) << "map" << std::setw(8) << "algo" << std::right << std::setw(10) << "visited"
+              << std::setw(14) << "reference ms" << std::setw(12) << "traced ms" << std::setw(13) << "headless ms" << std::setw(10)
+              << "speedup" << std::endl;
+
+    std::vector<double> totals(3, 0.0);
+    SearchWorkspace work;
+    for (const auto &name: registry.names())
+    {
+        Graph graph(registry.get(name), SearchAlgorithmType::BFS);
+        for (SearchAlgorithmType algoType: algorithms)
+        {
+            double reference = bestMs(repeat, [&]() {
+                graph.reset();
+                runReference(graph, algoType);
+            });
+            double traced = bestMs(repeat, [&]() {
+                graph.reset();
+                graph.setUp(static_cast<int>(algoType));
+            });
+
+            NoTrace trace;
+            KernelStats stats;
+            SearchPath path;
+            double headless = bestMs(repeat, [&]() {
+                stats = runAlgorithm(algoType, graph.searchGrid(), work, trace, graph.startPos(), graph.endPos(), &path);
+            });
+
+            totals[0] += reference;
+            totals[1] += traced;
+            totals[2] += headless;
+
+            std::cout << std::left << std::setw(34) << name << std::setw(8) << algoTypeToStr(algoType)
+                      << std::right << std::fixed << std::setprecision(3) << std::setw(10) << stats.visited << std::setw(14) << reference
+                      << std::setw(12) << traced << std::setw(13) << headless << std::setw(9) << std::setprecision(1)
+                      << reference / std::max(headless, 1e-6) << "x" << std::endl;
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(1) << "total: reference " << totals[0] << " ms, traced " << totals[1] << " ms ("
+              << totals[0] / std::max(totals[1], 1e-6) << "x), headless " << totals[2] << " ms (" << totals[0] / std::max(totals[2], 1e-6)
+              << "x)" << std::endl;
+    return EXIT_SUCCESS;
+}
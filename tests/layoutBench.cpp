@@ -0,0 +1,241 @@
+/**
+* @file layoutBench.cpp
+* @author Ondrej
+* @brief Search time and cache misses of the kernels over the cell layouts
+*
+* For every map, algorithm and layout (row-major, Morton, 8x8 tiles) measures the best of the repeated headless
+* searches and the cache misses of one search (L1 data read misses and last level cache misses, read from the
+* hardware counters by perf_event_open, "-" where the kernel does not allow it). All layouts have to find the
+* same path, the totals are over all maps.
+**/
+
+#include "conversion.hpp"
+#include "graph.hpp"
+#include "gridMap.hpp"
+#include "mapRegistry.hpp"
+#include "searchKernel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+/** Hardware counter of this thread, invalid if the kernel refuses to open it (perf_event_paranoid, containers) */
+class CacheCounter
+{
+public:
+    CacheCounter(uint32_t type, uint64_t config)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        m_fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    ~CacheCounter()
+    {
+        if (m_fd >= 0)
+            close(m_fd);
+    }
+
+    CacheCounter(const CacheCounter &) = delete;
+    CacheCounter &operator=(const CacheCounter &) = delete;
+
+    bool valid(void) const { return m_fd >= 0; }
+
+    void start(void)
+    {
+        if (!this->valid())
+            return;
+        ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    /** Events since start */
+    uint64_t stop(void)
+    {
+        uint64_t count = 0;
+        if (!this->valid())
+            return count;
+        ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(m_fd, &count, sizeof(count)) != sizeof(count))
+            count = 0;
+        return count;
+    }
+
+private:
+    int m_fd;
+};
+
+/** Result of one map, algorithm and layout */
+struct LayoutResult
+{
+    double ms = 0.0;
+    uint64_t l1Misses = 0;
+    uint64_t llcMisses = 0;
+    SearchPath path;
+};
+
+/** Best time of the repeated searches over grid, cache misses of the last one */
+template <typename Grid>
+static LayoutResult measure(const Grid &grid, SearchAlgorithmType algoType, Position start, Position goal, size_t repeat,
+                            CacheCounter &l1, CacheCounter &llc)
+{
+    LayoutResult result;
+    SearchWorkspace work;
+    NoTrace trace;
+    for (size_t i = 0; i < repeat; i++)
+    {
+        l1.start();
+        llc.start();
+        auto begin = std::chrono::steady_clock::now();
+        runAlgorithm(algoType, grid, work, trace, start, goal, &result.path);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        result.llcMisses = llc.stop();
+        result.l1Misses = l1.stop();
+        result.ms = i == 0 ? ms : std::min(result.ms, ms);
+    }
+    return result;
+}
+
+/** Count in thousands, "-" without the counter */
+static std::string thousands(const CacheCounter &counter, uint64_t count)
+{
+    return counter.valid() ? std::to_string(count / 1000) + "k" : "-";
+}
+
+/**
+* @brief Runs the benchmark
+* - Arguments: map files or directories of maps (default "dataset")
+* - --repeat <n>: every search is run n times and the best time is used (default 5)
+* - --algo <name>: only this algorithm (default bfs and astar)
+*/
+int main(int argc, char **argv)
+{
+    size_t repeat = 5;
+    std::vector<SearchAlgorithmType> algorithms;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+        SearchAlgorithmType algoType;
+
+        if (argument == "--repeat" && hasValue)
+        {
+            if (!strToNum(argv[++i], repeat) || repeat == 0)
+                return EXIT_FAILURE;
+        }
+        else if (argument == "--algo" && hasValue)
+        {
+            if (!strToAlgoType(argv[++i], algoType))
+            {
+                std::cerr << "Unknown algorithm " << argv[i] << std::endl;
+                return EXIT_FAILURE;
+            }
+            algorithms.push_back(algoType);
+        }
+        else if (argument.rfind("--", 0) == 0)
+        {
+            std::cerr << "Unknown option " << argument << std::endl;
+            return EXIT_FAILURE;
+        }
+        else
+            paths.push_back(argument);
+    }
+
+    if (paths.empty())
+        paths.push_back("dataset");
+    if (algorithms.empty())
+        algorithms = {SearchAlgorithmType::BFS, SearchAlgorithmType::AStar};
+
+    MapRegistry registry;
+    for (const auto &path: paths)
+    {
+        if (fs::is_directory(path))
+            registry.addDirectory(path);
+        else
+            registry.add(fs::path(path).filename().string(), path);
+    }
+    for (const auto &error: registry.loadAll())
+    {
+        std::cerr << error << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    CacheCounter l1(PERF_TYPE_HW_CACHE,
+                    PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    CacheCounter llc(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    if (!l1.valid() || !llc.valid())
+        std::cerr << "Hardware cache counters are not available, only times are measured" << std::endl;
+
+    const std::array<std::string, 3> layouts = {"row", "morton", "tiled8"};
+    std::cout << std::left << std::setw(34) << "map" << std::setw(8) << "algo" << std::setw(8) << "layout" << std::right << std::setw(10)
+              << "ms" << std::setw(12) << "L1 misses" << std::setw(12) << "LLC misses" << std::endl;
+
+    std::array<double, 3> totalMs = {0.0, 0.0, 0.0};
+    std::array<uint64_t, 3> totalL1 = {0, 0, 0};
+    std::array<uint64_t, 3> totalLlc = {0, 0, 0};
+    bool mismatch = false;
+
+    for (const auto &name: registry.names())
+    {
+        auto map = registry.get(name);
+        MortonSearchGrid morton(map->grid());
+        BlockedSearchGrid blocked(map->grid());
+
+        for (SearchAlgorithmType algoType: algorithms)
+        {
+            std::array<LayoutResult, 3> results = {
+                measure(map->searchGrid(), algoType, map->start(), map->end(), repeat, l1, llc),
+                measure(morton, algoType, map->start(), map->end(), repeat, l1, llc),
+                measure(blocked, algoType, map->start(), map->end(), repeat, l1, llc),
+            };
+
+            for (size_t layout = 0; layout < layouts.size(); layout++)
+            {
+                const LayoutResult &result = results[layout];
+                totalMs[layout] += result.ms;
+                totalL1[layout] += result.l1Misses;
+                totalLlc[layout] += result.llcMisses;
+
+                std::cout << std::left << std::setw(34) << name << std::setw(8) << algoTypeToStr(algoType) << std::setw(8) << layouts[layout]
+                          << std::right << std::fixed << std::setprecision(3) << std::setw(10) << result.ms << std::setw(12)
+                          << thousands(l1, result.l1Misses) << std::setw(12) << thousands(llc, result.llcMisses) << std::endl;
+
+                if (result.path != results[0].path)
+                {
+                    std::cerr << name << " " << algoTypeToStr(algoType) << ": " << layouts[layout] << " layout found other path" << std::endl;
+                    mismatch = true;
+                }
+            }
+        }
+    }
+
+    for (size_t layout = 0; layout < layouts.size(); layout++)
+    {
+        std::cout << std::fixed << std::setprecision(1) << "total " << layouts[layout] << ": " << totalMs[layout] << " ms ("
+                  << totalMs[0] / std::max(totalMs[layout], 1e-6) << "x of row), L1 misses " << thousands(l1, totalL1[layout])
+                  << ", LLC misses " << thousands(llc, totalLlc[layout]) << std::endl;
+    }
+    return mismatch ? EXIT_FAILURE : EXIT_SUCCESS;
+}
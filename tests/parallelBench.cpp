@@ -0,0 +1,248 @@
+/**
+* @file parallelBench.cpp
+* @author Ondrej
+* @brief Speedup of hash-distributed parallel A* over the thread counts against single-threaded A*
+*
+* For every map searches from its start to its end with:
+* - reference: Graph::AStar, the original member of Graph
+* - kernel: single-threaded A* kernel (runAlgorithm)
+* - HDA* with 1, 2, 4, ... threads (parallelSearch.hpp)
+* and prints the best time of the repeated searches, expansions and nodes sent between threads. Speedups are against
+* the reference and against the kernel, totals are over all maps. Parallel paths have to be as long as the kernel ones.
+* Threads beyond the hardware threads only time-slice, so the curve flattens (or drops) there.
+**/
+
+#include "conversion.hpp"
+#include "graph.hpp"
+#include "gridMap.hpp"
+#include "mapGenerator.hpp"
+#include "mapRegistry.hpp"
+#include "parallelSearch.hpp"
+#include "searchKernel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+/** Milliseconds taken by run */
+template <typename Run>
+static double elapsedMs(Run &&run)
+{
+    auto begin = std::chrono::steady_clock::now();
+    run();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+/** Best time of repeated runs */
+template <typename Run>
+static double bestMs(size_t repeat, Run &&run)
+{
+    double best = 0.0;
+    for (size_t i = 0; i < repeat; i++)
+    {
+        double ms = elapsedMs(run);
+        best = i == 0 ? ms : std::min(best, ms);
+    }
+    return best;
+}
+
+/** Collects the rows of a generated map into MapGrid, so large maps do not have to be written to a file */
+class GridCollector : public MapWriter
+{
+public:
+    void begin(uint32_t rows, uint32_t cols, Position start, const std::vector<Position> &goals) override
+    {
+        m_grid.clear();
+        m_grid.reserve(rows);
+        m_cols = cols;
+        m_start = start;
+        m_goals = goals;
+    }
+
+    void writeRow(const std::vector<CellType> &row) override
+    {
+        m_grid.emplace_back(m_cols);
+        for (size_t x = 0; x < row.size(); x++)
+            m_grid.back()[x] = static_cast<uint8_t>(row[x]);
+    }
+
+    void finish(void) override {}
+
+    std::shared_ptr<const GridMap> map(void) { return std::make_shared<const GridMap>(std::move(m_grid), m_start, m_goals); }
+
+private:
+    MapGrid m_grid;
+
+    uint32_t m_cols = 0;
+
+    Position m_start;
+
+    std::vector<Position> m_goals;
+};
+
+/**
+* @brief Runs the benchmark
+* - Arguments: map files or directories of maps (default "dataset")
+* - --repeat <n>: every search is run n times and the best time is used (default 3)
+* - --max-threads <n>: thread counts are powers of two up to n (default twice the hardware threads, at least 4)
+* - --generate <size>: adds a generated rooms map of size x size cells, searched from corner to corner
+* - --no-reference: skips Graph::AStar, it is slow on generated maps of millions of cells
+*/
+int main(int argc, char **argv)
+{
+    size_t repeat = 3;
+    size_t maxThreads = std::max<size_t>(2 * std::thread::hardware_concurrency(), 4);
+    size_t generatedSize = 0;
+    bool reference = true;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (argument == "--repeat" && i + 1 < argc)
+        {
+            if (!strToNum(argv[++i], repeat) || repeat == 0)
+                return EXIT_FAILURE;
+        }
+        else if (argument == "--max-threads" && i + 1 < argc)
+        {
+            if (!strToNum(argv[++i], maxThreads) || maxThreads == 0)
+                return EXIT_FAILURE;
+        }
+        else if (argument == "--generate" && i + 1 < argc)
+        {
+            if (!strToNum(argv[++i], generatedSize) || generatedSize < 16 || generatedSize > maxGeneratedSize)
+                return EXIT_FAILURE;
+        }
+        else if (argument == "--no-reference")
+            reference = false;
+        else if (argument.rfind("--", 0) == 0)
+        {
+            std::cerr << "Unknown option " << argument << std::endl;
+            return EXIT_FAILURE;
+        }
+        else
+            paths.push_back(argument);
+    }
+    if (paths.empty() && generatedSize == 0)
+        paths.push_back("dataset");
+
+    MapRegistry registry;
+    for (const auto &path: paths)
+    {
+        if (fs::is_directory(path))
+            registry.addDirectory(path);
+        else
+            registry.add(fs::path(path).filename().string(), path);
+    }
+    for (const auto &error: registry.loadAll())
+    {
+        std::cerr << error << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<std::pair<std::string, std::shared_ptr<const GridMap>>> maps;
+    for (const auto &name: registry.names())
+        maps.emplace_back(name, registry.get(name));
+    if (generatedSize > 0)
+    {
+        GeneratorOptions options;
+        options.family = MapFamily::Rooms;
+        options.rows = static_cast<uint32_t>(generatedSize);
+        options.cols = static_cast<uint32_t>(generatedSize);
+        options.roomSize = 16;
+        GridCollector collector;
+        generateMap(options, collector);
+        maps.emplace_back("rooms " + std::to_string(generatedSize) + "x" + std::to_string(generatedSize), collector.map());
+    }
+
+    std::vector<size_t> threadCounts;
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+        threadCounts.push_back(threads);
+
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+    std::cout << std::left << std::setw(34) << "map" << std::right << std::setw(10) << "length" << std::setw(12) << "ref ms" << std::setw(12)
+              << "kernel ms";
+    for (size_t threads: threadCounts)
+        std::cout << std::setw(12) << "hda" + std::to_string(threads) + " ms";
+    std::cout << std::endl;
+
+    double totalReference = 0.0;
+    double totalKernel = 0.0;
+    std::vector<double> totalParallel(threadCounts.size(), 0.0);
+    bool mismatch = false;
+    SearchWorkspace work;
+    NoTrace trace;
+
+    for (const auto &[name, map]: maps)
+    {
+        Position start = map->start();
+        Position goal = map->end();
+        const SearchGrid &grid = map->searchGrid();
+
+        double referenceMs = 0.0;
+        if (reference)
+        {
+            Graph graph(map, SearchAlgorithmType::AStar);
+            referenceMs = bestMs(repeat, [&]() {
+                graph.reset();
+                graph.AStar();
+            });
+        }
+
+        SearchPath kernelPath;
+        KernelStats kernelStats;
+        double kernelMs = bestMs(repeat, [&]() { kernelStats = runAlgorithm(SearchAlgorithmType::AStar, grid, work, trace, start, goal, &kernelPath); });
+        totalReference += referenceMs;
+        totalKernel += kernelMs;
+
+        std::cout << std::left << std::setw(34) << name << std::right << std::setw(10) << kernelPath.size() << std::fixed << std::setprecision(3)
+                  << std::setw(12) << referenceMs << std::setw(12) << kernelMs;
+
+        std::vector<std::string> details;
+        for (size_t i = 0; i < threadCounts.size(); i++)
+        {
+            ParallelAStar search(threadCounts[i]);
+            SearchPath path;
+            KernelStats stats;
+            double ms = bestMs(repeat, [&]() { stats = search.search(grid, start, goal, &path); });
+            totalParallel[i] += ms;
+            std::cout << std::setw(12) << ms;
+
+            if (path.size() != kernelPath.size())
+            {
+                std::cerr << name << " HDA* " << threadCounts[i] << ": path has " << path.size() << " positions, A* " << kernelPath.size() << std::endl;
+                mismatch = true;
+            }
+            details.push_back("hda" + std::to_string(threadCounts[i]) + " " + std::to_string(stats.expanded) + " exp, " +
+                              std::to_string(search.messages()) + " sent");
+        }
+        std::cout << std::endl << "    kernel " << kernelStats.expanded << " exp";
+        for (const auto &detail: details)
+            std::cout << "; " << detail;
+        std::cout << std::endl;
+    }
+
+    std::cout << std::fixed << std::setprecision(2);
+    if (reference)
+        std::cout << "total reference: " << totalReference << " ms" << std::endl;
+    std::cout << "total kernel: " << totalKernel << " ms" << std::endl;
+    for (size_t i = 0; i < threadCounts.size(); i++)
+    {
+        double ms = std::max(totalParallel[i], 1e-6);
+        std::cout << "total hda" << threadCounts[i] << ": " << totalParallel[i] << " ms, speedup " << totalKernel / ms << "x of kernel";
+        if (reference)
+            std::cout << ", " << totalReference / ms << "x of reference";
+        std::cout << std::endl;
+    }
+    return mismatch ? EXIT_FAILURE : EXIT_SUCCESS;
+}
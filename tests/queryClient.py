@@ -0,0 +1,243 @@
+#!/usr/bin/env python3
+"""
+@file queryClient.py
+@author Ondrej
+@brief Stands in for callers of the query server, sends pipelined random queries and checks the responses
+
+Usage: tests/queryClient.py <server binary> <text map>... [--queries n] [--socket] [--seed n] [--rsr] [--prune] [--subgoals] [--nearest]
+- Every query is sent twice, as bfs and astar, both have to find paths of the same length
+- Paths have to be connected, start at the start, end at the goal and go only over free cells
+- --rsr, --prune or --subgoals starts the server with rectangular symmetry reduction, dead-end and corridor pruning
+  or subgoal graph search, paths still have to be as short
+- --nearest sends nearest queries (3 nearest of 8 random goals, 40 queries unless --queries is given), distances of
+  the returned goals have to be the 3 smallest BFS distances to the goals
+- Exit status is 0 when all responses are correct
+"""
+
+import collections
+import os
+import random
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+
+
+def load_map(path):
+    """Free cells of a text map (the binary format is not needed here)"""
+    free = set()
+    with open(path) as lines:
+        for y, line in enumerate(lines):
+            if line.startswith("start"):
+                break
+            for x, cell in enumerate(line.rstrip("\n")):
+                if cell.lower() != "x":
+                    free.add((x, y))
+    return free
+
+
+NEAREST_K = 3
+NEAREST_GOALS = 8
+
+
+def make_queries(maps, count, rng, nearest):
+    """Query is (map, start, goals, algo), single goal queries have one goal"""
+    queries = []
+    cells = {name: sorted(free) for name, free in maps.items()}
+    for _ in range(count):
+        name = rng.choice(sorted(maps))
+        start = rng.choice(cells[name])
+        goals = [rng.choice(cells[name]) for _ in range(NEAREST_GOALS if nearest else 1)]
+        for algo in ("bfs", "astar"):
+            queries.append((name, start, goals, algo))
+    return queries
+
+
+def request(query, nearest):
+    name, start, goals, algo = query
+    if not nearest:
+        return "%s %d %d %d %d %s\n" % (name, start[0], start[1], goals[0][0], goals[0][1], algo)
+    return "%s %d %d nearest %d %s %s\n" % (name, start[0], start[1], NEAREST_K, algo, " ".join("%d %d" % goal for goal in goals))
+
+
+def parse_path(text):
+    return [tuple(map(int, step.split(","))) for step in text.split(";")] if text else []
+
+
+def check_steps(steps, start, goals, free):
+    """Returns error message or None"""
+    if steps[0] != start or steps[-1] not in goals:
+        return "path does not connect start and goal"
+    for a, b in zip(steps, steps[1:]):
+        if abs(a[0] - b[0]) + abs(a[1] - b[1]) != 1:
+            return "path is not connected at %s %s" % (a, b)
+    if any(step not in free for step in steps):
+        return "path goes through a wall"
+    return None
+
+
+def check_path(query, fields, free):
+    """Returns error message or None"""
+    name, start, goals, algo = query
+    length = int(fields[2])
+    steps = parse_path(fields[5]) if len(fields) > 5 else []
+    if len(steps) != length:
+        return "path length %d but %d steps" % (length, len(steps))
+    if not steps:
+        return None
+    return check_steps(steps, start, goals, free)
+
+
+def distances(free, start):
+    """BFS distance (in moves) of every reachable free cell"""
+    distance = {start: 0}
+    queue = collections.deque([start])
+    while queue:
+        x, y = queue.popleft()
+        for cell in ((x - 1, y), (x + 1, y), (x, y - 1), (x, y + 1)):
+            if cell in free and cell not in distance:
+                distance[cell] = distance[(x, y)] + 1
+                queue.append(cell)
+    return distance
+
+
+def check_nearest(query, fields, free, cache):
+    """Returns error message or None, cache keeps BFS distances of the start for the other algorithm"""
+    name, start, goals, algo = query
+    key = (name, start)
+    if key not in cache:
+        cache[key] = distances(free, start)
+    distance = cache[key]
+    expected = sorted(distance[goal] for goal in set(goals) if goal in distance)[:NEAREST_K]
+
+    paths = [parse_path(text) for text in fields[5].split("|")] if len(fields) > 5 and fields[5] else []
+    if int(fields[2]) != len(paths) or len(paths) != len(expected):
+        return "%s goals returned, %d paths, %d expected" % (fields[2], len(paths), len(expected))
+    if len(set(path[-1] for path in paths)) != len(paths):
+        return "goal returned twice"
+    for path, length in zip(paths, expected):
+        if len(path) - 1 != length:
+            return "path to %s has %d moves, %d expected" % (path[-1], len(path) - 1, length)
+        error = check_steps(path, start, goals, free)
+        if error:
+            return error
+    return None
+
+
+def exchange(server, map_args, requests, use_socket, options):
+    """Sends all queries at once, after all responses came asks for stats, returns response lines"""
+    path = os.path.join(tempfile.mkdtemp(), "server.sock")
+    command = [server, "--socket", path] if use_socket else [server]
+    process = subprocess.Popen(command + options + map_args, stdin=subprocess.PIPE, stdout=subprocess.PIPE)
+    try:
+        if use_socket:
+            for _ in range(600):
+                if os.path.exists(path):
+                    break
+                time.sleep(0.05)
+            client = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+            client.connect(path)
+            output = client.makefile("wb")
+            responses = client.makefile("rb")
+        else:
+            output = process.stdin
+            responses = process.stdout
+
+        output.write("".join(requests).encode())
+        output.flush()
+        lines = [responses.readline().decode().rstrip("\n") for _ in requests]
+
+        output.write(b"stats\n")
+        output.flush()
+        lines.append(responses.readline().decode().rstrip("\n"))
+        return lines
+    finally:
+        if use_socket:
+            process.terminate()
+        else:
+            process.stdin.close()
+        process.wait()
+
+
+def main(argv):
+    count = None
+    seed = 1
+    use_socket = False
+    nearest = False
+    options = []
+    arguments = []
+    i = 1
+    while i < len(argv):
+        if argv[i] == "--queries":
+            count = int(argv[i + 1])
+            i += 1
+        elif argv[i] == "--seed":
+            seed = int(argv[i + 1])
+            i += 1
+        elif argv[i] == "--socket":
+            use_socket = True
+        elif argv[i] in ("--rsr", "--prune", "--subgoals"):
+            options.append(argv[i])
+        elif argv[i] == "--nearest":
+            nearest = True
+        else:
+            arguments.append(argv[i])
+        i += 1
+
+    if len(arguments) < 2:
+        print(__doc__)
+        return 1
+
+    server, paths = arguments[0], arguments[1:]
+    maps = {os.path.basename(path): load_map(path) for path in paths}
+    if count is None:
+        count = 40 if nearest else 200
+    queries = make_queries(maps, count, random.Random(seed), nearest)
+
+    requests = [request(query, nearest) for query in queries]
+
+    begin = time.time()
+    lines = exchange(server, paths, requests, use_socket, options)
+    seconds = time.time() - begin
+
+    failures = []
+    responses = {}
+    for line in lines:
+        if not line:
+            continue
+        fields = line.split(" ")
+        responses[int(fields[0])] = fields
+
+    if len(responses) != len(requests) + 1:
+        failures.append("%d requests, %d responses" % (len(requests) + 1, len(responses)))
+
+    cache = {}
+    for number, query in enumerate(queries):
+        fields = responses.get(number)
+        if not fields or fields[1] != "ok":
+            failures.append("query %d (%s) failed: %s" % (number, " ".join(map(str, query)), fields))
+            continue
+        if nearest:
+            error = check_nearest(query, fields, maps[query[0]], cache)
+        else:
+            error = check_path(query, fields, maps[query[0]])
+        if error:
+            failures.append("query %d: %s" % (number, error))
+
+    # bfs and astar of the same query follow each other
+    for number in range(0, len(queries), 2):
+        bfs, astar = responses.get(number), responses.get(number + 1)
+        if bfs and astar and bfs[1] == "ok" and astar[1] == "ok" and bfs[2] != astar[2]:
+            failures.append("query %d: bfs path %s, astar path %s" % (number, bfs[2], astar[2]))
+
+    stats = responses.get(len(queries))
+    print("%d queries in %.3f s (%.0f per second) over %s" % (len(queries), seconds, len(queries) / seconds, "socket" if use_socket else "stdin"))
+    print(" ".join(stats[1:]) if stats else "no stats response")
+    for failure in failures[:20]:
+        print("FAIL " + failure)
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,221 @@
+/**
+* @file reductionBench.cpp
+* @author Ondrej
+* @brief Expansions and search time of BFS and A* without and with the map reductions
+*
+* For every map prints the time of building the rectangle and corridor decompositions and the subgoal graph and, for
+* BFS and A*, the expanded cells and the best time of the repeated searches:
+* - plain: the kernel over the whole grid
+* - rsr: interiors of empty rectangles skipped (rectangleSymmetry.hpp)
+* - pruned: dead ends skipped and corridors jumped over (corridorPruning.hpp)
+* - subgoals: search over the subgoal graph (subgoalGraph.hpp)
+* Reduced searches have to find paths as long as the plain ones, the totals are over all maps. The subgoal graph is then
+* compared with plain A* on random queries between free cells of every map: its size and the mean query latency.
+**/
+
+#include "conversion.hpp"
+#include "corridorPruning.hpp"
+#include "graph.hpp"
+#include "gridMap.hpp"
+#include "mapRegistry.hpp"
+#include "rectangleSymmetry.hpp"
+#include "searchKernel.hpp"
+#include "subgoalGraph.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+/** Milliseconds taken by run */
+template <typename Run>
+static double elapsedMs(Run &&run)
+{
+    auto begin = std::chrono::steady_clock::now();
+    run();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+/** Expansions, best time and path length of repeated searches */
+struct ReductionResult
+{
+    size_t expanded = 0;
+    double ms = 0.0;
+    size_t length = 0;
+};
+
+template <typename Search>
+static ReductionResult measure(size_t repeat, Search &&search)
+{
+    ReductionResult result;
+    SearchPath path;
+    for (size_t i = 0; i < repeat; i++)
+    {
+        KernelStats stats;
+        double ms = elapsedMs([&]() { stats = search(path); });
+        result.ms = i == 0 ? ms : std::min(result.ms, ms);
+        result.expanded = stats.expanded;
+    }
+    result.length = path.size();
+    return result;
+}
+
+/**
+* @brief Runs the benchmark
+* - Arguments: map files or directories of maps (default "dataset")
+* - --repeat <n>: every search is run n times and the best time is used (default 3)
+* - --queries <n>: random queries per map for the subgoal latencies (default 200)
+*/
+int main(int argc, char **argv)
+{
+    size_t repeat = 3;
+    size_t queryCount = 200;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (argument == "--repeat" && i + 1 < argc)
+        {
+            if (!strToNum(argv[++i], repeat) || repeat == 0)
+                return EXIT_FAILURE;
+        }
+        else if (argument == "--queries" && i + 1 < argc)
+        {
+            if (!strToNum(argv[++i], queryCount))
+                return EXIT_FAILURE;
+        }
+        else if (argument.rfind("--", 0) == 0)
+        {
+            std::cerr << "Unknown option " << argument << std::endl;
+            return EXIT_FAILURE;
+        }
+        else
+            paths.push_back(argument);
+    }
+    if (paths.empty())
+        paths.push_back("dataset");
+
+    MapRegistry registry;
+    for (const auto &path: paths)
+    {
+        if (fs::is_directory(path))
+            registry.addDirectory(path);
+        else
+            registry.add(fs::path(path).filename().string(), path);
+    }
+    for (const auto &error: registry.loadAll())
+    {
+        std::cerr << error << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::array<std::string, 4> reductions = {"plain", "rsr", "pruned", "subgoals"};
+    std::cout << std::left << std::setw(34) << "map" << std::setw(8) << "algo" << std::right;
+    for (const auto &reduction: reductions)
+        std::cout << std::setw(12) << reduction + " exp" << std::setw(11) << "ms";
+    std::cout << std::endl;
+
+    std::array<size_t, 4> totalExpanded = {0, 0, 0, 0};
+    std::array<double, 4> totalMs = {0.0, 0.0, 0.0, 0.0};
+    bool mismatch = false;
+    SearchWorkspace work;
+    NoTrace trace;
+
+    for (const auto &name: registry.names())
+    {
+        auto map = registry.get(name);
+        double rectanglesMs = elapsedMs([&]() { map->rectangles(); });
+        double corridorsMs = elapsedMs([&]() { map->corridors(); });
+        double subgoalsMs = elapsedMs([&]() { map->subgoals(); });
+        std::cout << name << ": " << map->rectangles().size() << " rectangles (" << std::fixed << std::setprecision(3) << rectanglesMs
+                  << " ms), " << map->corridors().corridors() << " corridors and " << map->corridors().deadEndCells() << " dead-end cells ("
+                  << corridorsMs << " ms), " << map->subgoals().subgoals() << " subgoals (" << subgoalsMs << " ms)" << std::endl;
+
+        for (SearchAlgorithmType algoType: {SearchAlgorithmType::BFS, SearchAlgorithmType::AStar})
+        {
+            Position start = map->start();
+            Position goal = map->end();
+            std::array<ReductionResult, 4> results = {
+                measure(repeat, [&](SearchPath &path) { return runAlgorithm(algoType, map->searchGrid(), work, trace, start, goal, &path); }),
+                measure(repeat, [&](SearchPath &path) { return runRectangleAlgorithm(algoType, *map, work, trace, start, goal, &path); }),
+                measure(repeat, [&](SearchPath &path) { return runCorridorAlgorithm(algoType, *map, work, trace, start, goal, &path); }),
+                measure(repeat, [&](SearchPath &path) { return runSubgoalAlgorithm(algoType, *map, work, trace, start, goal, &path); }),
+            };
+
+            std::cout << std::left << std::setw(34) << name << std::setw(8) << algoTypeToStr(algoType) << std::right;
+            for (size_t reduction = 0; reduction < reductions.size(); reduction++)
+            {
+                const ReductionResult &result = results[reduction];
+                totalExpanded[reduction] += result.expanded;
+                totalMs[reduction] += result.ms;
+                std::cout << std::setw(12) << result.expanded << std::setw(11) << std::setprecision(3) << result.ms;
+                if (result.length != results[0].length)
+                {
+                    std::cerr << name << " " << algoTypeToStr(algoType) << ": " << reductions[reduction] << " path has " << result.length
+                              << " positions, plain " << results[0].length << std::endl;
+                    mismatch = true;
+                }
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    for (size_t reduction = 0; reduction < reductions.size(); reduction++)
+    {
+        std::cout << std::fixed << std::setprecision(1) << "total " << reductions[reduction] << ": " << totalExpanded[reduction] << " expanded, "
+                  << totalMs[reduction] << " ms (" << totalMs[0] / std::max(totalMs[reduction], 1e-6) << "x of plain)" << std::endl;
+    }
+
+    /* Built graphs are kept with the maps, so the queries measure only connecting the start and goal and the search */
+    std::cout << std::endl
+              << std::left << std::setw(34) << "map" << std::right << std::setw(10) << "subgoals" << std::setw(10) << "edges" << std::setw(10)
+              << "KB" << std::setw(11) << "build ms" << std::setw(12) << "astar us" << std::setw(12) << "subgoal us" << std::endl;
+    for (const auto &name: registry.names())
+    {
+        auto map = registry.get(name);
+        const SearchGrid &grid = map->searchGrid();
+        std::vector<std::pair<Position, Position>> queries;
+        std::mt19937 random(11);
+        for (size_t i = 0; i < 100 * queryCount && queries.size() < queryCount && grid.size() > 0; i++)
+        {
+            Position start = grid.position(random() % grid.size());
+            Position goal = grid.position(random() % grid.size());
+            if (grid.passable(start.first, start.second) && grid.passable(goal.first, goal.second) && start != goal)
+                queries.emplace_back(start, goal);
+        }
+        if (queries.empty())
+            continue;
+
+        SearchPath astarPath;
+        SearchPath subgoalPath;
+        double astarMs = 0.0;
+        double subgoalMs = 0.0;
+        for (const auto &[start, goal]: queries)
+        {
+            astarMs += elapsedMs([&]() { runAlgorithm(SearchAlgorithmType::AStar, grid, work, trace, start, goal, &astarPath); });
+            subgoalMs += elapsedMs([&]() { runSubgoalAlgorithm(SearchAlgorithmType::AStar, *map, work, trace, start, goal, &subgoalPath); });
+            if (astarPath.size() != subgoalPath.size())
+            {
+                std::cerr << name << ": subgoal path has " << subgoalPath.size() << " positions, astar " << astarPath.size() << std::endl;
+                mismatch = true;
+            }
+        }
+
+        /* Graph was built above, the second build is timed on its own copy */
+        const SubgoalGraph &subgoals = map->subgoals();
+        double buildMs = elapsedMs([&]() { SubgoalGraph copy(grid); });
+        std::cout << std::left << std::setw(34) << name << std::right << std::setw(10) << subgoals.subgoals() << std::setw(10) << subgoals.edges()
+                  << std::setw(10) << subgoals.bytes() / 1024 << std::setw(11) << std::setprecision(2) << buildMs << std::setw(12)
+                  << 1000.0 * astarMs / queries.size() << std::setw(12) << 1000.0 * subgoalMs / queries.size() << std::endl;
+    }
+    return mismatch ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,1145 @@
+/**
+* @file regression.cpp
+* @author Ondrej
+* @brief Cross-algorithm correctness and performance regression harness
+*
+* For every dataset map and a set of generated maps runs every algorithm and checks:
+* - Every returned path is contiguous, wall-free (except the start cell) and goes from start to end
+* - Visited positions start with start, contain no duplicates and end with end when path was found
+* - All optimal algorithms (isOptimalAlgorithm) return the same path length, weighted A* and focal search
+*   (isBoundedAlgorithm) paths at most 1 + epsilon times as long, also for other epsilons and random queries
+* - Every algorithm finds a path if and only if the optimal ones do
+* - Search time does not exceed the recorded budget by more than the tolerance
+* - On generated maps, search streamed through SearchWorker reports the same steps and can be cancelled
+* - On generated maps, kernel instantiations behind setUp repeat the steps of the reference members of Graph and
+*   8-connected and landmark kernels find paths as short as Dijkstra
+* - Searches over Morton and tiled cell layouts repeat the row-major ones
+* - BFS and A* skipping interiors of empty rectangles or dead ends and corridors, and BFS and A* over the subgoal graph
+*   find valid paths as short as BFS
+* - Multi-goal BFS and A* find the k nearest of random goals with paths as short as single goal BFS to each of them,
+*   maps with more goals keep them through the text and binary formats
+* - Hash-distributed parallel A* with 1, 2 and 4 threads finds valid paths as short as BFS
+* - On generated maps, searches in the arena repeat the plain ones and their allocation counts cover the kernel arrays
+* - MapRegistry loads all maps lazily or in parallel and keeps a copy of a map under another name only once
+* - Profiler writes a trace with the zones and names of all threads
+* - Playback scheduler recovers its batch size after a slow frame and after drawing slower than the frame budget
+**/
+
+#include "conversion.hpp"
+#include "corridorPruning.hpp"
+#include "graph.hpp"
+#include "mapGenerator.hpp"
+#include "mapFormat.hpp"
+#include "mapRegistry.hpp"
+#include "multiGoal.hpp"
+#include "parallelSearch.hpp"
+#include "playbackScheduler.hpp"
+#include "profiler.hpp"
+#include "rectangleSymmetry.hpp"
+#include "resultCache.hpp"
+#include "searchKernel.hpp"
+#include "searchSession.hpp"
+#include "searchWorker.hpp"
+#include "subgoalGraph.hpp"
+#include "threadPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+/** Map that is checked, name is used as a key in the budget file */
+struct TestMap
+{
+    std::string name;
+    std::string path;
+};
+
+/** Settings given on command line */
+struct HarnessOptions
+{
+    std::vector<std::string> datasetDirs;
+    std::string budgetFile = "tests/budgets.txt";
+    double tolerance = 30.0;
+    /** Times under this are mostly noise, they are compared with the budget only above it */
+    double slackMs = 2.0;
+    /** Budgets under this are not checked, a millisecond search is timed mostly by the scheduler */
+    double minBudgetMs = 5.0;
+    /** Timed runs of every search with a checked budget, the best one counts and the runs stop at the first one within
+        the budget; new budgets are the median of all runs, searches without a checked budget run once */
+    size_t repeat = 5;
+    bool updateBudgets = false;
+};
+
+/** Collects failures of one map */
+class Failures
+{
+public:
+    void add(const std::string &algo, const std::string &message) { m_messages.push_back(algo + ": " + message); }
+
+    bool empty(void) const { return m_messages.empty(); }
+
+    const std::vector<std::string> &messages(void) const { return m_messages; }
+
+private:
+    std::vector<std::string> m_messages;
+};
+
+/** Checks that path is contiguous, does not go through walls and connects start and end */
+static void checkPath(const Graph &graph, const std::string &algo, Failures &failures)
+{
+    const auto &path = graph.path();
+    const auto &grid = graph.grid();
+
+    if (path.empty())
+        return;
+
+    if (path.front() != graph.startPos())
+        failures.add(algo, "path does not begin at start");
+    if (path.back() != graph.endPos())
+        failures.add(algo, "path does not end at end");
+
+    for (size_t i = 0; i < path.size(); i++)
+    {
+        Position p = path[i];
+        if (p.second < 0 || p.second >= (int) grid.size() || p.first < 0 || p.first >= (int) grid[p.second].size())
+        {
+            failures.add(algo, "path leaves the map at step " + std::to_string(i));
+            return;
+        }
+        /* Searches begin at start whatever is there (some dataset maps start on a wall), the rest has to be empty */
+        if (i > 0 && grid[p.second][p.first] != 1)
+        {
+            failures.add(algo, "path goes through wall at step " + std::to_string(i));
+            return;
+        }
+        if (i > 0 && std::abs(p.first - path[i - 1].first) + std::abs(p.second - path[i - 1].second) != 1)
+        {
+            failures.add(algo, "path is not contiguous at step " + std::to_string(i));
+            return;
+        }
+    }
+}
+
+/** Checks order of visited positions */
+static void checkTrace(const Graph &graph, const std::string &algo, Failures &failures)
+{
+    const auto &visited = graph.visitedInOrder();
+    if (visited.empty())
+        return;
+
+    if (visited.front() != graph.startPos())
+        failures.add(algo, "first visited position is not start");
+
+    std::set<Position> unique(visited.begin(), visited.end());
+    if (unique.size() != visited.size())
+        failures.add(algo, std::to_string(visited.size() - unique.size()) + " positions visited more than once");
+
+    if (!graph.path().empty() && visited.back() != graph.endPos())
+        failures.add(algo, "end is not the last visited position");
+}
+
+/** Stores streamed result, reads it back from disk through a new cache and checks both limits */
+static void checkResultCache(const Graph &graph, SearchAlgorithmType algoType, std::vector<SearchEvent> events, Failures &failures)
+{
+    std::string algo = algoTypeToStr(algoType);
+    fs::path dir = fs::temp_directory_path() / "graph-regression" / "cache";
+    fs::remove_all(dir);
+
+    std::vector<Position> path(graph.path().begin(), graph.path().end());
+    auto result = std::make_shared<const SearchResult>(std::move(events), path);
+    SearchKey key = searchKey(graph, algoType);
+    {
+        ResultCache cache(dir.string());
+        cache.insert(key, result);
+    }
+
+    ResultCache cache(dir.string());
+    auto loaded = cache.find(key);
+    if (!loaded || cache.stats().diskHits != 1)
+        failures.add(algo, "result was not found in the disk cache");
+    else if (loaded->eventCount() != result->eventCount() || loaded->path() != path ||
+             loaded->visitedCount() != graph.visitedInOrder().size() ||
+             !std::equal(result->events(), result->events() + result->eventCount(), loaded->events(),
+                         [](const SearchEvent &a, const SearchEvent &b) { return a.type == b.type && a.x == b.x && a.y == b.y; }))
+        failures.add(algo, "result read from the disk cache differs");
+    else if (cache.find(key) != loaded || cache.stats().memoryHits != 1)
+        failures.add(algo, "result loaded from disk was not kept in memory");
+
+    SearchKey otherKey = key;
+    otherKey.parameters = 1;
+    if (cache.find(otherKey))
+        failures.add(algo, "cache returned result of other parameters");
+
+    /* Room for exactly one result, the older one is dropped */
+    ResultCache small("", result->bytes(), 0);
+    small.insert(key, result);
+    small.insert(otherKey, result);
+    if (small.find(key) || !small.find(otherKey))
+        failures.add(algo, "memory cache did not drop the least recently used result");
+
+    /* Directory over the limit after the second file, the older one is removed */
+    size_t fileSize = 0;
+    for (const auto &entry: fs::directory_iterator(dir))
+        fileSize += entry.file_size();
+    fs::path trimmedDir = dir.parent_path() / "trimmed";
+    fs::remove_all(trimmedDir);
+    {
+        ResultCache trimmed(trimmedDir.string(), 0, fileSize + fileSize / 2);
+        trimmed.insert(key, result);
+        /* Both files could get the same modification time otherwise */
+        for (const auto &entry: fs::directory_iterator(trimmedDir))
+            fs::last_write_time(entry.path(), fs::last_write_time(entry.path()) - std::chrono::hours(1));
+        trimmed.insert(otherKey, result);
+        if (trimmed.stats().filesRemoved != 1)
+            failures.add(algo, "disk cache did not remove one file over its limit");
+    }
+    ResultCache reopened(trimmedDir.string(), 0, fileSize + fileSize / 2);
+    if (reopened.find(key) || !reopened.find(otherKey))
+        failures.add(algo, "disk cache did not remove the least recently used file");
+
+    fs::remove_all(trimmedDir);
+    fs::remove_all(dir);
+}
+
+/** Runs the search in SearchWorker and compares streamed steps with the trace of the synchronous run */
+static void checkStreaming(Graph &graph, SearchAlgorithmType algoType, Failures &failures)
+{
+    std::string algo = algoTypeToStr(algoType);
+    std::vector<Position> trace(graph.visitedInOrder().begin(), graph.visitedInOrder().end());
+    size_t pathLength = graph.path().size();
+
+    std::vector<Position> streamed;
+    std::vector<SearchEvent> recorded;
+    {
+        SearchWorker worker(graph);
+        worker.setRecording(true);
+
+        /* Cancelled search must stop even when nobody takes its events */
+        worker.start(static_cast<int>(algoType));
+        worker.cancel();
+
+        worker.start(static_cast<int>(algoType));
+        SearchEvent event;
+        while (true)
+        {
+            if (!worker.poll(event))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            if (event.type == SearchEvent::Type::Done)
+                break;
+            if (event.type == SearchEvent::Type::Visit)
+                streamed.push_back(Position(event.x, event.y));
+        }
+        worker.join();
+        recorded = worker.takeRecording();
+    }
+
+    /* Random search visits different positions every run */
+    if (algoType != SearchAlgorithmType::RandomSearch && streamed != trace)
+        failures.add(algo, "streamed steps differ from the trace of synchronous search");
+    if (streamed.size() != graph.visitedInOrder().size())
+        failures.add(algo, "streamed " + std::to_string(streamed.size()) + " steps, search recorded " +
+                               std::to_string(graph.visitedInOrder().size()));
+    if ((pathLength == 0) != graph.path().empty())
+        failures.add(algo, "streamed search does not agree on path existence");
+
+    if (isCacheableAlgorithm(algoType))
+        checkResultCache(graph, algoType, std::move(recorded), failures);
+}
+
+/** Runs the reference member of the algorithm, the graph keeps its trace */
+static void runReference(Graph &graph, SearchAlgorithmType algoType)
+{
+    graph.reset();
+    switch (algoType)
+    {
+        case SearchAlgorithmType::BFS:
+            graph.BFS();
+            break;
+        case SearchAlgorithmType::DFS:
+            graph.DFS();
+            break;
+        case SearchAlgorithmType::RandomSearch:
+            graph.RandomSearch();
+            break;
+        case SearchAlgorithmType::GreedySearch:
+            graph.GreedySearch();
+            break;
+        case SearchAlgorithmType::AStar:
+            graph.AStar();
+            break;
+        case SearchAlgorithmType::WeightedAStar:
+        case SearchAlgorithmType::FocalSearch:
+            /* Only kernels, there are no reference members */
+            break;
+    }
+}
+
+/** Compares the last (kernel) search of graph with the reference member and with the untraced kernel */
+static void checkKernel(Graph &graph, SearchAlgorithmType algoType, Failures &failures)
+{
+    std::string algo = algoTypeToStr(algoType);
+    std::vector<Position> trace(graph.visitedInOrder().begin(), graph.visitedInOrder().end());
+    SearchPath path(graph.path().begin(), graph.path().end());
+
+    SearchWorkspace work;
+    NoTrace noTrace;
+    SearchPath headlessPath;
+    KernelStats stats = runAlgorithm(algoType, graph.searchGrid(), work, noTrace, graph.startPos(), graph.endPos(), &headlessPath,
+                                     graph.suboptimality());
+
+    /* Random search visits different positions every run */
+    if (algoType == SearchAlgorithmType::RandomSearch)
+    {
+        if (stats.found == path.empty())
+            failures.add(algo, "untraced kernel does not agree on path existence");
+        return;
+    }
+    if (stats.visited != trace.size() || headlessPath != path)
+        failures.add(algo, "untraced kernel visited " + std::to_string(stats.visited) + " positions, traced " + std::to_string(trace.size()));
+    if (isBoundedAlgorithm(algoType))
+        return;
+
+    runReference(graph, algoType);
+    if (std::vector<Position>(graph.visitedInOrder().begin(), graph.visitedInOrder().end()) != trace)
+        failures.add(algo, "kernel visited other positions than the reference member (" + std::to_string(trace.size()) + " and " +
+                               std::to_string(graph.visitedInOrder().size()) + ")");
+    if (graph.path() != path)
+        failures.add(algo, "kernel found other path than the reference member");
+}
+
+/** Kernels the Graph algorithms do not use have to stay optimal */
+static void checkKernelVariants(const Graph &graph, Failures &failures)
+{
+    const SearchGrid &grid = graph.searchGrid();
+    SearchWorkspace work;
+    NoTrace trace;
+    ZeroHeuristic zero;
+    ManhattanHeuristic manhattan;
+    OctileHeuristic octile;
+    LandmarkHeuristic landmarks(grid, LandmarkTable::build<FourConnected>(grid, 4));
+    Position start = graph.startPos();
+    Position end = graph.endPos();
+
+    KernelStats dijkstra4 = searchKernel<FourConnected, ZeroHeuristic, BestFirstOpen<AStarKey>>(grid, work, zero, trace, start, end, nullptr);
+    KernelStats astar4 = searchKernel<FourConnected, ManhattanHeuristic, BestFirstOpen<AStarKey>>(grid, work, manhattan, trace, start, end, nullptr);
+    KernelStats alt4 = searchKernel<FourConnected, LandmarkHeuristic<>, BestFirstOpen<AStarKey>>(grid, work, landmarks, trace, start, end, nullptr);
+    KernelStats dijkstra8 = searchKernel<EightConnected, ZeroHeuristic, BestFirstOpen<AStarKey>>(grid, work, zero, trace, start, end, nullptr);
+    KernelStats astar8 = searchKernel<EightConnected, OctileHeuristic, BestFirstOpen<AStarKey>>(grid, work, octile, trace, start, end, nullptr);
+
+    auto same = [](const KernelStats &a, const KernelStats &b) { return a.found == b.found && std::abs(a.cost - b.cost) < 1e-6; };
+    if (!same(dijkstra4, astar4) || !same(dijkstra4, alt4))
+        failures.add("kernel", "4-connected Dijkstra, A* and landmark A* disagree on path cost");
+    if (!same(dijkstra8, astar8))
+        failures.add("kernel", "8-connected Dijkstra and octile A* disagree on path cost");
+    if (dijkstra8.found && dijkstra8.cost > dijkstra4.cost + 1e-6)
+        failures.add("kernel", "8-connected path is longer than 4-connected one");
+}
+
+/** Layout only changes where cells are stored, searches over the other layouts have to visit and find the same */
+template <typename Grid>
+static void checkLayout(const Graph &graph, const std::string &layout, Failures &failures)
+{
+    Grid grid(graph.grid());
+    SearchWorkspace work;
+    SearchWorkspace rowMajorWork;
+    NoTrace trace;
+
+    for (SearchAlgorithmType algoType: {SearchAlgorithmType::BFS, SearchAlgorithmType::AStar})
+    {
+        SearchPath path;
+        SearchPath rowMajorPath;
+        KernelStats stats = runAlgorithm(algoType, grid, work, trace, graph.startPos(), graph.endPos(), &path);
+        KernelStats rowMajor = runAlgorithm(algoType, graph.searchGrid(), rowMajorWork, trace, graph.startPos(), graph.endPos(), &rowMajorPath);
+        if (stats.visited != rowMajor.visited || path != rowMajorPath)
+            failures.add(algoTypeToStr(algoType), layout + " layout search differs from the row-major one");
+    }
+}
+
+/** Free cells drawn at random, count at most (fewer on maps with few free cells), they may repeat */
+static std::vector<Position> randomFreeCells(const SearchGrid &grid, unsigned seed, size_t count)
+{
+    std::vector<Position> cells;
+    std::mt19937 random(seed);
+    for (size_t i = 0; i < 100 * count && cells.size() < count && grid.size() > 0; i++)
+    {
+        Position cell = grid.position(random() % grid.size());
+        if (grid.passable(cell.first, cell.second))
+            cells.push_back(cell);
+    }
+    return cells;
+}
+
+/** Start and end of the map followed by pairs of different random free cells, count queries at most */
+static std::vector<std::pair<Position, Position>> randomQueries(const Graph &graph, unsigned seed, size_t count)
+{
+    std::vector<std::pair<Position, Position>> queries = {{graph.startPos(), graph.endPos()}};
+    std::vector<Position> cells = randomFreeCells(graph.searchGrid(), seed, 2 * (count - 1));
+    for (size_t i = 0; i + 1 < cells.size(); i += 2)
+    {
+        if (cells[i] != cells[i + 1])
+            queries.emplace_back(cells[i], cells[i + 1]);
+    }
+    return queries;
+}
+
+/** Path has to go from start to goal over free cells (start may be a wall) in steps of one cell, returns false and adds
+    a failure if it does not */
+template <typename Path>
+static bool checkGridPath(const SearchGrid &grid, const Path &path, Position start, Position goal, const std::string &algo, Failures &failures)
+{
+    if (path.front() != start || path.back() != goal)
+    {
+        failures.add(algo, "path does not connect start and end");
+        return false;
+    }
+    for (size_t i = 1; i < path.size(); i++)
+    {
+        Position p = path[i];
+        if (!grid.passable(p.first, p.second) || std::abs(p.first - path[i - 1].first) + std::abs(p.second - path[i - 1].second) != 1)
+        {
+            failures.add(algo, "path is not contiguous over free cells at step " + std::to_string(i));
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Searches skipping rectangle interiors or dead ends and corridors, and searches over the subgoal graph have to find
+    valid paths as short as BFS, from the start of the map and between random free cells (often inside rectangles, dead
+    ends or corridors, or away from subgoals, which the searches handle separately) */
+static void checkReductions(const Graph &graph, Failures &failures)
+{
+    const GridMap &map = *graph.map();
+    const SearchGrid &grid = map.searchGrid();
+    SearchWorkspace work;
+    NoTrace trace;
+
+    std::vector<std::pair<Position, Position>> queries = randomQueries(graph, 7, 11);
+
+    for (const auto &[start, goal]: queries)
+    {
+        SearchPath bfsPath;
+        runAlgorithm(SearchAlgorithmType::BFS, grid, work, trace, start, goal, &bfsPath);
+
+        for (int variant = 0; variant < 6; variant++)
+        {
+            SearchAlgorithmType algoType = variant % 2 ? SearchAlgorithmType::AStar : SearchAlgorithmType::BFS;
+            std::string algo = algoTypeToStr(algoType) + (variant < 2 ? " rsr" : variant < 4 ? " pruned" : " subgoals");
+            SearchPath path;
+            if (variant < 2)
+                runRectangleAlgorithm(algoType, map, work, trace, start, goal, &path);
+            else if (variant < 4)
+                runCorridorAlgorithm(algoType, map, work, trace, start, goal, &path);
+            else
+                runSubgoalAlgorithm(algoType, map, work, trace, start, goal, &path);
+            if (path.size() != bfsPath.size())
+            {
+                failures.add(algo, "path has " + std::to_string(path.size()) + " positions, bfs " + std::to_string(bfsPath.size()));
+                continue;
+            }
+            if (!path.empty())
+                checkGridPath(grid, path, start, goal, algo, failures);
+        }
+    }
+}
+
+/** Weighted A* and focal search between random free cells with several bounds, epsilon 0 has to be optimal */
+static void checkBoundedSearch(const Graph &graph, Failures &failures)
+{
+    const SearchGrid &grid = graph.searchGrid();
+    SearchWorkspace work;
+    NoTrace trace;
+
+    std::vector<std::pair<Position, Position>> queries = randomQueries(graph, 17, 6);
+
+    for (const auto &[start, goal]: queries)
+    {
+        SearchPath bfsPath;
+        runAlgorithm(SearchAlgorithmType::BFS, grid, work, trace, start, goal, &bfsPath);
+
+        for (SearchAlgorithmType algoType: {SearchAlgorithmType::WeightedAStar, SearchAlgorithmType::FocalSearch})
+        {
+            for (double suboptimality: {0.0, 0.25, 1.0, 3.0})
+            {
+                std::string algo = algoTypeToStr(algoType) + " " + std::to_string(suboptimality);
+                SearchPath path;
+                KernelStats stats = runAlgorithm(algoType, grid, work, trace, start, goal, &path, suboptimality);
+                if (path.empty() != bfsPath.empty() || stats.found == path.empty())
+                {
+                    failures.add(algo, "does not agree with bfs on path existence");
+                    continue;
+                }
+                if (path.empty())
+                    continue;
+
+                double optimal = static_cast<double>(bfsPath.size() - 1);
+                if (path.size() - 1 > (1.0 + suboptimality) * optimal + 1e-9 || std::abs(stats.cost - (path.size() - 1.0)) > 1e-9)
+                    failures.add(algo, "path has " + std::to_string(path.size()) + " positions, bfs " + std::to_string(bfsPath.size()));
+                checkGridPath(grid, path, start, goal, algo, failures);
+            }
+        }
+    }
+}
+
+/** Nearest k of random goals (some unreachable on maps with more components) from the start of the map and from a
+    random free cell, distances are compared with single goal BFS to every goal */
+static void checkNearestGoals(const Graph &graph, Failures &failures)
+{
+    const GridMap &map = *graph.map();
+    const SearchGrid &grid = map.searchGrid();
+    SearchWorkspace work;
+    NoTrace trace;
+
+    std::vector<Position> freeCells = randomFreeCells(grid, 11, 13);
+    if (freeCells.size() < 2)
+        return;
+
+    /* Last goal is repeated, it has to be found once */
+    std::vector<Position> goals(freeCells.begin() + 1, freeCells.end());
+    goals.push_back(goals.back());
+    const size_t k = 4;
+
+    for (Position start: {graph.startPos(), freeCells.front()})
+    {
+        /* Small maps repeat random cells as well, every cell is one goal */
+        std::vector<size_t> lengths;
+        SearchPath path;
+        std::set<Position> distinct(goals.begin(), goals.end());
+        for (Position goal: distinct)
+        {
+            if (goal == start)
+                lengths.push_back(1);
+            else if (runAlgorithm(SearchAlgorithmType::BFS, grid, work, trace, start, goal, &path).found)
+                lengths.push_back(path.size());
+        }
+        std::sort(lengths.begin(), lengths.end());
+        lengths.resize(std::min(lengths.size(), k));
+
+        for (SearchAlgorithmType algoType: {SearchAlgorithmType::BFS, SearchAlgorithmType::AStar})
+        {
+            std::string algo = algoTypeToStr(algoType) + " nearest";
+            std::vector<GoalPath> found;
+            runNearestGoals(algoType, grid, work, trace, start, goals, k, &found);
+            if (found.size() != lengths.size())
+            {
+                failures.add(algo, "found " + std::to_string(found.size()) + " goals, " + std::to_string(lengths.size()) + " expected");
+                continue;
+            }
+
+            for (size_t i = 0; i < found.size(); i++)
+            {
+                const std::vector<Position> &steps = found[i].path;
+                bool duplicate = std::any_of(found.begin(), found.begin() + i, [&](const GoalPath &other) { return other.goal == found[i].goal; });
+                if (steps.size() != lengths[i])
+                    failures.add(algo, "goal " + std::to_string(i) + " path has " + std::to_string(steps.size()) + " positions, bfs " +
+                                           std::to_string(lengths[i]));
+                else if (duplicate || std::find(goals.begin(), goals.end(), found[i].goal) == goals.end())
+                    failures.add(algo, "goal " + std::to_string(i) + " is not a new goal");
+                else
+                    checkGridPath(grid, steps, start, found[i].goal, algo + " goal " + std::to_string(i), failures);
+            }
+        }
+    }
+}
+
+/** Parallel A* from the start of the map and between random free cells, threads are more than cores on small machines,
+    so the mailboxes and termination are exercised by interleavings as well */
+static void checkParallelAStar(const Graph &graph, Failures &failures)
+{
+    const SearchGrid &grid = graph.map()->searchGrid();
+    SearchWorkspace work;
+    NoTrace trace;
+
+    std::vector<std::pair<Position, Position>> queries = randomQueries(graph, 13, 3);
+
+    for (size_t threads: {1, 2, 4})
+    {
+        ParallelAStar search(threads);
+        std::string algo = "HDA* " + std::to_string(threads);
+        for (const auto &[start, goal]: queries)
+        {
+            SearchPath bfsPath;
+            SearchPath path;
+            runAlgorithm(SearchAlgorithmType::BFS, grid, work, trace, start, goal, &bfsPath);
+            KernelStats stats = search.search(grid, start, goal, &path);
+            if (path.size() != bfsPath.size() || stats.found != !bfsPath.empty())
+            {
+                failures.add(algo, "path has " + std::to_string(path.size()) + " positions, bfs " + std::to_string(bfsPath.size()));
+                continue;
+            }
+            if (path.empty())
+                continue;
+            if (checkGridPath(grid, path, start, goal, algo, failures) && stats.cost + 1 != path.size())
+                failures.add(algo, "cost " + std::to_string(stats.cost) + " does not match the path");
+        }
+    }
+}
+
+/** Map with more goals is written in both formats and loaded back, goals have to keep their order */
+static bool checkGoalFormats(void)
+{
+    Failures failures;
+    std::vector<CellType> row(9, CellType::Empty);
+    std::vector<Position> goals = {Position(8, 4), Position(0, 0), Position(3, 2)};
+    fs::path dir = fs::temp_directory_path() / "graph-regression";
+
+    for (bool binary: {false, true})
+    {
+        fs::path file = dir / (binary ? "goals.bin" : "goals.txt");
+        {
+            std::ofstream output(file, std::ios::binary);
+            std::unique_ptr<MapWriter> writer;
+            if (binary)
+                writer = std::make_unique<BinaryMapWriter>(output);
+            else
+                writer = std::make_unique<TextMapWriter>(output);
+            writer->begin(5, 9, Position(4, 4), goals);
+            for (int y = 0; y < 5; y++)
+                writer->writeRow(row);
+            writer->finish();
+        }
+
+        auto map = GridMap::load(file.string());
+        std::string format = binary ? "binary" : "text";
+        if (map->goals() != goals || map->end() != goals.front() || map->start() != Position(4, 4))
+            failures.add(format, "goals were not read back as written");
+        if (map->searchGrid().width() != 9 || map->searchGrid().height() != 5)
+            failures.add(format, "cells were not read back as written");
+        fs::remove(file);
+    }
+
+    std::cout << (failures.empty() ? "PASS " : "FAIL ") << "map goals" << std::endl;
+    for (const auto &message: failures.messages())
+        std::cout << "    " << message << std::endl;
+    return failures.empty();
+}
+
+/** Frames of a window loop are fed to the scheduler without a window, steps take a microsecond and drawing 2 ms unless
+    stalled, batch size has to come back after a stall */
+static bool checkPlaybackScheduler(void)
+{
+    Failures failures;
+    PlaybackScheduler scheduler(PlaybackScheduler::maxRate);
+    const double stepSeconds = 1e-6;
+    auto frames = [&](size_t count, double drawSeconds) {
+        for (size_t i = 0; i < count; i++)
+        {
+            size_t steps = scheduler.maxStepsPerFrame();
+            scheduler.stepsDone(steps, steps * stepSeconds);
+            scheduler.frameDrawn(drawSeconds);
+        }
+    };
+
+    frames(200, 0.002);
+    size_t steady = scheduler.maxStepsPerFrame();
+    if (steady < 5000)
+        failures.add("steady", "batch of " + std::to_string(steady) + " steps is too small");
+
+    /* One frame stalls for half a second (window dragged), its batch was measured as slow */
+    scheduler.stepsDone(steady, 0.5);
+    scheduler.frameDrawn(0.002);
+    size_t stalled = scheduler.maxStepsPerFrame();
+    frames(200, 0.002);
+    if (stalled >= steady / 2 || scheduler.maxStepsPerFrame() < steady / 2)
+        failures.add("slow frame", "batch went from " + std::to_string(steady) + " to " + std::to_string(stalled) + " and " +
+                                       std::to_string(scheduler.maxStepsPerFrame()) + " steps");
+
+    /* Drawing alone over the frame budget, steps keep their minimal share */
+    frames(200, 0.050);
+    size_t slowDraw = scheduler.maxStepsPerFrame();
+    size_t minimal = static_cast<size_t>(PlaybackScheduler::minStepBudget / PlaybackScheduler::refreshRate / stepSeconds);
+    frames(200, 0.002);
+    if (slowDraw < minimal / 2 || scheduler.maxStepsPerFrame() < steady / 2)
+        failures.add("slow drawing", "batch went from " + std::to_string(slowDraw) + " to " + std::to_string(scheduler.maxStepsPerFrame()) +
+                                         " steps");
+
+    std::cout << (failures.empty() ? "PASS " : "FAIL ") << "playback scheduler (" << steady << " steps per frame)" << std::endl;
+    for (const auto &message: failures.messages())
+        std::cout << "    " << message << std::endl;
+    return failures.empty();
+}
+
+/** Searches twice in the arena of a graph counting its allocations, the second search after the arena was released */
+static void checkSearchMemory(const Graph &graph, Failures &failures)
+{
+    Graph plain(graph, SearchAlgorithmType::AStar);
+    plain.setUp(-1);
+    Graph arena(graph, SearchAlgorithmType::AStar, true, true);
+    for (int run = 0; run < 2; run++)
+    {
+        arena.reset();
+        arena.setUp(-1);
+    }
+
+    if (arena.path() != plain.path() || arena.visitedInOrder() != plain.visitedInOrder())
+        failures.add("arena", "search in the arena differs from the plain one");
+
+    /* Stamps, costs and parents of every cell are allocated by the search too, not only the trace (a few positions of a
+       search to the next cell here) */
+    size_t kernelBytes = graph.searchGrid().size() * (2 * sizeof(uint32_t) + sizeof(double));
+    Position start = graph.startPos();
+    Position next(start.first + 1, start.second);
+    if (!graph.searchGrid().passable(next.first, next.second))
+        next = Position(start.first, start.second + 1);
+    arena.setEndpoints(start, next);
+    arena.reset();
+    arena.setUp(-1);
+    if (arena.searchAllocations().bytes < kernelBytes)
+        failures.add("arena", "search allocated " + std::to_string(arena.searchAllocations().bytes) + " bytes, kernel arrays alone take " +
+                                  std::to_string(kernelBytes));
+}
+
+/** Runs all algorithms at once on graphs sharing the map of graph (as the background precomputation does),
+    results have to match the sequential runs */
+static void checkSharedMap(const Graph &graph, const std::vector<size_t> &visitedCounts, Failures &failures)
+{
+    std::vector<std::unique_ptr<Graph>> graphs;
+    for (int state = 0; state < searchAlgorithmCount; state++)
+        graphs.push_back(std::make_unique<Graph>(graph, static_cast<SearchAlgorithmType>(state)));
+
+    ResultCache cache("");
+    std::atomic<bool> cancel{false};
+    {
+        ThreadPool pool(searchAlgorithmCount);
+        std::vector<std::future<void>> done;
+        for (auto &shared: graphs)
+        {
+            Graph *search = shared.get();
+            done.push_back(pool.submit([search, &cache, &cancel]() {
+                cache.insert(searchKey(*search, search->algoType()), computeResult(*search, cancel));
+            }));
+        }
+        for (auto &future: done)
+            future.get();
+    }
+
+    /* Untraced sessions, all at once over the same map */
+    std::vector<std::unique_ptr<SearchSession>> sessions;
+    for (int state = 0; state < searchAlgorithmCount; state++)
+        sessions.push_back(std::make_unique<SearchSession>(graph.map()));
+    {
+        ThreadPool pool(searchAlgorithmCount);
+        std::vector<std::future<void>> done;
+        for (int state = 0; state < searchAlgorithmCount; state++)
+        {
+            SearchSession *session = sessions[state].get();
+            done.push_back(pool.submit([session, state, &graph]() {
+                session->run(static_cast<SearchAlgorithmType>(state), graph.startPos(), graph.endPos());
+            }));
+        }
+        for (auto &future: done)
+            future.get();
+    }
+
+    for (int state = 0; state < searchAlgorithmCount; state++)
+    {
+        SearchAlgorithmType algoType = static_cast<SearchAlgorithmType>(state);
+        std::string algo = algoTypeToStr(algoType);
+        const Graph &shared = *graphs[state];
+        const SearchSession &session = *sessions[state];
+
+        if (&session.map() != graph.map().get())
+            failures.add(algo, "session does not share the map");
+        else if (algoType != SearchAlgorithmType::RandomSearch && session.stats().visited != visitedCounts[state])
+            failures.add(algo, "concurrent session visited " + std::to_string(session.stats().visited) + " positions, sequential " +
+                                   std::to_string(visitedCounts[state]));
+        auto result = cache.find(searchKey(graph, algoType));
+
+        if (&shared.grid() != &graph.grid())
+            failures.add(algo, "map was copied instead of shared");
+        if (!result || result->visitedCount() != shared.visitedInOrder().size())
+            failures.add(algo, "precomputed result is missing or differs from its search");
+        else if (algoType != SearchAlgorithmType::RandomSearch && result->visitedCount() != visitedCounts[state])
+            failures.add(algo, "concurrent search on shared map visited " + std::to_string(result->visitedCount()) +
+                                   " positions, sequential " + std::to_string(visitedCounts[state]));
+    }
+}
+
+/** Registers all maps and a copy of the first one under another name, returns false if any check failed */
+static bool checkRegistry(const std::vector<TestMap> &maps)
+{
+    Failures failures;
+    fs::path copy = fs::temp_directory_path() / "graph-regression" / "registry-copy";
+    fs::copy_file(maps.front().path, copy, fs::copy_options::overwrite_existing);
+
+    MapRegistry registry;
+    for (const auto &map: maps)
+        registry.add(map.name, map.path);
+    registry.add("copy", copy.string());
+    registry.add("missing", (copy.parent_path() / "missing").string());
+
+    auto usage = registry.usage();
+    if (std::any_of(usage.begin(), usage.end(), [](const MapUsage &map) { return map.loaded; }))
+        failures.add("registry", "maps were loaded before they were used");
+
+    std::shared_ptr<const GridMap> first = registry.get(maps.front().name);
+    usage = registry.usage();
+    if (!first || std::count_if(usage.begin(), usage.end(), [](const MapUsage &map) { return map.loaded; }) != 1)
+        failures.add("registry", "first access did not load exactly the requested map");
+
+    std::vector<std::string> errors = registry.loadAll();
+    if (errors.size() != 1 || errors.front().rfind("missing", 0) != 0)
+        failures.add("registry", "expected only the missing map to fail, " + std::to_string(errors.size()) + " failed");
+
+    if (registry.get("copy") != first)
+        failures.add("registry", "copy of a map is loaded twice");
+    if (registry.get("unknown") != nullptr)
+        failures.add("registry", "unknown map was found");
+
+    size_t bytes = 0;
+    for (const auto &map: registry.usage())
+    {
+        bytes += map.bytes;
+        if (map.name == "copy" && map.duplicateOf != maps.front().name)
+            failures.add("registry", "copy is not reported as a duplicate");
+        if (map.name != "missing" && (!map.loaded || (map.duplicateOf.empty() && map.bytes == 0)))
+            failures.add("registry", map.name + " is not loaded or has no memory");
+    }
+    if (bytes != registry.bytes())
+        failures.add("registry", "memory of the maps does not add up to the total");
+
+    fs::remove(copy);
+    std::cout << (failures.empty() ? "PASS " : "FAIL ") << "map registry (" << maps.size() + 1 << " maps, " << registry.bytes() / 1024
+              << " KB)" << std::endl;
+    for (const auto &message: failures.messages())
+        std::cout << "    " << message << std::endl;
+    return failures.empty();
+}
+
+/** Records a traced search and a search in a worker thread, the trace has to contain their zones and thread names */
+static bool checkProfiler(const std::vector<TestMap> &maps)
+{
+    Failures failures;
+    fs::path trace = fs::temp_directory_path() / "graph-regression" / "trace.json";
+
+    /* Searches of maps with start equal to end do not run */
+    auto map = std::find_if(maps.begin(), maps.end(), [](const TestMap &map) {
+        auto loaded = GridMap::load(map.path);
+        return loaded->start() != loaded->end();
+    });
+    if (map == maps.end())
+        return true;
+
+    Profiler::start();
+    Graph graph(SearchAlgorithmType::AStar, map->path);
+    graph.setUp(-1);
+    std::thread([&graph]() {
+        PROFILE_THREAD("regression worker");
+        SearchSession session(graph.map());
+        session.run(SearchAlgorithmType::BFS, graph.startPos(), graph.endPos());
+    }).join();
+    if (!Profiler::finish(trace.string()))
+        failures.add("profiler", "trace cannot be written");
+
+    std::ifstream input(trace);
+    std::string text((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+#if PROFILING
+    for (const char *expected: {"\"load map\"", "\"search astar\"", "\"search\"", "\"regression worker\""})
+    {
+        if (text.find(expected) == std::string::npos)
+            failures.add("profiler", std::string("trace has no ") + expected);
+    }
+#endif
+    if (text.rfind("{\"displayTimeUnit\"", 0) != 0 || text.find("]}") == std::string::npos)
+        failures.add("profiler", "trace is not a trace event object");
+
+    fs::remove(trace);
+    std::cout << (failures.empty() ? "PASS " : "FAIL ") << "profiler (" << text.size() << " bytes of trace)" << std::endl;
+    for (const auto &message: failures.messages())
+        std::cout << "    " << message << std::endl;
+    return failures.empty();
+}
+
+/** Loads budgets, each line is "<map> <algorithm> <milliseconds>" */
+static std::map<std::string, double> loadBudgets(const std::string &file)
+{
+    std::map<std::string, double> budgets;
+    std::ifstream input(file);
+    std::string line;
+    while (std::getline(input, line))
+    {
+        std::istringstream parseLine(line);
+        std::string map, algo;
+        double ms;
+        if (line.empty() || line[0] == '#' || !(parseLine >> map >> algo >> ms))
+            continue;
+        budgets[map + " " + algo] = ms;
+    }
+    return budgets;
+}
+
+/** Writes measured times as new budgets */
+static bool saveBudgets(const std::string &file, const std::map<std::string, double> &times)
+{
+    std::ofstream output(file);
+    output << "# <map> <algorithm> <milliseconds>, written by ./tests/regression --update-budgets" << std::endl;
+    for (const auto &[key, ms]: times)
+        output << key << " " << std::fixed << std::setprecision(2) << ms << std::endl;
+    return static_cast<bool>(output);
+}
+
+/** Generates the synthetic maps into temporary directory, both formats are used so both parsers are covered */
+static std::vector<TestMap> generatedMaps(void)
+{
+    struct Generated
+    {
+        std::string name;
+        GeneratorOptions options;
+        bool binary;
+    };
+
+    std::vector<Generated> list = {
+        {"generated/maze-257-w1", {MapFamily::Maze, 257, 257, 1, 1, 10, 8}, false},
+        {"generated/maze-257-w4", {MapFamily::Maze, 257, 257, 2, 4, 10, 8}, true},
+        {"generated/random-256-d25", {MapFamily::Random, 256, 256, 3, 1, 25, 8}, true},
+        {"generated/random-200-d45", {MapFamily::Random, 200, 200, 4, 1, 45, 8}, false},
+        {"generated/rooms-257-r8", {MapFamily::Rooms, 257, 257, 5, 1, 10, 8}, true},
+        {"generated/terrain-256", {MapFamily::Terrain, 256, 256, 6, 1, 10, 8}, false},
+    };
+
+    fs::path dir = fs::temp_directory_path() / "graph-regression";
+    fs::create_directories(dir);
+
+    std::vector<TestMap> maps;
+    for (const auto &generated: list)
+    {
+        fs::path file = dir / (generated.name.substr(generated.name.find('/') + 1) + (generated.binary ? ".bin" : ".txt"));
+        std::ofstream output(file, std::ios::binary);
+        if (generated.binary)
+        {
+            BinaryMapWriter writer(output);
+            generateMap(generated.options, writer);
+        }
+        else
+        {
+            TextMapWriter writer(output);
+            generateMap(generated.options, writer);
+        }
+        maps.push_back({generated.name, file.string()});
+    }
+    return maps;
+}
+
+/** Runs every algorithm on the map, returns false if any check failed */
+static bool checkMap(const TestMap &map, const HarnessOptions &options, const std::map<std::string, double> &budgets,
+                     std::map<std::string, double> &times)
+{
+    Failures failures;
+    std::vector<std::string> timingReport;
+
+    Graph graph(SearchAlgorithmType::BFS, map.path);
+
+    long optimalLength = -1;
+    std::string optimalAlgo;
+    std::vector<std::pair<std::string, bool>> found;
+    std::vector<size_t> visitedCounts;
+
+    for (int state = 0; state < searchAlgorithmCount; state++)
+    {
+        SearchAlgorithmType algoType = static_cast<SearchAlgorithmType>(state);
+        std::string algo = algoTypeToStr(algoType);
+
+        std::string key = map.name + " " + algo;
+        auto budget = budgets.find(key);
+        bool checked = !options.updateBudgets && budget != budgets.end() && budget->second >= options.minBudgetMs;
+        auto withinBudget = [&](double ms) { return ms <= budget->second * (1.0 + options.tolerance / 100.0) + options.slackMs; };
+
+        /* Repeated runs, the last one is kept for the checks below */
+        std::vector<double> runs;
+        size_t repeat = options.updateBudgets || checked ? options.repeat : 1;
+        for (size_t run = 0; run < repeat; run++)
+        {
+            graph.reset();
+            auto begin = std::chrono::steady_clock::now();
+            graph.setUp(state);
+            runs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count());
+            if (checked && withinBudget(runs.back()))
+                break;
+        }
+        std::sort(runs.begin(), runs.end());
+        double bestMs = runs.front();
+
+        checkPath(graph, algo, failures);
+        checkTrace(graph, algo, failures);
+        found.push_back({algo, !graph.path().empty()});
+        visitedCounts.push_back(graph.visitedInOrder().size());
+
+        if (isOptimalAlgorithm(algoType))
+        {
+            long length = static_cast<long>(graph.path().size());
+            if (optimalLength == -1)
+            {
+                optimalLength = length;
+                optimalAlgo = algo;
+            }
+            else if (length != optimalLength)
+                failures.add(algo, "path length " + std::to_string(length) + " differs from " + optimalAlgo + " (" +
+                                       std::to_string(optimalLength) + ")");
+        }
+        if (isBoundedAlgorithm(algoType) && optimalLength > 0 && !graph.path().empty())
+        {
+            /* Lengths count positions, costs are one less */
+            double cost = static_cast<double>(graph.path().size() - 1);
+            if (cost > (1.0 + graph.suboptimality()) * (optimalLength - 1) + 1e-9)
+                failures.add(algo, "path length " + std::to_string(graph.path().size()) + " is over the bound of " + optimalAlgo + " (" +
+                                       std::to_string(optimalLength) + ")");
+        }
+
+        if (map.name.rfind("generated/", 0) == 0)
+        {
+            checkStreaming(graph, algoType, failures);
+            checkKernel(graph, algoType, failures);
+        }
+
+        /* Budget is a typical run, so a check passes when one of its runs is not much slower than typical */
+        times[key] = options.updateBudgets ? runs[runs.size() / 2] : bestMs;
+
+        if (budget == budgets.end())
+            timingReport.push_back(algo + " " + std::to_string(bestMs) + " ms (no budget)");
+        else if (checked && !withinBudget(bestMs))
+            failures.add(algo, "took " + std::to_string(bestMs) + " ms, budget is " + std::to_string(budget->second) + " ms");
+    }
+
+    if (map.name.rfind("generated/", 0) == 0)
+    {
+        checkSharedMap(graph, visitedCounts, failures);
+        checkSearchMemory(graph, failures);
+        checkKernelVariants(graph, failures);
+    }
+    checkLayout<MortonSearchGrid>(graph, "Morton", failures);
+    checkLayout<BlockedSearchGrid>(graph, "blocked", failures);
+    checkReductions(graph, failures);
+    checkBoundedSearch(graph, failures);
+    checkNearestGoals(graph, failures);
+    checkParallelAStar(graph, failures);
+
+    /* Generator always connects start and end, a map without a path would make the checks above vacuous */
+    if (map.name.rfind("generated/", 0) == 0 && optimalLength <= 0)
+        failures.add(optimalAlgo, "generated map has no path from start to end");
+
+    /* All algorithms are complete, they have to agree whether path exists */
+    bool pathExists = optimalLength > 0;
+    for (const auto &[algo, hasPath]: found)
+    {
+        if (hasPath != pathExists)
+            failures.add(algo, hasPath ? "found path although optimal algorithms did not" : "did not find existing path");
+    }
+
+    std::cout << (failures.empty() ? "PASS " : "FAIL ") << map.name << " (path length " << optimalLength << ")" << std::endl;
+    for (const auto &message: failures.messages())
+        std::cout << "    " << message << std::endl;
+    for (const auto &message: timingReport)
+        std::cout << "    " << message << std::endl;
+
+    return failures.empty();
+}
+
+/**
+* @brief Runs the harness
+* - Arguments: dataset directories (default "dataset")
+* - --budgets <file>: file with timing budgets (default tests/budgets.txt)
+* - --tolerance <percent>: allowed slowdown against the budget (default 30)
+* - --repeat <n>: every search with a budget is run up to n times and the best time is used (default 5); with
+*   --update-budgets every search runs n times and the median is written
+* - --min-budget <ms>: budgets under this are not checked (default 5)
+* - --update-budgets: writes measured times as new budgets instead of failing
+*/
+int main(int argc, char **argv)
+{
+    HarnessOptions options;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (argument == "--budgets" && hasValue)
+            options.budgetFile = argv[++i];
+        else if (argument == "--tolerance" && hasValue)
+            options.tolerance = std::stod(argv[++i]);
+        else if (argument == "--repeat" && hasValue)
+        {
+            if (!strToNum(argv[++i], options.repeat) || options.repeat == 0)
+                return EXIT_FAILURE;
+        }
+        else if (argument == "--min-budget" && hasValue)
+        {
+            if (!strToNum(argv[++i], options.minBudgetMs))
+                return EXIT_FAILURE;
+        }
+        else if (argument == "--update-budgets")
+            options.updateBudgets = true;
+        else if (argument.rfind("--", 0) == 0)
+        {
+            std::cerr << "Unknown option " << argument << std::endl;
+            return EXIT_FAILURE;
+        }
+        else
+            options.datasetDirs.push_back(argument);
+    }
+
+    if (options.datasetDirs.empty())
+        options.datasetDirs.push_back("dataset");
+
+    std::vector<TestMap> maps;
+    for (const auto &dir: options.datasetDirs)
+    {
+        std::vector<TestMap> dirMaps;
+        for (const auto &entry: fs::directory_iterator(dir))
+        {
+            if (entry.is_regular_file())
+                dirMaps.push_back({entry.path().filename().string(), entry.path().string()});
+        }
+        std::sort(dirMaps.begin(), dirMaps.end(), [](const TestMap &a, const TestMap &b) { return a.name < b.name; });
+        maps.insert(maps.end(), dirMaps.begin(), dirMaps.end());
+    }
+
+    std::vector<TestMap> generated = generatedMaps();
+    maps.insert(maps.end(), generated.begin(), generated.end());
+
+    std::map<std::string, double> budgets;
+    if (!options.updateBudgets)
+        budgets = loadBudgets(options.budgetFile);
+
+    std::map<std::string, double> times;
+    size_t failed = 0;
+    for (const auto &map: maps)
+    {
+        if (!checkMap(map, options, budgets, times))
+            failed++;
+    }
+
+    if (options.updateBudgets)
+    {
+        if (!saveBudgets(options.budgetFile, times))
+        {
+            std::cerr << "Cannot write " << options.budgetFile << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << "Budgets written to " << options.budgetFile << std::endl;
+    }
+
+    bool registryPassed = checkRegistry(maps);
+    bool profilerPassed = checkProfiler(maps);
+    bool goalsPassed = checkGoalFormats();
+    bool schedulerPassed = checkPlaybackScheduler();
+
+    std::cout << maps.size() - failed << "/" << maps.size() << " maps passed" << std::endl;
+    return failed == 0 && registryPassed && profilerPassed && goalsPassed && schedulerPassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}